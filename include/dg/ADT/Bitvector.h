@@ -4,28 +4,36 @@
 #include <map>
 #include <cassert>
 
+#include "dg/ADT/FlatMap.h"
+
 namespace dg {
 namespace ADT {
 
-template <typename BitsT = uint64_t, typename ShiftT = uint64_t, size_t SCALE = 1>
+// The ContainerT is the mapping from shift to bits. It must keep
+// the shifts sorted and provide the (subset of) interface of std::map.
+template <typename BitsT = uint64_t, typename ShiftT = uint64_t, size_t SCALE = 1,
+          typename ContainerT = std::map<ShiftT, BitsT>>
 class SparseBitvectorImpl {
     // mapping from shift to bits
-    using BitsContainerT = std::map<ShiftT, BitsT>;
+    using BitsContainerT = ContainerT;
     BitsContainerT _bits{};
 
     static size_t _bitsNum() { return sizeof(BitsT) * 8; }
     static ShiftT _shift(size_t i) { return i - (i % _bitsNum()); }
 
     static size_t _countBits(BitsT bits) {
-        size_t num = 0;
-        while (bits) {
-            if (bits & 0x1)
-                ++num;
-
-            bits = bits >> 1;
-        }
+        static_assert(sizeof(BitsT) <= sizeof(unsigned long long),
+                      "BitsT is too wide for popcount");
+        return __builtin_popcountll(bits);
+    }
 
-        return num;
+    // mask of the bits from the word starting at 'sft'
+    // that fall into the interval [from, to)
+    static BitsT _rangeMask(ShiftT sft, size_t from, size_t to) {
+        size_t lo = from > sft ? from - sft : 0;
+        size_t hi = to - sft < _bitsNum() ? to - sft : _bitsNum();
+        BitsT mask = hi == _bitsNum() ? ~BitsT(0) : ((BitsT(1) << hi) - 1);
+        return mask & ~((BitsT(1) << lo) - 1);
     }
 
     void _addBits(size_t i) {
@@ -82,27 +90,188 @@ public:
             return false;
         }
 
+        bool prev = (it->second & (1UL << (i - sft)));
         it->second &= ~(1UL << (i - sft));
         if (it->second == 0) {
             _bits.erase(it);
         }
 
-        return true;
+        return prev;
     }
 
-    // this is the union operation
+    // this is the union operation.
+    // We walk both (sorted) containers at once and merge
+    // whole words, so we touch every word only once
+    // and allocate only for words that we did not have yet.
     bool merge(const SparseBitvectorImpl& rhs) {
+        // if rhs is much smaller than this bitvector,
+        // it is cheaper to search for the words than to walk
+        // the whole container
+        bool lookup = rhs._bits.size() * 16 < _bits.size();
+
+        bool changed = false;
+        auto it = _bits.begin();
+        for (const auto& rit : rhs._bits) {
+            if (lookup) {
+                it = _bits.lower_bound(rit.first);
+            } else {
+                while (it != _bits.end() && it->first < rit.first)
+                    ++it;
+            }
+
+            if (it != _bits.end() && it->first == rit.first) {
+                auto old = it->second;
+                it->second |= rit.second;
+                changed |= (old != it->second);
+                ++it;
+            } else {
+                // the hint is the element that follows the new one,
+                // take the returned iterator as the container
+                // may not keep the iterators valid
+                it = _bits.emplace_hint(it, rit.first, rit.second);
+                ++it;
+                changed = true;
+            }
+        }
+
+        return changed;
+    }
+
+    // keep only the bits that are set also in rhs,
+    // returns true if some bit was unset
+    bool intersect(const SparseBitvectorImpl& rhs) {
+        bool changed = false;
+        auto rit = rhs._bits.begin();
+        auto it = _bits.begin();
+        while (it != _bits.end()) {
+            while (rit != rhs._bits.end() && rit->first < it->first)
+                ++rit;
+
+            auto old = it->second;
+            if (rit != rhs._bits.end() && rit->first == it->first)
+                it->second &= rit->second;
+            else
+                it->second = 0;
+
+            if (old != it->second)
+                changed = true;
+
+            if (it->second == 0)
+                it = _bits.erase(it);
+            else
+                ++it;
+        }
+
+        return changed;
+    }
+
+    // unset all bits that are set in rhs,
+    // returns true if some bit was unset
+    bool subtract(const SparseBitvectorImpl& rhs) {
+        if (&rhs == this) {
+            bool changed = !empty();
+            reset();
+            return changed;
+        }
+
+        bool changed = false;
+        auto it = _bits.begin();
+        for (const auto& rit : rhs._bits) {
+            while (it != _bits.end() && it->first < rit.first)
+                ++it;
+
+            if (it == _bits.end())
+                break;
+
+            if (it->first != rit.first)
+                continue;
+
+            auto old = it->second;
+            it->second &= ~rit.second;
+            if (old != it->second)
+                changed = true;
+
+            if (it->second == 0)
+                it = _bits.erase(it);
+            else
+                ++it;
+        }
+
+        return changed;
+    }
+
+    // is every bit that is set in this bitvector
+    // set also in rhs?
+    bool isSubsetOf(const SparseBitvectorImpl& rhs) const {
+        auto rit = rhs._bits.begin();
+        for (const auto& it : _bits) {
+            while (rit != rhs._bits.end() && rit->first < it.first)
+                ++rit;
+
+            if (rit == rhs._bits.end() || rit->first != it.first)
+                return false;
+
+            if ((it.second & ~rit->second) != 0)
+                return false;
+        }
+
+        return true;
+    }
+
+    // is any bit from the interval [from, to) set?
+    bool hasAnyInRange(size_t from, size_t to) const {
+        for (auto it = _bits.lower_bound(_shift(from));
+             it != _bits.end() && it->first < to; ++it) {
+            if (it->second & _rangeMask(it->first, from, to))
+                return true;
+        }
+
+        return false;
+    }
+
+    // unset all bits from the interval [from, to),
+    // returns true if some bit was unset
+    bool unsetRange(size_t from, size_t to) {
         bool changed = false;
-        // FIXME: this is inefficient
-        for (size_t i : rhs) {
-            // if we changed a bit from false to true,
-            // we changed the bitvector
-            changed |= (set(i) == false);
+        auto it = _bits.lower_bound(_shift(from));
+        while (it != _bits.end() && it->first < to) {
+            auto old = it->second;
+            it->second &= ~_rangeMask(it->first, from, to);
+            if (old != it->second)
+                changed = true;
+
+            if (it->second == 0)
+                it = _bits.erase(it);
+            else
+                ++it;
         }
 
         return changed;
     }
 
+    // the lowest and the highest set bit
+    // (the bitvector must not be empty)
+    size_t first() const {
+        assert(!empty());
+        auto it = _bits.begin();
+        return it->first + __builtin_ctzll(it->second);
+    }
+
+    size_t last() const {
+        assert(!empty());
+        auto it = _bits.end();
+        --it;
+        return it->first + (_bitsNum() - 1 - __builtin_clzll(it->second));
+    }
+
+    bool operator==(const SparseBitvectorImpl& rhs) const {
+        return _bits == rhs._bits;
+    }
+
+    bool operator!=(const SparseBitvectorImpl& rhs) const {
+        return !operator==(rhs);
+    }
+
     size_t size() const {
         size_t num = 0;
         for (auto& it : _bits)
@@ -112,8 +281,8 @@ public:
     }
 
     class const_iterator {
-        typename BitsContainerT::const_iterator container_it;
-        typename BitsContainerT::const_iterator container_end;
+        typename BitsContainerT::const_iterator container_it{};
+        typename BitsContainerT::const_iterator container_end{};
         size_t pos{0};
 
         const_iterator(const BitsContainerT& cont, bool end = false)
@@ -178,6 +347,10 @@ public:
 };
 
 using SparseBitvector = SparseBitvectorImpl<uint64_t, uint64_t, 1>;
+// sparse bitvector that keeps its words in a sorted array
+// (with the first two words stored inline)
+using FlatSparseBitvector = SparseBitvectorImpl<uint64_t, uint64_t, 1,
+                                                FlatMap<uint64_t, uint64_t, 2>>;
 
 } // namespace ADT
 } // namespace dg
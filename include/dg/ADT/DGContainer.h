@@ -5,6 +5,10 @@
 #include <cassert>
 #include <algorithm>
 
+#ifdef DG_CONTAINER_SMALL
+#include "dg/ADT/SmallSortedSet.h"
+#endif
+
 namespace dg {
 
 /// ------------------------------------------------------------------
@@ -12,14 +16,21 @@ namespace dg {
 //
 //   This is basically just a wrapper for real container, so that
 //   we have the container defined on one place for all edges.
-//   It may have more implementations depending on available features
+//   It may have more implementations depending on available features.
+//   With DG_CONTAINER_SMALL, the elements are kept in a sorted array
+//   that stores up to EXPECTED_ELEMENTS_NUM elements inline,
+//   so most of the edges do not need any allocation.
+//   Otherwise, the elements are kept in std::set.
 /// ------------------------------------------------------------------
 template <typename ValueT, unsigned int EXPECTED_ELEMENTS_NUM = 8>
 class DGContainer
 {
 public:
-    // XXX use llvm ADTs when available, or BDDs?
+#ifdef DG_CONTAINER_SMALL
+    using ContainerT = ADT::SmallSortedSet<ValueT, EXPECTED_ELEMENTS_NUM>;
+#else
     using ContainerT = typename std::set<ValueT>;
+#endif
     using iterator = typename ContainerT::iterator;
     using const_iterator = typename ContainerT::const_iterator;
     using size_type = typename ContainerT::size_type;
@@ -66,6 +77,9 @@ public:
 
     void intersect(const DGContainer<ValueT, EXPECTED_ELEMENTS_NUM>& oth)
     {
+#ifdef DG_CONTAINER_SMALL
+        container.intersect(oth.container);
+#else
         DGContainer<ValueT, EXPECTED_ELEMENTS_NUM> tmp;
 
         std::set_intersection(container.begin(), container.end(),
@@ -76,6 +90,7 @@ public:
 
         // swap containers
         container.swap(tmp.container);
+#endif
     }
 
     bool operator==(const DGContainer<ValueT, EXPECTED_ELEMENTS_NUM>& oth) const
@@ -0,0 +1,231 @@
+#ifndef _DG_DENSE_BITVECTOR_H_
+#define _DG_DENSE_BITVECTOR_H_
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+
+namespace dg {
+namespace ADT {
+
+// Bitvector for small dense indices (e.g. IDs of nodes). The words
+// are kept in a vector that grows to the highest set bit, so the set
+// operations are just loops over the words.
+// The interface is the same as the interface of SparseBitvector.
+class DenseBitvector {
+    using BitsT = uint64_t;
+    std::vector<BitsT> _bits{};
+
+    static size_t _bitsNum() { return sizeof(BitsT) * 8; }
+    static size_t _word(size_t i) { return i / _bitsNum(); }
+    static BitsT _mask(size_t i) { return BitsT(1) << (i % _bitsNum()); }
+    static size_t _countBits(BitsT bits) { return __builtin_popcountll(bits); }
+
+    // drop the zero words from the end, so that
+    // the bitvectors with the same bits are equal
+    void _shrink() {
+        while (!_bits.empty() && _bits.back() == 0)
+            _bits.pop_back();
+    }
+
+public:
+    DenseBitvector() = default;
+    DenseBitvector(size_t i) { set(i); } // singleton ctor
+
+    DenseBitvector(const DenseBitvector&) = default;
+    DenseBitvector(DenseBitvector&&) = default;
+    DenseBitvector& operator=(const DenseBitvector&) = default;
+    DenseBitvector& operator=(DenseBitvector&&) = default;
+
+    void reset() { _bits.clear(); }
+    bool empty() const { return _bits.empty(); }
+    void swap(DenseBitvector& oth) { _bits.swap(oth._bits); }
+
+    // preallocate the words for the bits [0, n)
+    void reserve(size_t n) { _bits.reserve(_word(n) + 1); }
+
+    bool get(size_t i) const {
+        size_t w = _word(i);
+        return w < _bits.size() && (_bits[w] & _mask(i));
+    }
+
+    // returns the previous value of the i-th bit
+    bool set(size_t i) {
+        size_t w = _word(i);
+        if (w >= _bits.size())
+            _bits.resize(w + 1, 0);
+
+        bool prev = _bits[w] & _mask(i);
+        _bits[w] |= _mask(i);
+        return prev;
+    }
+
+    // returns the previous value of the i-th bit
+    bool unset(size_t i) {
+        size_t w = _word(i);
+        if (w >= _bits.size())
+            return false;
+
+        bool prev = _bits[w] & _mask(i);
+        _bits[w] &= ~_mask(i);
+        _shrink();
+        return prev;
+    }
+
+    // this is the union operation
+    bool merge(const DenseBitvector& rhs) {
+        if (rhs._bits.size() > _bits.size())
+            _bits.resize(rhs._bits.size(), 0);
+
+        bool changed = false;
+        for (size_t i = 0; i < rhs._bits.size(); ++i) {
+            BitsT old = _bits[i];
+            _bits[i] |= rhs._bits[i];
+            changed |= (old != _bits[i]);
+        }
+
+        return changed;
+    }
+
+    // keep only the bits that are set also in rhs,
+    // returns true if some bit was unset
+    bool intersect(const DenseBitvector& rhs) {
+        bool changed = false;
+        for (size_t i = 0; i < _bits.size(); ++i) {
+            BitsT old = _bits[i];
+            _bits[i] &= i < rhs._bits.size() ? rhs._bits[i] : 0;
+            changed |= (old != _bits[i]);
+        }
+
+        _shrink();
+        return changed;
+    }
+
+    // unset all bits that are set in rhs,
+    // returns true if some bit was unset
+    bool subtract(const DenseBitvector& rhs) {
+        bool changed = false;
+        size_t num = std::min(_bits.size(), rhs._bits.size());
+        for (size_t i = 0; i < num; ++i) {
+            BitsT old = _bits[i];
+            _bits[i] &= ~rhs._bits[i];
+            changed |= (old != _bits[i]);
+        }
+
+        _shrink();
+        return changed;
+    }
+
+    // is every bit that is set in this bitvector
+    // set also in rhs?
+    bool isSubsetOf(const DenseBitvector& rhs) const {
+        if (_bits.size() > rhs._bits.size())
+            return false;
+
+        for (size_t i = 0; i < _bits.size(); ++i) {
+            if ((_bits[i] & ~rhs._bits[i]) != 0)
+                return false;
+        }
+
+        return true;
+    }
+
+    // is any bit set in both bitvectors?
+    bool intersects(const DenseBitvector& rhs) const {
+        size_t num = std::min(_bits.size(), rhs._bits.size());
+        for (size_t i = 0; i < num; ++i) {
+            if (_bits[i] & rhs._bits[i])
+                return true;
+        }
+
+        return false;
+    }
+
+    // the number of bits set in both bitvectors
+    // (the size of the intersection without computing it)
+    size_t intersectionSize(const DenseBitvector& rhs) const {
+        size_t num = std::min(_bits.size(), rhs._bits.size());
+        size_t ret = 0;
+        for (size_t i = 0; i < num; ++i)
+            ret += _countBits(_bits[i] & rhs._bits[i]);
+
+        return ret;
+    }
+
+    bool operator==(const DenseBitvector& rhs) const {
+        return _bits == rhs._bits;
+    }
+
+    bool operator!=(const DenseBitvector& rhs) const {
+        return !operator==(rhs);
+    }
+
+    size_t size() const {
+        size_t num = 0;
+        for (BitsT bits : _bits)
+            num += _countBits(bits);
+
+        return num;
+    }
+
+    class const_iterator {
+        const std::vector<BitsT> *bits{nullptr};
+        size_t pos{0};
+
+        const_iterator(const std::vector<BitsT>& b, bool end = false)
+        : bits(&b), pos(end ? b.size() * _bitsNum() : 0) {
+            if (!end)
+                _findClosestBit();
+        }
+
+        void _findClosestBit() {
+            size_t endpos = bits->size() * _bitsNum();
+            while (pos < endpos) {
+                BitsT w = (*bits)[_word(pos)] >> (pos % _bitsNum());
+                if (w != 0) {
+                    pos += __builtin_ctzll(w);
+                    return;
+                }
+
+                // skip the rest of the word
+                pos = (_word(pos) + 1) * _bitsNum();
+            }
+        }
+
+    public:
+        const_iterator() = default;
+        const_iterator& operator++() {
+            ++pos;
+            _findClosestBit();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        size_t operator*() const { return pos; }
+
+        bool operator==(const const_iterator& rhs) const {
+            return pos == rhs.pos && bits == rhs.bits;
+        }
+
+        bool operator!=(const const_iterator& rhs) const {
+            return !operator==(rhs);
+        }
+
+        friend class DenseBitvector;
+    };
+
+    const_iterator begin() const { return const_iterator(_bits); }
+    const_iterator end() const { return const_iterator(_bits, true /* end */); }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_DENSE_BITVECTOR_H_
@@ -0,0 +1,237 @@
+#ifndef _DG_FLAT_MAP_H_
+#define _DG_FLAT_MAP_H_
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace dg {
+namespace ADT {
+
+// A map that keeps its elements sorted in a contiguous array.
+// First INLINE_NUM elements are stored directly in the object,
+// if there is more of them, the array is moved to the heap.
+// The interface mimics std::map (but the iterators are invalidated
+// by every insertion and removal). Keys and values are moved
+// around using memmove, so they must be trivially copyable.
+template <typename KeyT, typename ValueT, size_t INLINE_NUM = 4>
+class FlatMap {
+public:
+    struct value_type {
+        KeyT first;
+        ValueT second;
+
+        bool operator==(const value_type& rhs) const {
+            return first == rhs.first && second == rhs.second;
+        }
+    };
+
+    using iterator = value_type *;
+    using const_iterator = const value_type *;
+
+private:
+    static_assert(std::is_trivially_copyable<KeyT>::value &&
+                  std::is_trivially_copyable<ValueT>::value,
+                  "FlatMap can store only trivially copyable types");
+
+    value_type _inline[INLINE_NUM];
+    value_type *_data{_inline};
+    size_t _size{0};
+    size_t _capacity{INLINE_NUM};
+
+    bool _isInline() const { return _data == _inline; }
+
+    void _grow() {
+        size_t newCapacity = _capacity * 2;
+        auto *newData
+            = static_cast<value_type *>(malloc(newCapacity * sizeof(value_type)));
+        assert(newData && "Failed allocating memory");
+        memcpy(newData, _data, _size * sizeof(value_type));
+
+        if (!_isInline())
+            free(_data);
+
+        _data = newData;
+        _capacity = newCapacity;
+    }
+
+    void _release() {
+        if (!_isInline())
+            free(_data);
+
+        _data = _inline;
+        _capacity = INLINE_NUM;
+        _size = 0;
+    }
+
+    void _copyFrom(const FlatMap& rhs) {
+        assert(_size == 0 && _isInline());
+        if (rhs._size > INLINE_NUM) {
+            _data = static_cast<value_type *>(malloc(rhs._size * sizeof(value_type)));
+            assert(_data && "Failed allocating memory");
+            _capacity = rhs._size;
+        }
+
+        memcpy(_data, rhs._data, rhs._size * sizeof(value_type));
+        _size = rhs._size;
+    }
+
+    void _moveFrom(FlatMap& rhs) {
+        assert(_size == 0 && _isInline());
+        if (rhs._isInline()) {
+            memcpy(_data, rhs._data, rhs._size * sizeof(value_type));
+        } else {
+            // steal the memory
+            _data = rhs._data;
+            _capacity = rhs._capacity;
+            rhs._data = rhs._inline;
+            rhs._capacity = INLINE_NUM;
+        }
+
+        _size = rhs._size;
+        rhs._size = 0;
+    }
+
+public:
+    FlatMap() = default;
+    FlatMap(const FlatMap& rhs) { _copyFrom(rhs); }
+    FlatMap(FlatMap&& rhs) { _moveFrom(rhs); }
+    ~FlatMap() { _release(); }
+
+    FlatMap& operator=(const FlatMap& rhs) {
+        if (&rhs != this) {
+            _release();
+            _copyFrom(rhs);
+        }
+        return *this;
+    }
+
+    FlatMap& operator=(FlatMap&& rhs) {
+        if (&rhs != this) {
+            _release();
+            _moveFrom(rhs);
+        }
+        return *this;
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    void clear() { _release(); }
+
+    void swap(FlatMap& rhs) {
+        FlatMap tmp(std::move(rhs));
+        rhs = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    iterator begin() { return _data; }
+    iterator end() { return _data + _size; }
+    const_iterator begin() const { return _data; }
+    const_iterator end() const { return _data + _size; }
+
+    iterator lower_bound(const KeyT& k) {
+        // binary search for the first element that is not less than k
+        size_t l = 0, r = _size;
+        while (l < r) {
+            size_t m = l + (r - l) / 2;
+            if (_data[m].first < k)
+                l = m + 1;
+            else
+                r = m;
+        }
+
+        return _data + l;
+    }
+
+    const_iterator lower_bound(const KeyT& k) const {
+        return const_cast<FlatMap *>(this)->lower_bound(k);
+    }
+
+    iterator find(const KeyT& k) {
+        auto it = lower_bound(k);
+        if (it != end() && it->first == k)
+            return it;
+        return end();
+    }
+
+    const_iterator find(const KeyT& k) const {
+        return const_cast<FlatMap *>(this)->find(k);
+    }
+
+    size_t count(const KeyT& k) const { return find(k) != end(); }
+
+    // insert the element before 'hint'. The hint must be the correct
+    // position of the element (i.e. the element that follows it)
+    iterator emplace_hint(const_iterator hint, const KeyT& k, const ValueT& v) {
+        assert(hint >= begin() && hint <= end());
+        assert((hint == end() || k < hint->first) && "Invalid hint");
+        assert((hint == begin() || (hint - 1)->first < k) && "Invalid hint");
+
+        size_t pos = hint - begin();
+        if (_size == _capacity)
+            _grow();
+
+        memmove(_data + pos + 1, _data + pos, (_size - pos) * sizeof(value_type));
+        _data[pos].first = k;
+        _data[pos].second = v;
+        ++_size;
+
+        return _data + pos;
+    }
+
+    std::pair<iterator, bool> emplace(const KeyT& k, const ValueT& v) {
+        auto it = lower_bound(k);
+        if (it != end() && it->first == k)
+            return {it, false};
+
+        return {emplace_hint(it, k, v), true};
+    }
+
+    ValueT& operator[](const KeyT& k) {
+        auto it = lower_bound(k);
+        if (it != end() && it->first == k)
+            return it->second;
+
+        return emplace_hint(it, k, ValueT())->second;
+    }
+
+    iterator erase(const_iterator it) {
+        assert(it >= begin() && it < end());
+        size_t pos = it - begin();
+        memmove(_data + pos, _data + pos + 1,
+                (_size - pos - 1) * sizeof(value_type));
+        --_size;
+
+        return _data + pos;
+    }
+
+    size_t erase(const KeyT& k) {
+        auto it = find(k);
+        if (it == end())
+            return 0;
+
+        erase(it);
+        return 1;
+    }
+
+    bool operator==(const FlatMap& rhs) const {
+        if (_size != rhs._size)
+            return false;
+
+        for (size_t i = 0; i < _size; ++i) {
+            if (!(_data[i] == rhs._data[i]))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool operator!=(const FlatMap& rhs) const { return !operator==(rhs); }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_FLAT_MAP_H_
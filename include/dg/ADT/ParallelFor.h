@@ -0,0 +1,51 @@
+#ifndef _DG_ADT_PARALLEL_FOR_H_
+#define _DG_ADT_PARALLEL_FOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace dg {
+namespace ADT {
+
+///
+// Call fn(i) for every i from [0, num) on 'threads' threads
+// (the calling thread is one of them). The indices are handed out
+// one by one, so the threads stay busy even if the work items differ
+// in size. The order in which the items are processed is not defined,
+// fn must synchronize the access to any shared data itself.
+template <typename Func>
+void parallelFor(size_t num, unsigned threads, Func fn)
+{
+    if (threads <= 1 || num <= 1) {
+        for (size_t i = 0; i < num; ++i)
+            fn(i);
+        return;
+    }
+
+    if (threads > num)
+        threads = static_cast<unsigned>(num);
+
+    std::atomic<size_t> next{0};
+    auto worker = [&next, &fn, num]() {
+        size_t i;
+        while ((i = next.fetch_add(1)) < num)
+            fn(i);
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t)
+        workers.emplace_back(worker);
+
+    worker();
+
+    for (std::thread& t : workers)
+        t.join();
+}
+
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_ADT_PARALLEL_FOR_H_
@@ -0,0 +1,254 @@
+#ifndef _DG_SMALL_SORTED_SET_H_
+#define _DG_SMALL_SORTED_SET_H_
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace dg {
+namespace ADT {
+
+// A set that keeps its elements sorted in a contiguous array.
+// First INLINE_NUM elements are stored directly in the object,
+// if there is more of them, the array is moved to the heap.
+// The interface mimics std::set (but the iterators are invalidated
+// by every insertion and removal). The elements are moved around
+// using memmove, so they must be trivially copyable.
+template <typename ValueT, size_t INLINE_NUM = 4>
+class SmallSortedSet {
+public:
+    using value_type = ValueT;
+    using size_type = size_t;
+    // the elements must not be changed in place,
+    // that could break the ordering
+    using iterator = const ValueT *;
+    using const_iterator = const ValueT *;
+
+private:
+    static_assert(std::is_trivially_copyable<ValueT>::value,
+                  "SmallSortedSet can store only trivially copyable types");
+    static_assert(INLINE_NUM > 0, "Need a space for at least one element");
+
+    // raw memory, so that ValueT does not need the default constructor
+    typename std::aligned_storage<sizeof(ValueT) * INLINE_NUM,
+                                  alignof(ValueT)>::type _inline;
+    ValueT *_data{_inlineData()};
+    unsigned _size{0};
+    unsigned _capacity{INLINE_NUM};
+
+    ValueT *_inlineData() { return reinterpret_cast<ValueT *>(&_inline); }
+    bool _isInline() const {
+        return _data == reinterpret_cast<const ValueT *>(&_inline);
+    }
+
+    void _grow() {
+        unsigned newCapacity = _capacity * 2;
+        auto *newData
+            = static_cast<ValueT *>(malloc(newCapacity * sizeof(ValueT)));
+        assert(newData && "Failed allocating memory");
+        memcpy(newData, _data, _size * sizeof(ValueT));
+
+        if (!_isInline())
+            free(_data);
+
+        _data = newData;
+        _capacity = newCapacity;
+    }
+
+    void _release() {
+        if (!_isInline())
+            free(_data);
+
+        _data = _inlineData();
+        _capacity = INLINE_NUM;
+        _size = 0;
+    }
+
+    void _copyFrom(const SmallSortedSet& rhs) {
+        assert(_size == 0 && _isInline());
+        if (rhs._size > INLINE_NUM) {
+            _data = static_cast<ValueT *>(malloc(rhs._size * sizeof(ValueT)));
+            assert(_data && "Failed allocating memory");
+            _capacity = rhs._size;
+        }
+
+        memcpy(_data, rhs._data, rhs._size * sizeof(ValueT));
+        _size = rhs._size;
+    }
+
+    void _moveFrom(SmallSortedSet& rhs) {
+        assert(_size == 0 && _isInline());
+        if (rhs._isInline()) {
+            memcpy(_data, rhs._data, rhs._size * sizeof(ValueT));
+        } else {
+            // steal the memory
+            _data = rhs._data;
+            _capacity = rhs._capacity;
+            rhs._data = rhs._inlineData();
+            rhs._capacity = INLINE_NUM;
+        }
+
+        _size = rhs._size;
+        rhs._size = 0;
+    }
+
+    // insert the element to the position 'pos'
+    // (the caller must ensure that it keeps the ordering)
+    const_iterator _insertAt(size_t pos, const ValueT& v) {
+        if (_size == _capacity)
+            _grow();
+
+        memmove(_data + pos + 1, _data + pos, (_size - pos) * sizeof(ValueT));
+        _data[pos] = v;
+        ++_size;
+
+        return _data + pos;
+    }
+
+public:
+    SmallSortedSet() = default;
+    SmallSortedSet(const SmallSortedSet& rhs) { _copyFrom(rhs); }
+    SmallSortedSet(SmallSortedSet&& rhs) { _moveFrom(rhs); }
+    ~SmallSortedSet() { _release(); }
+
+    SmallSortedSet& operator=(const SmallSortedSet& rhs) {
+        if (&rhs != this) {
+            _release();
+            _copyFrom(rhs);
+        }
+        return *this;
+    }
+
+    SmallSortedSet& operator=(SmallSortedSet&& rhs) {
+        if (&rhs != this) {
+            _release();
+            _moveFrom(rhs);
+        }
+        return *this;
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    void clear() { _release(); }
+
+    // are the elements stored in the object itself?
+    bool isInline() const { return _isInline(); }
+
+    void swap(SmallSortedSet& rhs) {
+        SmallSortedSet tmp(std::move(rhs));
+        rhs = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    const_iterator begin() const { return _data; }
+    const_iterator end() const { return _data + _size; }
+
+    const_iterator lower_bound(const ValueT& v) const {
+        // binary search for the first element that is not less than v
+        size_t l = 0, r = _size;
+        while (l < r) {
+            size_t m = l + (r - l) / 2;
+            if (_data[m] < v)
+                l = m + 1;
+            else
+                r = m;
+        }
+
+        return _data + l;
+    }
+
+    const_iterator find(const ValueT& v) const {
+        auto it = lower_bound(v);
+        if (it != end() && !(v < *it))
+            return it;
+        return end();
+    }
+
+    size_t count(const ValueT& v) const { return find(v) != end(); }
+
+    std::pair<const_iterator, bool> insert(const ValueT& v) {
+        // adding elements in the increasing order is common
+        // (e.g. when copying or intersecting sets), so check the end first
+        if (_size == 0 || _data[_size - 1] < v)
+            return {_insertAt(_size, v), true};
+
+        auto it = lower_bound(v);
+        if (it != end() && !(v < *it))
+            return {it, false};
+
+        return {_insertAt(it - begin(), v), true};
+    }
+
+    // insert with a hint like std::set does, the hint is the position
+    // of the element that should follow the inserted one.
+    // This makes std::inserter work on the set.
+    const_iterator insert(const_iterator hint, const ValueT& v) {
+        assert(hint >= begin() && hint <= end());
+        if ((hint == end() || v < *hint) &&
+            (hint == begin() || *(hint - 1) < v))
+            return _insertAt(hint - begin(), v);
+
+        // wrong hint (or the element is already in the set)
+        return insert(v).first;
+    }
+
+    const_iterator erase(const_iterator it) {
+        assert(it >= begin() && it < end());
+        size_t pos = it - begin();
+        memmove(_data + pos, _data + pos + 1,
+                (_size - pos - 1) * sizeof(ValueT));
+        --_size;
+
+        return _data + pos;
+    }
+
+    size_t erase(const ValueT& v) {
+        auto it = find(v);
+        if (it == end())
+            return 0;
+
+        erase(it);
+        return 1;
+    }
+
+    // keep only the elements that are also in rhs,
+    // this is a linear merge of the two sorted arrays
+    void intersect(const SmallSortedSet& rhs) {
+        unsigned w = 0;
+        size_t j = 0;
+        for (unsigned i = 0; i < _size && j < rhs._size;) {
+            if (_data[i] < rhs._data[j]) {
+                ++i;
+            } else if (rhs._data[j] < _data[i]) {
+                ++j;
+            } else {
+                _data[w++] = _data[i];
+                ++i;
+                ++j;
+            }
+        }
+
+        _size = w;
+    }
+
+    bool operator==(const SmallSortedSet& rhs) const {
+        if (_size != rhs._size)
+            return false;
+
+        for (size_t i = 0; i < _size; ++i) {
+            if (!(_data[i] == rhs._data[i]))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool operator!=(const SmallSortedSet& rhs) const { return !operator==(rhs); }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // _DG_SMALL_SORTED_SET_H_
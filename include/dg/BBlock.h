@@ -153,9 +153,11 @@ public:
             // and create new edges to all successors. The new edges
             // will have the same label as the found one
             DGContainer<BBlockEdge> new_edges;
-            for (auto I = pred->nextBBs.begin(),E = pred->nextBBs.end(); I != E;) {
-                auto cur = I++;
-                if (cur->target == this) {
+            // the edges are removed after the iteration, so that
+            // we do not invalidate the iterators of the container
+            DGContainer<BBlockEdge> old_edges;
+            for (const BBlockEdge& edge : pred->nextBBs) {
+                if (edge.target == this) {
                     // create edges that will go from the predecessor
                     // to every successor of this node
                     for (const BBlockEdge& succ : nextBBs) {
@@ -163,14 +165,17 @@ public:
                         // that would be incorrect. It can occur when we're isolatin a bblock
                         // with self-loop
                         if (succ.target != this)
-                            new_edges.insert(BBlockEdge(succ.target, cur->label));
+                            new_edges.insert(BBlockEdge(succ.target, edge.label));
                     }
 
-                    // remove the edge from predecessor
-                    pred->nextBBs.erase(*cur);
+                    old_edges.insert(edge);
                 }
             }
 
+            // remove the edges from predecessor
+            for (const BBlockEdge& edge : old_edges)
+                pred->nextBBs.erase(edge);
+
             // add newly created edges to predecessor
             for (const BBlockEdge& edge : new_edges) {
                 assert(edge.target != this
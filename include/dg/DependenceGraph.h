@@ -406,6 +406,12 @@ public:
 
     uint64_t getSlice() const { return slice_id; }
 
+    // called before the control dependencies of the nodes
+    // and blocks of this graph are used (e.g. by the slicer).
+    // The graphs that compute the control dependencies
+    // on demand compute them here
+    virtual void ensureControlDependencies() {}
+
 #ifdef ENABLE_CFG
     // get blocks contained in this graph
     BBlocksMapT& getBlocks() { return _blocks; }
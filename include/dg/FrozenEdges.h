@@ -0,0 +1,176 @@
+#ifndef _DG_FROZEN_EDGES_H_
+#define _DG_FROZEN_EDGES_H_
+
+#include <vector>
+#include <cassert>
+#include <cstddef>
+
+#include "dg/DependenceGraph.h"
+
+namespace dg {
+
+///
+// Read-only copy of the dependence edges of nodes in the compressed
+// sparse row (CSR) format. The nodes get dense IDs and the edges of one
+// kind of the node with ID i are the IDs of the target nodes
+// stored in _targets[_offsets[i * KINDS_NUM + kind]] ...
+// _targets[_offsets[i * KINDS_NUM + kind + 1] - 1].
+//
+// When all the dependencies are computed, the edges can be frozen
+// and the containers in the nodes can be released (releaseNodeEdges()),
+// which saves a lot of memory as the containers are sets. The Slicer
+// then walks the frozen edges (see Slicer::setFrozenEdges).
+// The frozen edges are not updated when the graph changes,
+// so they can not be used once the graph is sliced.
+//
+// The ID is stored in the node, so a node can have an ID
+// only in one FrozenEdges at a time.
+template <typename NodeT>
+class FrozenEdges
+{
+public:
+    enum EdgeKind {
+        CONTROL = 0,
+        REV_CONTROL,
+        DATA,
+        REV_DATA,
+        USE,
+        USER,
+        KINDS_NUM
+    };
+
+    class edges_range {
+        const unsigned *b;
+        const unsigned *e;
+
+    public:
+        edges_range(const unsigned *b_, const unsigned *e_) : b(b_), e(e_) {}
+
+        const unsigned *begin() const { return b; }
+        const unsigned *end() const { return e; }
+        size_t size() const { return e - b; }
+        bool empty() const { return b == e; }
+    };
+
+private:
+    static const unsigned NO_ID = ~0U;
+
+    std::vector<NodeT *> _nodes;
+    // the offsets of the edges of (node, kind) in _targets
+    std::vector<unsigned> _offsets;
+    std::vector<unsigned> _targets;
+    bool _frozen{false};
+
+    unsigned _findId(const NodeT *n) const {
+        unsigned id = n->getFrozenId();
+        if (id < _nodes.size() && _nodes[id] == n)
+            return id;
+        return NO_ID;
+    }
+
+    template <typename IT>
+    void _addEdges(IT begin, IT end) {
+        for (IT I = begin; I != end; ++I)
+            _targets.push_back(add(*I));
+        _offsets.push_back(static_cast<unsigned>(_targets.size()));
+    }
+
+public:
+    // add the node that should be frozen, returns its ID
+    unsigned add(NodeT *n) {
+        assert(!_frozen && "Adding a node to frozen edges");
+        unsigned id = _findId(n);
+        if (id != NO_ID)
+            return id;
+
+        id = static_cast<unsigned>(_nodes.size());
+        n->setFrozenId(id);
+        _nodes.push_back(n);
+        return id;
+    }
+
+    // add all the nodes of the graph
+    void addGraph(DependenceGraph<NodeT> *dg) {
+        for (auto& it : *dg)
+            add(it.second);
+
+        if (auto glob = dg->getGlobalNodes()) {
+            for (auto& it : *glob)
+                add(it.second);
+        }
+
+        if (NodeT *entry = dg->getEntry())
+            add(entry);
+        if (NodeT *exit = dg->getExit())
+            add(exit);
+    }
+
+    // copy the edges of the added nodes. The nodes reachable
+    // from the added nodes (e.g. the parameters) are added too,
+    // so every edge leads to a node that has an ID.
+    void freeze() {
+        assert(!_frozen && "The edges are already frozen");
+        _offsets.reserve(_nodes.size() * KINDS_NUM + 1);
+        _offsets.push_back(0);
+
+        // the nodes may be added while iterating
+        for (size_t i = 0; i < _nodes.size(); ++i) {
+            NodeT *n = _nodes[i];
+            _addEdges(n->control_begin(), n->control_end());
+            _addEdges(n->rev_control_begin(), n->rev_control_end());
+            _addEdges(n->data_begin(), n->data_end());
+            _addEdges(n->rev_data_begin(), n->rev_data_end());
+            _addEdges(n->use_begin(), n->use_end());
+            _addEdges(n->user_begin(), n->user_end());
+        }
+
+        _offsets.shrink_to_fit();
+        _targets.shrink_to_fit();
+        _nodes.shrink_to_fit();
+        _frozen = true;
+    }
+
+    // release the edge containers of the frozen nodes,
+    // from now on, only the frozen edges are available
+    void releaseNodeEdges() {
+        assert(_frozen && "Releasing edges that are not frozen");
+        for (NodeT *n : _nodes)
+            n->dropEdges();
+    }
+
+    bool isFrozen() const { return _frozen; }
+    bool contains(const NodeT *n) const { return _findId(n) != NO_ID; }
+
+    unsigned getId(const NodeT *n) const {
+        unsigned id = _findId(n);
+        assert(id != NO_ID && "The node is not frozen");
+        return id;
+    }
+
+    NodeT *getNode(unsigned id) const {
+        assert(id < _nodes.size());
+        return _nodes[id];
+    }
+
+    size_t size() const { return _nodes.size(); }
+    size_t edgesNum() const { return _targets.size(); }
+
+    // the edges of a node that is not frozen (or of any node
+    // before calling freeze()) are empty
+    edges_range edges(unsigned id, EdgeKind kind) const {
+        if (!_frozen || id >= _nodes.size())
+            return edges_range(nullptr, nullptr);
+
+        size_t row = static_cast<size_t>(id) * KINDS_NUM + kind;
+        return edges_range(_targets.data() + _offsets[row],
+                           _targets.data() + _offsets[row + 1]);
+    }
+
+    edges_range edges(const NodeT *n, EdgeKind kind) const {
+        return edges(_findId(n), kind);
+    }
+};
+
+} // namespace dg
+
+#endif // _DG_FROZEN_EDGES_H_
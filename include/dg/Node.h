@@ -266,6 +266,23 @@ public:
     use_iterator user_end() { return userEdges.end(); }
     const_use_iterator user_end() const { return userEdges.end(); }
 
+    // release the edge containers of this node without updating
+    // the other nodes. Use it only when the edges of all the nodes
+    // are released (e.g. after the edges were frozen, see FrozenEdges)
+    void dropEdges()
+    {
+        EdgesT().swap(controlDepEdges);
+        EdgesT().swap(revControlDepEdges);
+        EdgesT().swap(dataDepEdges);
+        EdgesT().swap(revDataDepEdges);
+        EdgesT().swap(useEdges);
+        EdgesT().swap(userEdges);
+    }
+
+    // the ID of this node in FrozenEdges
+    unsigned int getFrozenId() const { return frozen_id; }
+    void setFrozenId(unsigned int id) { frozen_id = id; }
+
     size_t getControlDependenciesNum() const { return controlDepEdges.size(); }
     size_t getRevControlDependenciesNum() const { return revControlDepEdges.size(); }
     size_t getDataDependenciesNum() const { return dataDepEdges.size(); }
@@ -405,6 +422,9 @@ private:
     // id of the slice this nodes is in. If it is 0, it is in no slice
     uint32_t slice_id;
 
+    // id of this node in the frozen edges (if they were frozen)
+    unsigned int frozen_id{~0U};
+
 #ifdef ENABLE_CFG
     // some analyses need classical CFG edges
     // and it is better to have even basic blocks
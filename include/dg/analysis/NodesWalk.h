@@ -1,6 +1,8 @@
 #ifndef _DG_NODES_WALK_H_
 #define _DG_NODES_WALK_H_
 
+#include <atomic>
+
 #include "dg/DGParameters.h"
 #include "dg/analysis/Analysis.h"
 
@@ -29,6 +31,23 @@ enum NodesWalkFlags {
     NODES_WALK_BB_POSTDOM_FRONTIERS     = 1 << 10,
 };
 
+///
+// Computes the data dependencies of nodes on demand.
+// If a nodes walk has a provider, it queries the provider
+// for every node before it follows the reverse data dependencies
+// or the use edges of the node. The provider adds the edges
+// to the node from the nodes it depends on. A node can be queried
+// more times (in more walks), the provider should remember
+// the nodes that it has already processed.
+template <typename NodeT>
+class DataDependenceProvider
+{
+public:
+    virtual ~DataDependenceProvider() = default;
+
+    virtual void computeDataDependencies(NodeT *n) = 0;
+};
+
 // this is a base class for nodes walk, it contains
 // counter. If we would add counter (even static) into
 // NodesWalk itself, we'd have counter for every
@@ -40,13 +59,14 @@ class NodesWalkBase : public Analysis<NodeT>
 protected:
     // this counter will increase each time we run
     // NodesWalk, so it can be used as an indicator
-    // that we queued a node in a particular run or not
-    static unsigned int walk_run_counter;
+    // that we queued a node in a particular run or not.
+    // The walks may run in more threads (on disjoint graphs)
+    static std::atomic<unsigned int> walk_run_counter;
 };
 
 // counter definition
 template<typename NodeT>
-unsigned int NodesWalkBase<NodeT>::walk_run_counter = 0;
+std::atomic<unsigned int> NodesWalkBase<NodeT>::walk_run_counter{0};
 
 template <typename NodeT, typename QueueT>
 class NodesWalk : public NodesWalkBase<NodeT>
@@ -80,6 +100,10 @@ public:
             if (options == 0)
                 continue;
 
+            if (dd_provider
+                && (options & (NODES_WALK_REV_DD | NODES_WALK_USER)))
+                dd_provider->computeDataDependencies(n);
+
             // add unprocessed vertices
             if (options & NODES_WALK_CD) {
                 processEdges(n->control_begin(), n->control_end());
@@ -125,6 +149,13 @@ public:
         }
     }
 
+    // compute the reverse data dependencies and the use edges
+    // of the nodes on demand
+    void setDataDependenceProvider(DataDependenceProvider<NodeT> *p)
+    {
+        dd_provider = p;
+    }
+
     // push a node into queue
     // This method is public so that analysis can
     // push some extra nodes into queue as they want.
@@ -222,6 +253,7 @@ private:
     // id of particular nodes walk
     unsigned int run_id;
     uint32_t options;
+    DataDependenceProvider<NodeT> *dd_provider{nullptr};
 };
 
 enum BBlockWalkFlags {
@@ -252,13 +284,14 @@ class BBlockWalkBase : public BBlockAnalysis<NodeT>
 protected:
     // this counter will increase each time we run
     // NodesWalk, so it can be used as an indicator
-    // that we queued a node in a particular run or not
-    static unsigned int walk_run_counter;
+    // that we queued a node in a particular run or not.
+    // The walks may run in more threads (on disjoint graphs)
+    static std::atomic<unsigned int> walk_run_counter;
 };
 
 // counter definition
 template<typename NodeT>
-unsigned int BBlockWalkBase<NodeT>::walk_run_counter = 0;
+std::atomic<unsigned int> BBlockWalkBase<NodeT>::walk_run_counter{0};
 
 #ifdef ENABLE_CFG
 template <typename NodeT, typename QueueT>
@@ -0,0 +1,317 @@
+#ifndef _DG_BITVECTOR_POINTS_TO_SET_H_
+#define _DG_BITVECTOR_POINTS_TO_SET_H_
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "dg/analysis/PointsTo/Pointer.h"
+#include "dg/ADT/Bitvector.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+///
+// Global mapping of the targets and offsets of pointers to dense IDs.
+// The IDs are assigned in the order in which the targets (offsets)
+// are first seen, so they do not depend on the addresses of the nodes.
+// The unknown offset has always the ID 0.
+// A destroyed node releases its ID (see ~PSNode), so a new node allocated
+// at the same address does not inherit it. The released IDs are reused,
+// so the table does not grow with every new PointerSubgraph.
+class PointerIdsTable {
+public:
+    using IDT = uint32_t;
+
+private:
+    std::unordered_map<PSNode *, IDT> _targetIds;
+    std::vector<PSNode *> _targets;
+    std::vector<IDT> _freeTargetIds;
+    std::unordered_map<Offset::type, IDT> _offsetIds;
+    std::vector<Offset::type> _offsets;
+
+    template <typename T>
+    static IDT _getId(std::unordered_map<T, IDT>& ids,
+                      std::vector<T>& values, T val) {
+        auto it = ids.find(val);
+        if (it != ids.end())
+            return it->second;
+
+        assert(values.size() < std::numeric_limits<IDT>::max()
+               && "Run out of IDs");
+        IDT id = static_cast<IDT>(values.size());
+        ids.emplace(val, id);
+        values.push_back(val);
+        return id;
+    }
+
+    template <typename T>
+    static bool _findId(const std::unordered_map<T, IDT>& ids,
+                        T val, IDT& id) {
+        auto it = ids.find(val);
+        if (it == ids.end())
+            return false;
+
+        id = it->second;
+        return true;
+    }
+
+public:
+    PointerIdsTable() {
+        _getId(_offsetIds, _offsets, Offset::UNKNOWN);
+    }
+
+    IDT getTargetId(PSNode *target) {
+        if (_freeTargetIds.empty() || _targetIds.count(target) > 0)
+            return _getId(_targetIds, _targets, target);
+
+        IDT id = _freeTargetIds.back();
+        _freeTargetIds.pop_back();
+        assert(_targets[id] == nullptr);
+        _targetIds.emplace(target, id);
+        _targets[id] = target;
+        return id;
+    }
+
+    // the target is being destroyed, its ID may be given to another node
+    void releaseTarget(PSNode *target) {
+        auto it = _targetIds.find(target);
+        if (it == _targetIds.end())
+            return;
+
+        _targets[it->second] = nullptr;
+        _freeTargetIds.push_back(it->second);
+        _targetIds.erase(it);
+    }
+
+    // the number of targets that have an ID
+    size_t targetsNum() const { return _targetIds.size(); }
+
+    IDT getOffsetId(Offset off) { return _getId(_offsetIds, _offsets, *off); }
+
+    // get the ID only if it has been assigned already
+    bool findTargetId(PSNode *target, IDT& id) const {
+        return _findId(_targetIds, target, id);
+    }
+    bool findOffsetId(Offset off, IDT& id) const {
+        return _findId(_offsetIds, *off, id);
+    }
+
+    PSNode *getTarget(IDT id) const {
+        assert(id < _targets.size());
+        assert(_targets[id] && "The target has been destroyed");
+        return _targets[id];
+    }
+
+    Offset getOffset(IDT id) const {
+        assert(id < _offsets.size());
+        return Offset(_offsets[id]);
+    }
+
+    static PointerIdsTable& get() {
+        // never destroyed, global nodes may use it
+        // in their destructors
+        static PointerIdsTable *table = new PointerIdsTable();
+        return *table;
+    }
+};
+
+///
+// Points-to set that is one sparse bitvector over the pairs
+// (target ID, offset ID). The bit of a pair is (target ID << 32 | offset ID),
+// so all the pointers to one target are in a contiguous interval
+// of the bitvector (usually in a single word) and the operations
+// on the whole set are operations on words. The pointers
+// are iterated in the order of the IDs of the targets.
+class BitvectorPointsToSet {
+    using IDT = PointerIdsTable::IDT;
+    using BitvectorT = ADT::SparseBitvector;
+
+    static_assert(sizeof(size_t) >= 2 * sizeof(IDT),
+                  "Cannot encode pointers into bits");
+
+    BitvectorT pointers;
+
+    static PointerIdsTable& _ids() { return PointerIdsTable::get(); }
+
+    static size_t _bit(IDT target, IDT offset) {
+        return (static_cast<size_t>(target) << 32) | offset;
+    }
+
+    static size_t _targetBegin(IDT target) { return _bit(target, 0); }
+    static size_t _targetEnd(IDT target) {
+        return (static_cast<size_t>(target) + 1) << 32;
+    }
+
+    static IDT _targetOf(size_t bit) { return static_cast<IDT>(bit >> 32); }
+    static IDT _offsetOf(size_t bit) { return static_cast<IDT>(bit); }
+
+    // the bit of the pointer if the pointer has IDs assigned
+    static bool _findBit(const Pointer& ptr, size_t& bit) {
+        IDT t, o;
+        if (!_ids().findTargetId(ptr.target, t) ||
+            !_ids().findOffsetId(ptr.offset, o))
+            return false;
+
+        bit = _bit(t, o);
+        return true;
+    }
+
+    bool addWithUnknownOffset(IDT target) {
+        size_t unknown = _bit(target, 0);
+        if (pointers.get(unknown))
+            return false;
+
+        // get rid of other offsets and keep
+        // only the unknown offset
+        pointers.unsetRange(_targetBegin(target), _targetEnd(target));
+        pointers.set(unknown);
+        return true;
+    }
+
+public:
+    bool add(PSNode *target, Offset off) {
+        IDT t = _ids().getTargetId(target);
+        if (off.isUnknown())
+            return addWithUnknownOffset(t);
+
+        if (pointers.get(_bit(t, 0)))
+            return false;
+
+        return !pointers.set(_bit(t, _ids().getOffsetId(off)));
+    }
+
+    bool add(const Pointer& ptr) {
+        return add(ptr.target, ptr.offset);
+    }
+
+    bool remove(const Pointer& ptr) {
+        return remove(ptr.target, ptr.offset);
+    }
+
+    ///
+    // Remove pointer to this target with this offset.
+    // This is method really removes the pair
+    // (target, off) even when the off is unknown
+    bool remove(PSNode *target, Offset offset) {
+        size_t bit;
+        if (!_findBit(Pointer(target, offset), bit))
+            return false;
+
+        return pointers.unset(bit);
+    }
+
+    ///
+    // Remove pointers pointing to this target
+    bool removeAny(PSNode *target) {
+        IDT t;
+        if (!_ids().findTargetId(target, t))
+            return false;
+
+        return pointers.unsetRange(_targetBegin(t), _targetEnd(t));
+    }
+
+    // make union of the two sets and store it
+    // into 'this' set (i.e. merge rhs to this set)
+    bool merge(const BitvectorPointsToSet& rhs) {
+        return pointers.merge(rhs.pointers);
+    }
+
+    bool pointsTo(const Pointer& ptr) const {
+        size_t bit;
+        if (!_findBit(ptr, bit))
+            return false;
+
+        return pointers.get(bit);
+    }
+
+    // points to the pointer or the the same target
+    // with unknown offset? Note: we do not count
+    // unknown memory here...
+    bool mayPointTo(const Pointer& ptr) const {
+        return pointsTo(ptr) ||
+                pointsTo(Pointer(ptr.target, Offset::UNKNOWN));
+    }
+
+    bool mustPointTo(const Pointer& ptr) const {
+        assert(!ptr.offset.isUnknown() && "Makes no sense");
+        return pointsTo(ptr) && isSingleton();
+    }
+
+    bool pointsToTarget(PSNode *target) const {
+        IDT t;
+        if (!_ids().findTargetId(target, t))
+            return false;
+
+        return pointers.hasAnyInRange(_targetBegin(t), _targetEnd(t));
+    }
+
+    // points to a single target?
+    bool isSingleton() const {
+        return !pointers.empty() &&
+                _targetOf(pointers.first()) == _targetOf(pointers.last());
+    }
+
+    bool empty() const { return pointers.empty(); }
+
+    size_t count(const Pointer& ptr) const {
+        return pointsTo(ptr);
+    }
+
+    bool has(const Pointer& ptr) const {
+        return count(ptr) > 0;
+    }
+
+    size_t size() const { return pointers.size(); }
+
+    void swap(BitvectorPointsToSet& rhs) { pointers.swap(rhs.pointers); }
+
+    bool operator==(const BitvectorPointsToSet& rhs) const {
+        return pointers == rhs.pointers;
+    }
+
+    class const_iterator {
+        typename BitvectorT::const_iterator it;
+
+        const_iterator(const BitvectorT& pointers, bool end = false)
+        : it(end ? pointers.end() : pointers.begin()) {}
+
+    public:
+        const_iterator() = default;
+
+        const_iterator& operator++() {
+            ++it;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        Pointer operator*() const {
+            return Pointer(_ids().getTarget(_targetOf(*it)),
+                           _ids().getOffset(_offsetOf(*it)));
+        }
+
+        bool operator==(const const_iterator& rhs) const { return it == rhs.it; }
+        bool operator!=(const const_iterator& rhs) const { return !operator==(rhs); }
+
+        friend class BitvectorPointsToSet;
+    };
+
+    const_iterator begin() const { return const_iterator(pointers); }
+    const_iterator end() const { return const_iterator(pointers, true /* end */); }
+
+    friend class const_iterator;
+};
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_BITVECTOR_POINTS_TO_SET_H_
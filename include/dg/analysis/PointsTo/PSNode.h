@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <cstdarg>
+#include <memory>
 #include <string>
 
 #ifndef NDEBUG
@@ -284,9 +285,17 @@ public:
         }
     }
 
-    virtual ~PSNode() = default;
+    virtual ~PSNode() {
+#if defined(POINTS_TO_SET_BITVECTOR)
+        PointerIdsTable::get().releaseTarget(this);
+#endif
+    }
 
     PSNodeType getType() const { return type; }
+    // change the type of the node. This is meant for the analyses
+    // that simplify the graph and cannot remove the node from it,
+    // e.g. turn a copy (CAST, GEP) into PHI
+    void setType(PSNodeType t) { type = t; }
 
     void setParent(PSNode *p) { parent = p; }
     PSNode *getParent() { return parent; }
@@ -299,6 +308,11 @@ public:
     bool isUnknownMemory() const { return type == PSNodeType::UNKNOWN_MEM; }
     bool isInvalidated() const { return type == PSNodeType::INVALIDATED; }
 
+private:
+    // the pointers added to pointsTo (if recording them)
+    std::unique_ptr<PointsToSetT> addedPointers;
+
+public:
     // make this public, that's basically the only
     // reason the PointerSubgraph node exists, so don't hide it
     PointsToSetT pointsTo;
@@ -306,7 +320,12 @@ public:
     // convenient helper
     bool addPointsTo(PSNode *n, Offset o)
     {
-        return pointsTo.add(Pointer(n, o));
+        if (!pointsTo.add(Pointer(n, o)))
+            return false;
+
+        if (addedPointers)
+            addedPointers->add(Pointer(n, o));
+        return true;
     }
 
     bool addPointsTo(const Pointer& ptr)
@@ -316,7 +335,33 @@ public:
 
     bool addPointsTo(const PointsToSetT& ptrs)
     {
-        return pointsTo.merge(ptrs);
+        if (!addedPointers)
+            return pointsTo.merge(ptrs);
+
+        bool changed = false;
+        for (const auto& ptr : ptrs)
+            changed |= addPointsTo(ptr);
+        return changed;
+    }
+
+    // Record the pointers that are added to the points-to set from now on
+    // (the difference). The analysis takes the recorded pointers
+    // and propagates only them to the users of the node.
+    void recordAddedPointers() {
+        if (!addedPointers)
+            addedPointers.reset(new PointsToSetT());
+    }
+
+    void stopRecordingAddedPointers() { addedPointers.reset(); }
+    bool recordsAddedPointers() const { return addedPointers != nullptr; }
+
+    // get the pointers added since the last call and start
+    // recording again from an empty set
+    PointsToSetT takeAddedPointers() {
+        assert(addedPointers && "Not recording the added pointers");
+        PointsToSetT ret;
+        ret.swap(*addedPointers);
+        return ret;
     }
 
     bool doesPointsTo(const Pointer& p)
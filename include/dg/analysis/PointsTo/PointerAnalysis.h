@@ -1,13 +1,16 @@
 #ifndef _DG_POINTER_ANALYSIS_H_
 #define _DG_POINTER_ANALYSIS_H_
 
+#include <algorithm>
 #include <cassert>
+#include <queue>
 #include <vector>
 
 #include "dg/analysis/PointsTo/Pointer.h"
 #include "dg/analysis/PointsTo/MemoryObject.h"
 #include "dg/analysis/PointsTo/PointerSubgraph.h"
 #include "dg/analysis/PointsTo/PointerAnalysisOptions.h"
+#include "dg/analysis/PointsTo/PointsToMapping.h"
 #include "dg/ADT/Queue.h"
 #include "dg/analysis/SCC.h"
 
@@ -19,6 +22,29 @@ namespace pta {
 extern PSNode *NULLPTR;
 extern PSNode *UNKNOWN_MEMORY;
 
+struct PointerAnalysisStatistics {
+    // number of processed nodes (a node is counted
+    // every time it is processed)
+    size_t processedNodes{0};
+    // how many times processing a node changed something
+    size_t changedNodes{0};
+    // number of iterations. In the worklist mode, a new iteration
+    // starts whenever the solver returns to a node that is earlier
+    // in the topological order than the previously processed node
+    size_t iterations{0};
+    // processed nodes per type
+    size_t processedByType[static_cast<size_t>(PSNodeType::INVALIDATED) + 1]{};
+
+    size_t getProcessed(PSNodeType t) const {
+        return processedByType[static_cast<size_t>(t)];
+    }
+
+    void addProcessed(PSNode *n) {
+        ++processedNodes;
+        ++processedByType[static_cast<size_t>(n->getType())];
+    }
+};
+
 class PointerAnalysis
 {
     // the pointer state subgraph
@@ -29,6 +55,34 @@ class PointerAnalysis
     std::vector<std::vector<PSNode *> > SCCs;
     unsigned sccs_index{0};
 
+    PointerAnalysisStatistics statistics;
+
+    // Node in the worklist. The nodes are processed in the topological
+    // order of SCCs (the SCCs are numbered in reverse topological order)
+    // and in the DFS order inside an SCC.
+    struct WorklistItem {
+        unsigned scc;
+        unsigned dfs;
+        unsigned id;
+        PSNode *node;
+
+        WorklistItem(PSNode *n)
+        : scc(n->getSCCId()), dfs(n->dfs_id), id(n->getID()), node(n) {}
+
+        // is the priority of this item lower than of rhs?
+        bool operator<(const WorklistItem& rhs) const {
+            if (scc != rhs.scc)
+                return scc < rhs.scc;
+            if (dfs != rhs.dfs)
+                return dfs > rhs.dfs;
+            return id > rhs.id;
+        }
+    };
+
+    std::priority_queue<WorklistItem> worklist;
+    // is the node with the given ID in the worklist?
+    std::vector<bool> queued;
+
     void initPointerAnalysis() {
         assert(PS && "Need PointerSubgraph object");
 
@@ -44,6 +98,24 @@ protected:
     std::vector<PSNode *> to_process;
     std::vector<PSNode *> changed;
 
+    // put the node into the worklist (if it is not there yet)
+    void pushToWorklist(PSNode *n) {
+        unsigned id = n->getID();
+        if (id >= queued.size())
+            queued.resize(std::max(static_cast<size_t>(id) + 1, PS->size()));
+
+        if (queued[id])
+            return;
+
+        queued[id] = true;
+        worklist.push(WorklistItem(n));
+    }
+
+    void pushUsersToWorklist(PSNode *n) {
+        for (PSNode *user : n->getUsers())
+            pushToWorklist(user);
+    }
+
 public:
 
     PointerAnalysis(PointerSubgraph *ps,
@@ -86,18 +158,61 @@ public:
     PointerSubgraph *getPS() const { return PS; }
 
     const std::vector<std::vector<PSNode *> > &getSCCs() const { return SCCs; }
+    const PointerAnalysisStatistics& getStatistics() const { return statistics; }
 
     virtual void enqueue(PSNode *n)
     {
-        changed.push_back(n);
+        if (options.worklist)
+            pushToWorklist(n);
+        else
+            changed.push_back(n);
+    }
+
+    // Used in the worklist mode. Processing the node 'n' changed the memory
+    // (or the graph), enqueue the nodes that may read the changed memory.
+    // Changes of the points-to set of 'n' are propagated to its users
+    // by the solver itself. By default, we enqueue all nodes
+    // reachable from 'n' (as the iterative scheme would do).
+    virtual void enqueueMemoryDependencies(PSNode *n)
+    {
+        for (PSNode *r : PS->getNodes(n)) {
+            if (r != n)
+                pushToWorklist(r);
+        }
+    }
+
+    // Get the pointers from the points-to set of the operand 'idx'
+    // of 'node' that the node has not processed yet (so that the
+    // transfer function is applied only to them). Returns false
+    // if the analysis does not keep track of the processed pointers,
+    // then all the pointers of the operand are processed.
+    virtual bool getNewPointers(PSNode * /*node*/, unsigned /*idx*/,
+                                PointsToSetT& /*ptrs*/)
+    {
+        return false;
+    }
+
+    // Nodes that the analysis replaced by other nodes during the run
+    // (e.g. collapsed cycles) mapped to the nodes that hold their
+    // points-to sets now. The replaced nodes are kept in the graph
+    // (as no-ops), but their points-to sets are empty, so the client
+    // should compose its mapping with this one.
+    virtual PointsToMapping<PSNode *> getReplacedNodes() const
+    {
+        return {};
     }
 
-    void preprocess() {
+    // called before the fixpoint is computed
+    // (staged analyses may compute their first stage here)
+    virtual void preprocess() {
         // do some optimizations
         if (options.preprocessGeps)
             preprocessGEPs();
     }
 
+    // called after the fixpoint is computed
+    virtual void postprocess() {}
+
     void initialize_queue() {
         assert(to_process.empty());
 
@@ -111,14 +226,19 @@ public:
     bool iteration() {
         assert(changed.empty());
 
+        ++statistics.iterations;
         for (PSNode *cur : to_process) {
+            statistics.addProcessed(cur);
+
             bool enq = false;
             enq |= beforeProcessed(cur);
             enq |= processNode(cur);
             enq |= afterProcessed(cur);
 
-            if (enq)
-                enqueue(cur);
+            if (enq) {
+                ++statistics.changedNodes;
+                changed.push_back(cur);
+            }
         }
 
         return !changed.empty();
@@ -152,13 +272,18 @@ public:
         sanityCheck();
 
         // do fixpoint
-        do {
-            iteration();
-            queue_changed();
-        } while (!to_process.empty());
+        if (options.worklist) {
+            runWorklist();
+        } else {
+            do {
+                iteration();
+                queue_changed();
+            } while (!to_process.empty());
+        }
 
         assert(to_process.empty());
         assert(changed.empty());
+        assert(worklist.empty());
 
         // NOTE: With flow-insensitive analysis, it may happen that
         // we have not reached the fixpoint here. This is beacuse
@@ -171,6 +296,8 @@ public:
         // generated, so this is OK.
 
         sanityCheck();
+
+        postprocess();
     }
 
     // generic error
@@ -206,6 +333,9 @@ private:
     // check the sanity of results of pointer analysis
     void sanityCheck();
 
+    // compute the fixpoint using the worklist
+    void runWorklist();
+
     void preprocessGEPs()
     {
         // if a node is in a loop (a scc that has more than one node),
@@ -226,12 +356,16 @@ private:
     bool processNode(PSNode *);
     bool processLoad(PSNode *node);
     bool processGep(PSNode *node);
+    bool processStore(PSNode *node);
+    bool processStore(PSNode *node, const PointsToSetT& targets,
+                      const PointsToSetT& values);
     bool processMemcpy(PSNode *node);
     bool processMemcpy(std::vector<MemoryObject *>& srcObjects,
                        std::vector<MemoryObject *>& destObjects,
                        const Pointer& sptr, const Pointer& dptr,
                        Offset len);
 
+protected:
     void recomputeSCCs()
     {
         SCC<PSNode> scc_comp(sccs_index);
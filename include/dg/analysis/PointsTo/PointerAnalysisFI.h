@@ -4,6 +4,9 @@
 #include <cassert>
 #include <vector>
 #include <memory>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "PointerAnalysis.h"
 
@@ -17,31 +20,390 @@ namespace pta {
 class PointerAnalysisFI : public PointerAnalysis
 {
     std::vector<std::unique_ptr<MemoryObject>> memory_objects;
+    // nodes that read the memory object. When the object
+    // changes, only these nodes need to be processed again
+    std::unordered_map<MemoryObject *, std::set<PSNode *>> readers;
+
+    // Difference propagation: the operands record the pointers
+    // that were added to their points-to sets and the nodes get only
+    // these pointers (pending), not the whole sets. Further, we keep
+    // the memory objects that the node reads and that changed since
+    // the last processing. The changes of memory are known only
+    // in the worklist mode, so we propagate the differences only there.
+    struct Inputs {
+        // the operands that the pending pointers come from
+        // (the operands may be replaced when collapsing cycles)
+        PSNode *operands[2]{nullptr, nullptr};
+        PointsToSetT pending[2];
+        std::set<MemoryObject *> changedObjects;
+    };
+
+    std::unordered_map<PSNode *, Inputs> inputs;
+    // the nodes that record the added pointers
+    std::vector<PSNode *> recording;
+    bool deltaPropagation{false};
+
+    // Online (lazy) cycle detection. Nodes on a cycle of copy nodes
+    // have the same points-to sets, so we collapse them into
+    // one node (the representative). The other nodes are turned
+    // into PHI nodes without operands (we cannot remove them,
+    // the client may still have references to them) and they are mapped
+    // to the representative.
+    bool collapseCycles{false};
+    std::unordered_map<PSNode *, PSNode *> collapsed;
+    // copy edges that we have already searched for a cycle
+    std::set<std::pair<PSNode *, PSNode *>> checkedEdges;
+
+    // the node only copies the pointers from its operands
+    static bool isCopy(PSNode *n) {
+        switch (n->getType()) {
+            case PSNodeType::PHI:
+            case PSNodeType::CAST:
+                return true;
+            case PSNodeType::GEP:
+                return PSNodeGep::get(n)->getOffset().isZero();
+            default:
+                return false;
+        }
+    }
+
+    PSNode *getRepresentative(PSNode *n) const {
+        auto it = collapsed.find(n);
+        while (it != collapsed.end()) {
+            n = it->second;
+            it = collapsed.find(n);
+        }
+
+        return n;
+    }
+
+    void addCopyOperand(PSNode *rep, PSNode *op) {
+        if (op == rep || rep->hasOperand(op))
+            return;
+
+        // CAST and GEP can have only one operand
+        rep->setType(PSNodeType::PHI);
+        rep->addOperand(op);
+    }
+
+    void collapse(const std::vector<PSNode *>& cycle) {
+        std::unordered_set<PSNode *> members(cycle.begin(), cycle.end());
+        PSNode *rep = cycle[0];
+
+        // the operands from outside of the cycle
+        std::vector<PSNode *> operands;
+        for (PSNode *m : cycle) {
+            for (PSNode *op : m->getOperands()) {
+                if (members.count(op) == 0 &&
+                    std::find(operands.begin(), operands.end(), op) == operands.end())
+                    operands.push_back(op);
+            }
+        }
+
+        for (PSNode *m : cycle) {
+            if (m == rep)
+                continue;
+
+            m->replaceAllUsesWith(rep);
+            m->removeAllOperands();
+            m->setType(PSNodeType::PHI);
+
+            rep->addPointsTo(m->pointsTo);
+            PointsToSetT().swap(m->pointsTo);
+
+            inputs.erase(m);
+            collapsed[m] = rep;
+        }
+
+        // the representative gets the operands of the whole cycle.
+        // It must be a PHI even if the cycle is closed (it has
+        // no operands then), CAST and GEP need exactly one operand.
+        rep->removeAllOperands();
+        rep->setType(PSNodeType::PHI);
+        for (PSNode *op : operands)
+            addCopyOperand(rep, op);
+
+        // what the representative processed is not valid
+        // with the new operands
+        inputs.erase(rep);
+
+        pushToWorklist(rep);
+        pushUsersToWorklist(rep);
+    }
+
+    // find the cycles of copy nodes that are reachable from 'start'
+    // (Tarjan's algorithm for SCCs over the edges from operands to users)
+    // and collapse them
+    void collapseCyclesFrom(PSNode *start) {
+        struct Frame {
+            PSNode *node;
+            size_t nextUser;
+        };
+
+        // node -> (DFS index, lowpoint)
+        std::unordered_map<PSNode *, std::pair<unsigned, unsigned>> index;
+        std::unordered_set<PSNode *> onStack;
+        std::vector<PSNode *> stack;
+        std::vector<Frame> dfs;
+        std::vector<std::vector<PSNode *>> cycles;
+
+        auto visit = [&](PSNode *n) {
+            unsigned idx = static_cast<unsigned>(index.size());
+            index.emplace(n, std::make_pair(idx, idx));
+            stack.push_back(n);
+            onStack.insert(n);
+            dfs.push_back(Frame{n, 0});
+        };
+
+        visit(start);
+        while (!dfs.empty()) {
+            PSNode *cur = dfs.back().node;
+            size_t nextUser = dfs.back().nextUser++;
+
+            if (nextUser < cur->getUsers().size()) {
+                PSNode *user = cur->getUsers()[nextUser];
+                if (!isCopy(user))
+                    continue;
+
+                auto it = index.find(user);
+                if (it == index.end()) {
+                    visit(user);
+                } else if (onStack.count(user) > 0) {
+                    unsigned& low = index[cur].second;
+                    low = std::min(low, it->second.first);
+                }
+
+                continue;
+            }
+
+            dfs.pop_back();
+            const auto& cur_idx = index[cur];
+            if (!dfs.empty()) {
+                unsigned& low = index[dfs.back().node].second;
+                low = std::min(low, cur_idx.second);
+            }
+
+            if (cur_idx.first != cur_idx.second)
+                continue;
+
+            // 'cur' is the root of an SCC
+            std::vector<PSNode *> scc;
+            PSNode *n;
+            do {
+                n = stack.back();
+                stack.pop_back();
+                onStack.erase(n);
+                scc.push_back(n);
+            } while (n != cur);
+
+            if (scc.size() > 1)
+                cycles.push_back(std::move(scc));
+        }
+
+        for (const auto& cycle : cycles)
+            collapse(cycle);
+    }
+
+    // we want to have memory in allocation sites
+    static PSNode *getAllocationSite(PSNode *target) {
+        if (target->getType() == PSNodeType::CAST ||
+            target->getType() == PSNodeType::GEP)
+            return target->getOperand(0);
+
+        if (target->getType() == PSNodeType::CONSTANT) {
+            assert(target->pointsTo.size() == 1);
+            return (*target->pointsTo.begin()).target;
+        }
+
+        return target;
+    }
+
+    // give the pointers added to 'op' to the users that already
+    // got the rest of its points-to set
+    void flushAddedPointers(PSNode *op) {
+        PointsToSetT added = op->takeAddedPointers();
+        if (added.empty())
+            return;
+
+        for (PSNode *user : op->getUsers()) {
+            auto it = inputs.find(user);
+            if (it == inputs.end())
+                continue;
+
+            for (unsigned i = 0; i < 2; ++i) {
+                if (it->second.operands[i] == op)
+                    it->second.pending[i].merge(added);
+            }
+        }
+    }
 
 protected:
     PointerAnalysisFI() = default;
 
 public:
-    PointerAnalysisFI(PointerSubgraph *ps)
-    : PointerAnalysis(ps) {
+    PointerAnalysisFI(PointerSubgraph *ps,
+                      const PointerAnalysisOptions& opts)
+    : PointerAnalysis(ps, opts), deltaPropagation(opts.worklist),
+      collapseCycles(opts.worklist && opts.collapseCycles) {
         memory_objects.reserve(std::max(ps->size() / 100, static_cast<size_t>(8)));
     }
 
-    void getMemoryObjects(PSNode *where, const Pointer& pointer,
-                          std::vector<MemoryObject *>& objects) override
+    PointerAnalysisFI(PointerSubgraph *ps) : PointerAnalysisFI(ps, {}) {}
+
+    void enqueueMemoryDependencies(PSNode *n) override
     {
-        // irrelevant in flow-insensitive
-        (void) where;
-        PSNode *n = pointer.target;
+        PSNode *dest;
+        if (n->getType() == PSNodeType::STORE)
+            dest = n->getOperand(1);
+        else if (n->getType() == PSNodeType::MEMCPY)
+            dest = PSNodeMemcpy::get(n)->getDestination();
+        else {
+            // the graph changed
+            PointerAnalysis::enqueueMemoryDependencies(n);
+            return;
+        }
+
+        // the memory is not bound to a place in the program,
+        // so we enqueue the readers of the objects that could change
+        std::vector<MemoryObject *> objects;
+        for (const auto& ptr : dest->pointsTo) {
+            if (!ptr.isValid() || ptr.isInvalidated())
+                continue;
 
-        // we want to have memory in allocation sites
-        if (n->getType() == PSNodeType::CAST || n->getType() == PSNodeType::GEP)
-            n = n->getOperand(0);
-        else if (n->getType() == PSNodeType::CONSTANT) {
-            assert(n->pointsTo.size() == 1);
-            n = (*n->pointsTo.begin()).target;
+            objects.clear();
+            getMemoryObjects(n, ptr, objects);
+            for (MemoryObject *mo : objects) {
+                auto it = readers.find(mo);
+                if (it == readers.end())
+                    continue;
+
+                for (PSNode *reader : it->second) {
+                    if (deltaPropagation &&
+                        reader->getType() == PSNodeType::LOAD)
+                        inputs[reader].changedObjects.insert(mo);
+
+                    pushToWorklist(reader);
+                }
+            }
         }
+    }
+
+    bool beforeProcessed(PSNode *n) override
+    {
+        if (collapsed.empty())
+            return false;
+
+        // the graph may have been extended (on calls via function
+        // pointers), so the node may use collapsed nodes
+        // or it may be a collapsed node that got new operands
+        std::vector<PSNode *> operands(n->getOperands());
+        for (PSNode *op : operands) {
+            if (collapsed.count(op) > 0)
+                op->replaceAllUsesWith(getRepresentative(op));
+        }
+
+        if (collapsed.count(n) > 0 && n->getOperandsNum() > 0) {
+            PSNode *rep = getRepresentative(n);
+            operands = n->getOperands();
+            n->removeAllOperands();
+            for (PSNode *op : operands)
+                addCopyOperand(rep, op);
+
+            pushToWorklist(rep);
+        }
+
+        return false;
+    }
+
+    bool afterProcessed(PSNode *n) override
+    {
+        if (!collapseCycles || !isCopy(n) || n->pointsTo.empty())
+            return false;
+
+        // lazy cycle detection: the node has the same points-to set
+        // as its operand, so the edge between them may lie on a cycle.
+        // Search for the cycle only once for every edge.
+        for (PSNode *op : n->getOperands()) {
+            if (isCopy(op) && op->pointsTo.size() == n->pointsTo.size() &&
+                checkedEdges.emplace(op, n).second) {
+                collapseCyclesFrom(n);
+                break;
+            }
+        }
+
+        return false;
+    }
 
+    PointsToMapping<PSNode *> getReplacedNodes() const override
+    {
+        PointsToMapping<PSNode *> mapping;
+        mapping.reserve(collapsed.size());
+        for (const auto& it : collapsed)
+            mapping.add(it.first, getRepresentative(it.first));
+
+        return mapping;
+    }
+
+    bool getNewPointers(PSNode *node, unsigned idx,
+                        PointsToSetT& ptrs) override
+    {
+        if (!deltaPropagation)
+            return false;
+
+        assert(idx < 2);
+        PSNode *op = node->getOperand(idx);
+        Inputs& I = inputs[node];
+
+        if (!op->recordsAddedPointers()) {
+            op->recordAddedPointers();
+            recording.push_back(op);
+        } else {
+            flushAddedPointers(op);
+        }
+
+        if (I.operands[idx] != op) {
+            // the first processing (or the operand was replaced),
+            // the node must get the whole points-to set
+            I.operands[idx] = op;
+            PointsToSetT().swap(I.pending[idx]);
+            ptrs.merge(op->pointsTo);
+        } else {
+            ptrs.swap(I.pending[idx]);
+        }
+
+        // the load must read again the memory that changed
+        if (node->getType() == PSNodeType::LOAD && !I.changedObjects.empty()) {
+            for (const auto& ptr : op->pointsTo) {
+                if (!ptr.isValid() || ptr.isInvalidated() || ptr.isUnknown())
+                    continue;
+                MemoryObject *mo
+                    = getAllocationSite(ptr.target)->getData<MemoryObject>();
+                if (I.changedObjects.count(mo) > 0)
+                    ptrs.add(ptr);
+            }
+
+            I.changedObjects.clear();
+        }
+
+        return true;
+    }
+
+    void postprocess() override
+    {
+        // the analysis finished, do not record the changes anymore
+        for (PSNode *n : recording)
+            n->stopRecordingAddedPointers();
+
+        recording.clear();
+        inputs.clear();
+    }
+
+    void getMemoryObjects(PSNode *where, const Pointer& pointer,
+                          std::vector<MemoryObject *>& objects) override
+    {
+        // the place is irrelevant in flow-insensitive analysis,
+        // we use it only to remember who reads the memory
+        PSNode *n = getAllocationSite(pointer.target);
         if (n->getType() == PSNodeType::FUNCTION)
             return;
 
@@ -56,6 +418,10 @@ public:
             n->setData<MemoryObject>(mo);
         }
 
+        if (where->getType() == PSNodeType::LOAD ||
+            where->getType() == PSNodeType::MEMCPY)
+            readers[mo].insert(where);
+
         objects.push_back(mo);
     }
 };
@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <memory>
+#include <set>
 
 #include "MemoryObject.h"
 #include "PointerSubgraph.h"
@@ -18,7 +19,11 @@ class PointerAnalysisFS : public PointerAnalysis
 {
 public:
     //using MemoryObjectsSetT = std::set<MemoryObject *>;
-    using MemoryMapT = std::map<PSNode *, std::unique_ptr<MemoryObject>>;
+    // The memory objects are shared between the memory maps
+    // and they are copied only when they are going to be modified
+    // (copy-on-write), so a merge of maps copies only
+    // the pointers to the objects that did not change.
+    using MemoryMapT = std::map<PSNode *, std::shared_ptr<MemoryObject>>;
 
     // this is an easy but not very efficient implementation,
     // works for testing
@@ -95,24 +100,67 @@ public:
         return changed;
     }
 
+    void enqueueMemoryDependencies(PSNode *n) override
+    {
+        MemoryMapT *mm = n->getData<MemoryMapT>();
+        assert(mm && "Do not have memory map");
+
+        // the node shares the memory map with its predecessor,
+        // so it did not change the memory (the map has just been set)
+        if (n->predecessorsNum() == 1 &&
+            n->getSinglePredecessor()->getData<MemoryMapT>() == mm) {
+            for (PSNode *succ : n->getSuccessors())
+                pushToWorklist(succ);
+            return;
+        }
+
+        // the nodes that share the memory map with 'n' see the change
+        // directly. The nodes with their own memory map merge the change
+        // in afterProcessed and propagate it further if it changes them.
+        std::set<PSNode *> visited;
+        std::vector<PSNode *> stack(n->getSuccessors());
+        while (!stack.empty()) {
+            PSNode *cur = stack.back();
+            stack.pop_back();
+
+            if (!visited.insert(cur).second)
+                continue;
+
+            pushToWorklist(cur);
+            // continue also through the nodes that do not have
+            // the memory map yet, they may share it too
+            MemoryMapT *curmm = cur->getData<MemoryMapT>();
+            if (curmm == mm || curmm == nullptr) {
+                for (PSNode *succ : cur->getSuccessors())
+                    stack.push_back(succ);
+            }
+        }
+    }
+
     void getMemoryObjects(PSNode *where, const Pointer& pointer,
                           std::vector<MemoryObject *>& objects) override
     {
         MemoryMapT *mm = where->getData<MemoryMapT>();
         assert(mm && "Node does not have memory map");
 
+        // if this psnode is a write to memory, get an object that
+        // can be modified (and create a new one if we haven't found any,
+        // so that the write has something to write to)
         auto I = mm->find(pointer.target);
-        if (I != mm->end()) {
-            objects.push_back(I->second.get());
+        if (canChangeMM(where)) {
+            // the store would not change the object,
+            // so there is no need to copy it
+            if (I != mm->end() && where->getType() == PSNodeType::STORE &&
+                includesPointers(I->second.get(), pointer.offset,
+                                 where->getOperand(0)->pointsTo))
+                objects.push_back(I->second.get());
+            else
+                objects.push_back(getWritableMO(mm, pointer.target));
+            return;
         }
 
-        // if we haven't found any memory object, but this psnode
-        // is a write to memory, create a new one, so that
-        // the write has something to write to
-        if (objects.empty() && canChangeMM(where)) {
-            MemoryObject *mo = new MemoryObject(pointer.target);
-            mm->emplace(pointer.target, std::unique_ptr<MemoryObject>(mo));
-            objects.push_back(mo);
+        if (I != mm->end()) {
+            objects.push_back(I->second.get());
         }
     }
 
@@ -147,6 +195,60 @@ protected:
             return false;
     }
 
+    // Get the memory object for 'target' from the memory map
+    // such that it can be modified. Copy the object if it is shared
+    // with other memory maps or create it if it does not exist.
+    static MemoryObject *getWritableMO(MemoryMapT *mm, PSNode *target) {
+        std::shared_ptr<MemoryObject>& moptr = (*mm)[target];
+        if (!moptr)
+            moptr = std::make_shared<MemoryObject>(target);
+        else if (moptr.use_count() > 1)
+            moptr = std::make_shared<MemoryObject>(*moptr);
+
+        assert(moptr.use_count() == 1);
+        return moptr.get();
+    }
+
+    // return true if adding 'ptr' to 'S' would not change 'S'
+    static bool includesPointer(const PointsToSetT& S, const Pointer& ptr) {
+        return S.has(ptr) || S.has(Pointer(ptr.target, Offset::UNKNOWN));
+    }
+
+    // return true if adding 'ptrs' to 'mo' at offset 'off' would not change 'mo'
+    static bool includesPointers(const MemoryObject *mo, const Offset& off,
+                                 const PointsToSetT& ptrs) {
+        if (ptrs.empty())
+            return true;
+
+        auto it = mo->find(off);
+        if (it == mo->end())
+            return false;
+
+        for (const auto& ptr : ptrs) {
+            if (!includesPointer(it->second, ptr))
+                return false;
+        }
+
+        return true;
+    }
+
+    // return true if merging 'from' to 'to' would not add any pointer
+    static bool includesObject(PSNode *node,
+                               const MemoryObject *to,
+                               const MemoryObject *from,
+                               const PointsToSetT *overwritten) {
+        for (const auto& fromIt : from->pointsTo) {
+            if (overwritten &&
+                overwritten->count(Pointer(node, fromIt.first)))
+                continue;
+
+            if (!includesPointers(to, fromIt.first, fromIt.second))
+                return false;
+        }
+
+        return true;
+    }
+
     static bool mergeObjects(PSNode *node,
                              MemoryObject *to,
                              MemoryObject *from,
@@ -173,17 +275,39 @@ protected:
         bool changed = false;
         for (auto& it : *from) {
             PSNode *fromTarget = it.first;
-            std::unique_ptr<MemoryObject>& toMo = (*mm)[fromTarget];
-            if (toMo == nullptr)
-                toMo.reset(new MemoryObject(fromTarget));
+            std::shared_ptr<MemoryObject>& toMo = (*mm)[fromTarget];
+            // the same object, nothing can change
+            if (toMo == it.second)
+                continue;
+
+            if (toMo == nullptr &&
+                (!overwritten || !overwritten->pointsToTarget(fromTarget))) {
+                // we do not have this object yet, just share it
+                toMo = it.second;
+                changed |= !isEmpty(toMo.get());
+                continue;
+            }
+
+            if (toMo &&
+                includesObject(fromTarget, toMo.get(), it.second.get(), overwritten))
+                continue;
 
-            changed |= mergeObjects(fromTarget, toMo.get(),
+            changed |= mergeObjects(fromTarget, getWritableMO(mm, fromTarget),
                                     it.second.get(), overwritten);
         }
 
         return changed;
     }
 
+    static bool isEmpty(const MemoryObject *mo) {
+        for (const auto& it : mo->pointsTo) {
+            if (!it.second.empty())
+                return false;
+        }
+
+        return true;
+    }
+
     MemoryMapT *createMM() {
         MemoryMapT *mm = new MemoryMapT();
         memoryMaps.emplace_back(mm);
@@ -23,14 +23,44 @@ class PointerAnalysisFSInv : public PointerAnalysisFS
         return n->predecessorsNum() > 1 || canChangeMM(n);
     }
 
-    static MemoryObject *getOrCreateMO(MemoryMapT *mm, PSNode *target) {
-        std::unique_ptr<MemoryObject>& moptr = (*mm)[target];
-        if (!moptr)
-            moptr.reset(new MemoryObject(target));
+    // The memory object of 'target' in the memory map. The object
+    // may be shared with other memory maps, so it is copied (or created)
+    // only before it is really changed, i.e., not when the handlers
+    // just find out that the invalidation does not change it.
+    class LazyMO {
+        MemoryMapT *mm;
+        PSNode *target;
+        MemoryObject *mo{nullptr};
+        bool writable{false};
+
+    public:
+        LazyMO(MemoryMapT *m, PSNode *t) : mm(m), target(t) {
+            auto it = mm->find(target);
+            if (it != mm->end())
+                mo = it->second.get();
+        }
 
-        assert(mm->find(target) != mm->end());
-        return moptr.get();
-    }
+        // nullptr if there is no object yet
+        const MemoryObject *get() const { return mo; }
+
+        MemoryObject *getWritable() {
+            if (!writable) {
+                mo = getWritableMO(mm, target);
+                writable = true;
+            }
+            return mo;
+        }
+
+        bool add(const Offset& off, const Pointer& ptr) {
+            if (mo) {
+                auto it = mo->find(off);
+                if (it != mo->end() && includesPointer(it->second, ptr))
+                    return false;
+            }
+
+            return getWritable()->pointsTo[off].add(ptr);
+        }
+    };
 
 public:
     using MemoryMapT = PointerAnalysisFS::MemoryMapT;
@@ -92,7 +122,7 @@ public:
                 alloc->getParent() == where->getParent();
     }
 
-    bool containsRemovableLocals(PSNode *where, PointsToSetT& S) {
+    bool containsRemovableLocals(PSNode *where, const PointsToSetT& S) const {
         for (const auto& ptr : S) {
             if (ptr.isNull() || ptr.isUnknown() || ptr.isInvalidated())
                 continue;
@@ -106,6 +136,18 @@ public:
         return false;
     }
 
+    bool containsRemovableLocals(PSNode *where, const MemoryObject *mo) const {
+        if (!mo)
+            return false;
+
+        for (const auto& it : *mo) {
+            if (containsRemovableLocals(where, it.second))
+                return true;
+        }
+
+        return false;
+    }
+
     // not very efficient
     void replaceLocalsWithInv(PSNode *where, PointsToSetT& S1) {
         PointsToSetT S;
@@ -157,17 +199,17 @@ public:
             if (isInvalidTarget(I.first))
                 continue;
 
-            // get or create a memory object for this target
-
-            MemoryObject *mo = getOrCreateMO(mm, I.first);
+            LazyMO mo(mm, I.first);
             MemoryObject *pmo = I.second.get();
 
-            for (auto& it : *mo) {
-                // remove pointers to locals from the points-to set
-                if (containsRemovableLocals(node, it.second)) {
-                    replaceLocalsWithInv(node, it.second);
-                    assert(!containsRemovableLocals(node, it.second));
-                    changed = true;
+            if (containsRemovableLocals(node, mo.get())) {
+                for (auto& it : *mo.getWritable()) {
+                    // remove pointers to locals from the points-to set
+                    if (containsRemovableLocals(node, it.second)) {
+                        replaceLocalsWithInv(node, it.second);
+                        assert(!containsRemovableLocals(node, it.second));
+                        changed = true;
+                    }
                 }
             }
 
@@ -176,20 +218,18 @@ public:
                 if (predS.empty())
                     continue;
 
-                PointsToSetT& S = mo->pointsTo[it.first];
-
                 // merge pointers from the previous states
                 // but do not include the pointers
                 // that _must_ point to destroyed memory
                 for (const auto& ptr : predS) {
                     PSNodeAlloc *alloc = PSNodeAlloc::get(ptr.target);
                     if (alloc && isLocal(alloc, node) && knownInstance(alloc)) {
-                        changed |= S.add(INVALIDATED);
+                        changed |= mo.add(it.first, INVALIDATED);
                     } else
-                        changed |= S.add(ptr);
+                        changed |= mo.add(it.first, ptr);
                 }
 
-                assert(!S.empty());
+                assert(!mo.get()->pointsTo.at(it.first).empty());
             }
         }
 
@@ -282,19 +322,87 @@ public:
         // if we know exactly which memory object
         // is being used for freeing the memory,
         // we can set it to invalidated
-        auto mo = getOrCreateMO(mm, target);
-        if (mo->pointsTo.size() == 1) {
-            auto& S = mo->pointsTo[0];
-            if (S.size() == 1 && (*S.begin()).target == INVALIDATED) {
+        LazyMO lmo(mm, target);
+        if (lmo.get() && lmo.get()->pointsTo.size() == 1) {
+            auto it = lmo.get()->find(0);
+            if (it != lmo.get()->end() && it->second.size() == 1 &&
+                (*it->second.begin()).target == INVALIDATED) {
                 return false; // no update
             }
         }
 
+        MemoryObject *mo = lmo.getWritable();
         mo->pointsTo.clear();
         mo->pointsTo[0].add(INVALIDATED);
         return true;
     }
 
+    // invalidate the pointers in S that may point to the memory
+    // pointed by 'operand', return true if S changed
+    bool invalidatePointers(const PSNode *operand, PointsToSetT& S) const {
+        if (invStrongUpdate(operand)) { // strong update
+            const auto& ptr = *(operand->pointsTo.begin());
+            if (ptr.isUnknown())
+                return S.add(INVALIDATED);
+            if (ptr.isNull() || ptr.isInvalidated())
+                return false;
+            if (S.pointsToTarget(ptr.target)) {
+                replaceTargetWithInv(S, ptr.target);
+                assert(!S.pointsToTarget(ptr.target));
+                return true;
+            }
+            return false;
+        }
+
+        // weak update
+        for (const auto& ptr : operand->pointsTo) {
+            if (ptr.isNull() || ptr.isInvalidated())
+                continue;
+
+            // invalidate on unknown memory yields invalidate for
+            // each element
+            if (ptr.isUnknown() || S.pointsToTarget(ptr.target))
+                return S.add(INVALIDATED);
+        }
+
+        return false;
+    }
+
+    // would invalidatePointers() change S?
+    bool invalidatesPointers(const PSNode *operand, const PointsToSetT& S) const {
+        if (invStrongUpdate(operand)) {
+            const auto& ptr = *(operand->pointsTo.begin());
+            if (ptr.isUnknown())
+                return !includesPointer(S, INVALIDATED);
+            if (ptr.isNull() || ptr.isInvalidated())
+                return false;
+            return S.pointsToTarget(ptr.target);
+        }
+
+        for (const auto& ptr : operand->pointsTo) {
+            if (ptr.isNull() || ptr.isInvalidated())
+                continue;
+
+            if (ptr.isUnknown() || S.pointsToTarget(ptr.target))
+                return !includesPointer(S, INVALIDATED);
+        }
+
+        return false;
+    }
+
+    // would invalidatePointers() change any points-to set of mo?
+    bool invalidatesObject(const PSNode *operand, const MemoryObject *mo) const {
+        if (!mo)
+            return false;
+
+        for (const auto& it : *mo) {
+            if (invalidatesPointers(operand, it.second))
+                return true;
+        }
+
+        return false;
+    }
+
     bool invalidateMemory(PSNode *node, PSNode *pred,
                           bool is_free = false)
     {
@@ -331,8 +439,7 @@ public:
             if (strong_update == I.first)
                 continue;
 
-            // get or create a memory object for this target
-            MemoryObject *mo = getOrCreateMO(mm, I.first);
+            LazyMO mo(mm, I.first);
             MemoryObject *pmo = I.second.get();
 
             // Remove references to invalidated memory from mo
@@ -340,30 +447,9 @@ public:
             // Otherwise, add the invalidated pointer to the points-to sets
             // (strong vs. weak update) as we do not know which
             // object is actually being invalidated.
-            for (auto& it : *mo) {
-                if (invStrongUpdate(operand)) { // strong update
-                    const auto& ptr = *(operand->pointsTo.begin());
-                    if (ptr.isUnknown())
-                        changed |= it.second.add(INVALIDATED);
-                    else if (ptr.isNull() || ptr.isInvalidated())
-                        continue;
-                    else if (it.second.pointsToTarget(ptr.target)) {
-                        replaceTargetWithInv(it.second, ptr.target);
-                        assert(!it.second.pointsToTarget(ptr.target));
-                        changed = true;
-                    }
-                } else { // weak update
-                    for (const auto& ptr : operand->pointsTo) {
-                        if (ptr.isNull() || ptr.isInvalidated())
-                            continue;
-
-                        // invalidate on unknown memory yields invalidate for
-                        // each element
-                        if (ptr.isUnknown() || it.second.pointsToTarget(ptr.target)) {
-                            changed |= it.second.add(INVALIDATED);
-                        }
-                    }
-                }
+            if (invalidatesObject(operand, mo.get())) {
+                for (auto& it : *mo.getWritable())
+                    changed |= invalidatePointers(operand, it.second);
             }
 
             // merge pointers from pmo to mo, but skip
@@ -373,8 +459,6 @@ public:
                 if (predS.empty()) // keep the map clean
                     continue;
 
-                PointsToSetT& S = mo->pointsTo[it.first];
-
                 // merge pointers from the previous states
                 // but do not include the pointers
                 // that may point to freed memory.
@@ -387,17 +471,17 @@ public:
                             // we still want to copy the original pointer
                             // if we cannot perform strong update
                             // on this invalidated memory
-                            changed |= S.add(ptr);
+                            changed |= mo.add(it.first, ptr);
                         }
-                        changed |= S.add(INVALIDATED);
+                        changed |= mo.add(it.first, INVALIDATED);
                     } else {
                         // this is a pointer to some memory that was not
                         // invalidated, so merge it into the points-to set
-                        changed |= S.add(ptr);
+                        changed |= mo.add(it.first, ptr);
                     }
                 }
 
-                assert(!S.empty());
+                assert(!mo.get()->pointsTo.at(it.first).empty());
             }
         }
 
@@ -19,8 +19,22 @@ struct PointerAnalysisOptions : AnalysisOptions {
     // INVALIDATED object.
     bool invalidateNodes{false};
 
+    // Process the nodes using a worklist ordered by the strongly
+    // connected components and re-process only the nodes that
+    // are affected by a change. If false, every iteration re-processes
+    // all the nodes reachable from the changed nodes.
+    bool worklist{false};
+
+    // Detect cycles of copy nodes (PHI, CAST and GEP with zero offset)
+    // during the analysis and collapse them into one node
+    // (all the nodes on such a cycle have the same points-to set).
+    // Used only by the flow-insensitive analysis in the worklist mode.
+    bool collapseCycles{false};
+
     PointerAnalysisOptions& setInvalidateNodes(bool b) { invalidateNodes = b; return *this;}
     PointerAnalysisOptions& setPreprocessGeps(bool b)  { preprocessGeps = b; return *this;}
+    PointerAnalysisOptions& setWorklist(bool b)        { worklist = b; return *this;}
+    PointerAnalysisOptions& setCollapseCycles(bool b)  { collapseCycles = b; return *this;}
 };
 
 } // namespace analysis
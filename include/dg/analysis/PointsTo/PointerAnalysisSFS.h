@@ -0,0 +1,440 @@
+#ifndef _DG_ANALYSIS_POINTS_TO_SPARSE_FLOW_SENSITIVE_H_
+#define _DG_ANALYSIS_POINTS_TO_SPARSE_FLOW_SENSITIVE_H_
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "dg/ADT/Queue.h"
+#include "PointerAnalysisFI.h"
+#include "PointerAnalysisFS.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+///
+// Staged sparse flow-sensitive pointer analysis.
+//
+// First, we run the flow-insensitive analysis to get an over-approximation
+// of the memory that every node may access (and to build the whole graph,
+// including the calls via function pointers). Then we connect every node
+// that accesses memory to the nodes that may have defined that memory last
+// (def-use chains like in memory SSA) and compute the flow-sensitive
+// points-to sets propagating the memory only along these chains instead
+// of along every edge of the graph. The results are not always the same
+// as the results of PointerAnalysisFS: the calls via function pointers
+// are resolved by the flow-insensitive stage (so the values returned
+// from these calls come from that stage) and the strong updates
+// are done in a different order.
+//
+class PointerAnalysisSFS : public PointerAnalysisFS
+{
+    // the flow-insensitive stage. The calls via function pointers
+    // and errors are handled by the sparse analysis (that may be
+    // specialized by the user)
+    class FlowInsensitiveStage : public PointerAnalysisFI {
+        PointerAnalysisSFS *parent;
+
+    public:
+        FlowInsensitiveStage(PointerSubgraph *ps, PointerAnalysisSFS *p,
+                             const PointerAnalysisOptions& opts)
+        : PointerAnalysisFI(ps, opts), parent(p) {}
+
+        bool error(PSNode *at, const char *msg) override {
+            return parent->error(at, msg);
+        }
+
+        bool errorEmptyPointsTo(PSNode *from, PSNode *to) override {
+            return parent->errorEmptyPointsTo(from, to);
+        }
+
+        bool functionPointerCall(PSNode *where, PSNode *what) override {
+            return parent->functionPointerCall(where, what);
+        }
+    };
+
+    PointerAnalysisOptions fiOptions;
+
+    // the memory (targets of pointers) that the node may access
+    // according to the flow-insensitive stage (sorted)
+    std::unordered_map<PSNode *, std::vector<PSNode *>> accessed;
+    // for every node that accesses memory and every accessed target,
+    // the nodes that may have defined the memory last
+    std::unordered_map<PSNode *,
+                       std::map<PSNode *, std::vector<PSNode *>>> definitions;
+    // the nodes that use the memory defined by the node
+    std::unordered_map<PSNode *, std::set<PSNode *>> memoryUsers;
+    // the memory defined by the nodes (only the accessed targets)
+    std::unordered_map<PSNode *, MemoryMapT> memory;
+
+    static bool isDefinition(PSNode *n) {
+        return n->getType() == PSNodeType::STORE ||
+               n->getType() == PSNodeType::MEMCPY;
+    }
+
+    bool accesses(PSNode *n, PSNode *target) const {
+        auto it = accessed.find(n);
+        if (it == accessed.end())
+            return false;
+
+        return std::binary_search(it->second.begin(), it->second.end(), target);
+    }
+
+    void addAccessed(PSNode *n, PSNode *ptrNode) {
+        auto& targets = accessed[n];
+        for (const auto& ptr : ptrNode->pointsTo) {
+            if (!ptr.isValid() || ptr.isInvalidated() ||
+                ptr.target->getType() == PSNodeType::FUNCTION)
+                continue;
+
+            targets.push_back(ptr.target);
+        }
+    }
+
+    void gatherAccessedMemory(const std::vector<PSNode *>& nodes) {
+        for (PSNode *n : nodes) {
+            switch (n->getType()) {
+                case PSNodeType::LOAD:
+                    addAccessed(n, n->getOperand(0));
+                    break;
+                case PSNodeType::STORE:
+                    addAccessed(n, n->getOperand(1));
+                    break;
+                case PSNodeType::MEMCPY:
+                    // memcpy reads the source in its own memory map
+                    // (as it is in FS), so it defines both
+                    addAccessed(n, PSNodeMemcpy::get(n)->getSource());
+                    addAccessed(n, PSNodeMemcpy::get(n)->getDestination());
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        for (auto& it : accessed) {
+            auto& targets = it.second;
+            std::sort(targets.begin(), targets.end());
+            targets.erase(std::unique(targets.begin(), targets.end()),
+                          targets.end());
+        }
+    }
+
+    // Basic blocks of the graph (maximal paths without branching).
+    // The definitions are searched block by block, the nodes inside
+    // of the blocks are not visited.
+    struct Block {
+        PSNode *last{nullptr};
+        std::vector<unsigned> successors;
+    };
+
+    static bool startsBlock(PSNode *n, PSNode *root) {
+        return n == root || n->predecessorsNum() != 1 ||
+               n->getSinglePredecessor()->successorsNum() != 1;
+    }
+
+    // the position of the node (block, index in the block)
+    // is stored in 'position' indexed by the ID of the node
+    std::vector<Block>
+    buildBlocks(std::vector<std::pair<unsigned, unsigned>>& position) {
+        static const unsigned NONE = ~0U;
+        PSNode *root = getPS()->getRoot();
+        std::vector<Block> blocks;
+        position.assign(getPS()->size(), {NONE, 0});
+
+        auto fill = [&](PSNode *leader) {
+            unsigned b = static_cast<unsigned>(blocks.size());
+            blocks.emplace_back();
+            PSNode *cur = leader;
+            unsigned idx = 0;
+            do {
+                position[cur->getID()] = {b, idx++};
+                blocks[b].last = cur;
+                cur = cur->getSingleSuccessorOrNull();
+            } while (cur && !startsBlock(cur, root) &&
+                     position[cur->getID()].first == NONE);
+        };
+
+        for (PSNode *n : getPS()->getNodes(root)) {
+            if (startsBlock(n, root))
+                fill(n);
+        }
+
+        for (Block& B : blocks) {
+            for (PSNode *succ : B.last->getSuccessors()) {
+                if (position[succ->getID()].first != NONE)
+                    B.successors.push_back(position[succ->getID()].first);
+            }
+        }
+
+        return blocks;
+    }
+
+    static void mergeDefinitions(std::vector<PSNode *>& to,
+                                 const std::vector<PSNode *>& from,
+                                 std::vector<PSNode *>& tmp) {
+        tmp.clear();
+        std::set_union(to.begin(), to.end(), from.begin(), from.end(),
+                       std::back_inserter(tmp));
+        to.swap(tmp);
+    }
+
+    // For every node that accesses memory and every accessed target,
+    // find the nodes that may define the target last before the node.
+    // This is a reaching definitions analysis over the basic blocks
+    // done separately for every target. It visits only the blocks that
+    // the definitions of the target reach, and inside of the blocks
+    // only the nodes that access the target.
+    void buildDefUseChains() {
+        std::vector<std::pair<unsigned, unsigned>> position;
+        std::vector<Block> blocks = buildBlocks(position);
+
+        // target -> the nodes that access it
+        std::map<PSNode *, std::vector<PSNode *>> accesses;
+        for (const auto& it : accessed) {
+            for (PSNode *target : it.second)
+                accesses[target].push_back(it.first);
+        }
+
+        auto before = [&position](PSNode *a, PSNode *b) {
+            return position[a->getID()] < position[b->getID()];
+        };
+
+        // block -> the definitions reaching the start of the block,
+        // or the end of the block (reused for every target)
+        std::unordered_map<unsigned, std::vector<PSNode *>> in;
+        std::unordered_map<unsigned, PSNode *> lastDef;
+        std::vector<PSNode *> tmp;
+
+        for (auto& it : accesses) {
+            PSNode *target = it.first;
+            auto& nodes = it.second;
+            std::sort(nodes.begin(), nodes.end(), before);
+
+            in.clear();
+            lastDef.clear();
+            for (PSNode *n : nodes) {
+                if (isDefinition(n))
+                    lastDef[position[n->getID()].first] = n;
+            }
+
+            // propagate the definitions from the blocks
+            // that define the target
+            ADT::QueueLIFO<unsigned> queue;
+            for (const auto& ld : lastDef)
+                queue.push(ld.first);
+
+            while (!queue.empty()) {
+                unsigned b = queue.pop();
+                auto ld = lastDef.find(b);
+                std::vector<PSNode *> single;
+                const std::vector<PSNode *> *out;
+                if (ld != lastDef.end()) {
+                    single.push_back(ld->second);
+                    out = &single;
+                } else {
+                    out = &in[b];
+                }
+
+                for (unsigned succ : blocks[b].successors) {
+                    auto& sin = in[succ];
+                    size_t size = sin.size();
+                    mergeDefinitions(sin, *out, tmp);
+                    // the blocks that define the target pass only
+                    // their own definition, they are already queued
+                    if (sin.size() != size && lastDef.count(succ) == 0)
+                        queue.push(succ);
+                }
+            }
+
+            // the definitions of the nodes are the definitions
+            // reaching the block or the last definition before them
+            // in the block
+            unsigned curBlock = ~0U;
+            std::vector<PSNode *> cur;
+            for (PSNode *n : nodes) {
+                unsigned b = position[n->getID()].first;
+                if (b != curBlock) {
+                    curBlock = b;
+                    auto I = in.find(b);
+                    if (I == in.end())
+                        cur.clear();
+                    else
+                        cur = I->second;
+                }
+
+                auto& rd = definitions[n][target];
+                rd = cur;
+                for (PSNode *d : rd)
+                    memoryUsers[d].insert(n);
+
+                if (isDefinition(n))
+                    cur.assign(1, n);
+            }
+        }
+    }
+
+    // the points-to sets of these nodes are computed by the analysis
+    // (the others are set when building the graph)
+    static void resetPointsTo(PSNode *n) {
+        switch (n->getType()) {
+            case PSNodeType::CALL_RETURN:
+                // keep the functions called via pointers (and what
+                // these calls return), the graph has already been built
+                if (n->getPairedNode() &&
+                    n->getPairedNode()->getType() == PSNodeType::CALL_FUNCPTR)
+                    break;
+                // fall-through
+            case PSNodeType::LOAD:
+            case PSNodeType::GEP:
+            case PSNodeType::CAST:
+            case PSNodeType::PHI:
+            case PSNodeType::RETURN:
+                PointsToSetT().swap(n->pointsTo);
+                break;
+            default:
+                break;
+        }
+    }
+
+public:
+    using MemoryMapT = PointerAnalysisFS::MemoryMapT;
+
+    // the def-use chains are followed only by the worklist solver,
+    // so we always use it
+    PointerAnalysisSFS(PointerSubgraph *ps,
+                       PointerAnalysisOptions opts)
+    : PointerAnalysisFS(ps, PointerAnalysisOptions(opts).setWorklist(true)),
+      // do not let the first stage change the graph
+      fiOptions(opts.setPreprocessGeps(false).setCollapseCycles(false)) {}
+
+    PointerAnalysisSFS(PointerSubgraph *ps) : PointerAnalysisSFS(ps, {}) {}
+
+    void preprocess() override
+    {
+        PointerAnalysisFS::preprocess();
+
+        // the flow-insensitive stage
+        {
+            FlowInsensitiveStage FI(getPS(), this, fiOptions);
+            FI.run();
+
+            // calls via function pointers may have extended the graph
+            recomputeSCCs();
+
+            auto nodes = getPS()->getNodes(getPS()->getRoot());
+            gatherAccessedMemory(nodes);
+
+            for (PSNode *n : nodes) {
+                resetPointsTo(n);
+                // the memory objects of FI analysis are gone
+                n->setData<MemoryObject>(nullptr);
+            }
+        }
+
+        buildDefUseChains();
+    }
+
+    bool beforeProcessed(PSNode *) override
+    {
+        return false;
+    }
+
+    bool afterProcessed(PSNode *n) override
+    {
+        if (!isDefinition(n))
+            return false;
+
+        // strong update, the same as in FS
+        PointsToSetT *overwritten = nullptr;
+        if (n->getType() == PSNodeType::STORE) {
+            if (!pointsToAllocationInLoop(n->getOperand(1)))
+                overwritten = &n->getOperand(1)->pointsTo;
+        }
+
+        auto it = definitions.find(n);
+        if (it == definitions.end())
+            return false;
+
+        bool changed = false;
+        MemoryMapT& mm = memory[n];
+        for (const auto& dit : it->second) {
+            PSNode *target = dit.first;
+            for (PSNode *d : dit.second) {
+                if (d == n)
+                    continue;
+
+                MemoryMapT& dmm = memory[d];
+                auto I = dmm.find(target);
+                if (I == dmm.end())
+                    continue;
+
+                changed |= mergeObjects(target, getWritableMO(&mm, target),
+                                        I->second.get(), overwritten);
+            }
+        }
+
+        return changed;
+    }
+
+    void enqueueMemoryDependencies(PSNode *n) override
+    {
+        if (!isDefinition(n)) {
+            // the graph changed
+            PointerAnalysis::enqueueMemoryDependencies(n);
+            return;
+        }
+
+        auto it = memoryUsers.find(n);
+        if (it == memoryUsers.end())
+            return;
+
+        for (PSNode *user : it->second)
+            pushToWorklist(user);
+    }
+
+    void getMemoryObjects(PSNode *where, const Pointer& pointer,
+                          std::vector<MemoryObject *>& objects) override
+    {
+        // the definition reads and writes its own memory
+        if (isDefinition(where)) {
+            objects.push_back(getWritableMO(&memory[where], pointer.target));
+            return;
+        }
+
+        auto it = definitions.find(where);
+        if (it == definitions.end())
+            return;
+
+        auto dit = it->second.find(pointer.target);
+        if (dit == it->second.end())
+            return;
+
+        for (PSNode *d : dit->second) {
+            MemoryMapT& dmm = memory[d];
+            auto I = dmm.find(pointer.target);
+            if (I != dmm.end())
+                objects.push_back(I->second.get());
+        }
+    }
+
+    // memory defined by the node (nullptr if the node defines no memory)
+    const MemoryMapT *getDefinedMemory(PSNode *n) const {
+        auto it = memory.find(n);
+        if (it == memory.end())
+            return nullptr;
+
+        return &it->second;
+    }
+};
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_ANALYSIS_POINTS_TO_SPARSE_FLOW_SENSITIVE_H_
@@ -80,6 +80,10 @@ public:
     PSNode *create(PSNodeType t, ...) {
         va_list args;
         PSNode *node = nullptr;
+        // the order of evaluation of function arguments is unspecified,
+        // so we must not call va_arg directly in the arguments
+        PSNode *op1, *op2;
+        Offset::type off;
 
         va_start(args, t);
         switch (t) {
@@ -88,20 +92,21 @@ public:
                 node = new PSNodeAlloc(getNewNodeId(), t);
                 break;
             case PSNodeType::GEP:
-                node = new PSNodeGep(getNewNodeId(),
-                                     va_arg(args, PSNode *),
-                                     va_arg(args, Offset::type));
+                op1 = va_arg(args, PSNode *);
+                off = va_arg(args, Offset::type);
+                node = new PSNodeGep(getNewNodeId(), op1, off);
                 break;
             case PSNodeType::MEMCPY:
-                node = new PSNodeMemcpy(getNewNodeId(),
-                                        va_arg(args, PSNode *),
-                                        va_arg(args, PSNode *),
-                                        va_arg(args, Offset::type));
+                op1 = va_arg(args, PSNode *);
+                op2 = va_arg(args, PSNode *);
+                off = va_arg(args, Offset::type);
+                node = new PSNodeMemcpy(getNewNodeId(), op1, op2, off);
                 break;
             case PSNodeType::CONSTANT:
+                op1 = va_arg(args, PSNode *);
+                off = va_arg(args, Offset::type);
                 node = new PSNode(getNewNodeId(), PSNodeType::CONSTANT,
-                                  va_arg(args, PSNode *),
-                                  va_arg(args, Offset::type));
+                                  op1, off);
                 break;
             case PSNodeType::ENTRY:
                 node = new PSNodeEntry(getNewNodeId());
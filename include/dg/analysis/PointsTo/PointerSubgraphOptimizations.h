@@ -1,16 +1,40 @@
 #ifndef _DG_POINTER_SUBGRAPH_OPTIMIZATIONS_H_
 #define _DG_POINTER_SUBGRAPH_OPTIMIZATIONS_H_
 
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
 #include "PointsToMapping.h"
+#include "PointerSubgraph.h"
 
 namespace dg {
 namespace analysis {
 namespace pta {
 
+// nodes that the optimizations must not remove from the graph
+// (e.g. the nodes that the client needs to extend the graph later)
+using PreservedNodesT = std::set<PSNode *>;
+
+static inline bool isPreserved(const PreservedNodesT *preserved, PSNode *nd) {
+    return preserved && preserved->count(nd) > 0;
+}
+
+// remove the node from the graph, the node must not have any users
+static inline void removeNode(PointerSubgraph *PS, PSNode *nd) {
+    nd->removeAllOperands();
+    nd->isolate();
+    // this should not break the iterator over the nodes
+    PS->remove(nd);
+}
+
 class PSNoopRemover {
     PointerSubgraph *PS;
+    const PreservedNodesT *preserved;
 public:
-    PSNoopRemover(PointerSubgraph *PS) : PS(PS) {}
+    PSNoopRemover(PointerSubgraph *PS, const PreservedNodesT *preserved = nullptr)
+    : PS(PS), preserved(preserved) {}
 
     unsigned run() {
         unsigned removed = 0;
@@ -18,10 +42,9 @@ public:
             if (!nd)
                 continue;
 
-            if (nd->getType() == PSNodeType::NOOP) {
-                nd->isolate();
-                // this should not break the iterator
-                PS->remove(nd.get());
+            if (nd->getType() == PSNodeType::NOOP &&
+                !isPreserved(preserved, nd.get())) {
+                removeNode(PS, nd.get());
                 ++removed;
             }
         }
@@ -46,18 +69,21 @@ static inline bool usersImplyUnknown(PSNode *nd) {
     return true;
 }
 
-static inline bool allOperandsAreSame(PSNode *nd) {
-    auto opNum = nd->getOperandsNum();
-    if (opNum < 1)
-        return true;
+// get the only operand of the node that is not the node itself
+// (if there is exactly one such operand, otherwise nullptr)
+static inline PSNode *getSingleDistinctOperand(PSNode *nd) {
+    PSNode *single = nullptr;
+    for (PSNode *op : nd->getOperands()) {
+        if (op == nd || op == single)
+            continue;
 
-    PSNode *op0 = nd->getOperand(0);
-    for (decltype(opNum) i = 1; i < opNum; ++i) {
-        if (op0 != nd->getOperand(i))
-            return false;
+        if (single)
+            return nullptr;
+
+        single = op;
     }
 
-    return true;
+    return single;
 }
 
 // try to remove loads/stores that are provably
@@ -67,6 +93,7 @@ class PSUnknownsReducer {
     using MappingT = PointsToMapping<PSNode *>;
 
     PointerSubgraph *PS;
+    const PreservedNodesT *preserved;
     MappingT mapping;
 
     unsigned removed = 0;
@@ -80,37 +107,37 @@ class PSUnknownsReducer {
                 // this is an allocation that has only stores of unknown memory to it
                 // (and its address is not stored anywhere) and there are only loads
                 // from this memory (that must result to unknown)
-                if (usersImplyUnknown(nd.get())) {
-                    for (PSNode *user : nd->getUsers()) {
-                        if (user->getType() == PSNodeType::LOAD) {
-                            // replace the uses of the load value by unknown
-                            // (this is what would happen in the analysis)
-                            user->replaceAllUsesWith(UNKNOWN_MEMORY);
-                            mapping.add(user, UNKNOWN_MEMORY);
-                        }
-                        // store can be removed directly
-                        user->isolate();
-                        PS->remove(user);
-                        ++removed;
+                if (nd->getUsers().empty() || !usersImplyUnknown(nd.get()))
+                    continue;
+
+                // removing the users changes the users of the alloc
+                auto users = nd->getUsers();
+                for (PSNode *user : users) {
+                    if (isPreserved(preserved, user))
+                        continue;
+
+                    if (user->getType() == PSNodeType::LOAD) {
+                        // replace the uses of the load value by unknown
+                        // (this is what would happen in the analysis)
+                        user->replaceAllUsesWith(UNKNOWN_MEMORY);
+                        mapping.add(user, UNKNOWN_MEMORY);
                     }
-
-                    // NOTE: keep the alloca, as it contains the
-                    // pointer to itself and may be queried for this pointer
-                }
-            } else if (nd->getType() == PSNodeType::PHI && nd->getOperandsNum() == 0) {
-                for (PSNode *user : nd->getUsers()) {
-                    // replace the uses of this value with unknown
-                    user->replaceAllUsesWith(UNKNOWN_MEMORY);
-                    mapping.add(user, UNKNOWN_MEMORY);
-
                     // store can be removed directly
-                    user->isolate();
-                    PS->remove(user);
+                    removeNode(PS, user);
                     ++removed;
                 }
 
-                nd->isolate();
-                PS->remove(nd.get());
+                // NOTE: keep the alloca, as it contains the
+                // pointer to itself and may be queried for this pointer
+            } else if (nd->getType() == PSNodeType::PHI && nd->getOperandsNum() == 0 &&
+                       !isPreserved(preserved, nd.get())) {
+                // PHI without operands gathers only values
+                // that are not pointers, that is unknown memory
+                PSNode *phi = nd.get();
+                phi->replaceAllUsesWith(UNKNOWN_MEMORY);
+                mapping.add(phi, UNKNOWN_MEMORY);
+
+                removeNode(PS, phi);
                 assert(nd.get() == nullptr);
                 ++removed;
             }
@@ -118,7 +145,8 @@ class PSUnknownsReducer {
     }
 
 public:
-    PSUnknownsReducer(PointerSubgraph *PS) : PS(PS) {}
+    PSUnknownsReducer(PointerSubgraph *PS, const PreservedNodesT *preserved = nullptr)
+    : PS(PS), preserved(preserved) {}
 
     MappingT& getMapping() { return mapping; }
     const MappingT& getMapping() const { return mapping; }
@@ -133,8 +161,9 @@ class PSEquivalentNodesMerger {
 public:
     using MappingT = PointsToMapping<PSNode *>;
 
-    PSEquivalentNodesMerger(PointerSubgraph *S)
-    : PS(S), merged_nodes_num(0) {
+    PSEquivalentNodesMerger(PointerSubgraph *S,
+                            const PreservedNodesT *preserved = nullptr)
+    : PS(S), preserved(preserved), merged_nodes_num(0) {
         mapping.reserve(32);
     }
 
@@ -158,6 +187,8 @@ private:
                 continue;
 
             PSNode *node = nodeptr.get();
+            if (isPreserved(preserved, node))
+                continue;
 
             // cast is always 'a proxy' to the real value,
             // it does not change the pointers
@@ -166,9 +197,10 @@ private:
             else if (PSNodeGep *GEP = PSNodeGep::get(node)) {
                 if (GEP->getOffset().isZero()) // GEP with 0 offest is cast
                     merge(node, GEP->getSource());
-            } else if (node->getType() == PSNodeType::PHI &&
-                        node->getOperandsNum() > 0 && allOperandsAreSame(node)) {
-                merge(node, node->getOperand(0));
+            } else if (node->getType() == PSNodeType::PHI) {
+                // PHI with a single distinct operand is a cast too
+                if (PSNode *op = getSingleDistinctOperand(node))
+                    merge(node, op);
             }
         }
     }
@@ -179,8 +211,7 @@ private:
     void merge(PSNode *node1, PSNode *node2) {
         // remove node1
         node1->replaceAllUsesWith(node2);
-        node1->isolate();
-        PS->remove(node1);
+        removeNode(PS, node1);
 
         // update the mapping
         mapping.add(node1, node2);
@@ -189,43 +220,355 @@ private:
     }
 
     PointerSubgraph *PS;
+    const PreservedNodesT *preserved;
     // map nodes to its equivalent representant
     MappingT mapping;
 
     unsigned merged_nodes_num;
 };
 
+///
+// Offline variable substitution (in the style of hash-based value
+// numbering). Nodes that compute their points-to sets by the same
+// operation from the same operands have the same points-to sets,
+// so we keep only one of them. Merging nodes may make other nodes
+// equivalent, so we repeat it until nothing changes.
+// Loads are equivalent only in flow-insensitive analysis
+// (in flow-sensitive analysis they read different memory).
+// A node is replaced only by an equivalent node that dominates it
+// in the CFG of its procedure: the solvers re-process just the nodes
+// reachable from a changed node, so the users of the replaced node
+// must be reachable from the node that replaces it.
+// Constants do not change, so they are merged regardless of the CFG.
+class PSEquivalentValuesMerger {
+public:
+    using MappingT = PointsToMapping<PSNode *>;
+
+    PSEquivalentValuesMerger(PointerSubgraph *S,
+                             const PreservedNodesT *preserved = nullptr,
+                             bool flow_insensitive = false)
+    : PS(S), preserved(preserved), flow_insensitive(flow_insensitive) {}
+
+    MappingT& getMapping() { return mapping; }
+    const MappingT& getMapping() const { return mapping; }
+
+    unsigned getNumOfMergedNodes() const { return merged_nodes_num; }
+
+    unsigned run() {
+        while (mergeValues())
+            ;
+
+        return merged_nodes_num;
+    }
+
+private:
+    // the operation and the operands that define the value
+    struct Value {
+        PSNodeType type;
+        Offset::type offset{0};
+        PSNode *target{nullptr};
+        std::vector<PSNode *> operands;
+
+        bool operator<(const Value& rhs) const {
+            if (type != rhs.type)
+                return type < rhs.type;
+            if (offset != rhs.offset)
+                return offset < rhs.offset;
+            if (target != rhs.target)
+                return target < rhs.target;
+            return operands < rhs.operands;
+        }
+    };
+
+    bool getValue(PSNode *nd, Value& val) const {
+        val.type = nd->getType();
+        switch (nd->getType()) {
+            case PSNodeType::LOAD:
+                if (!flow_insensitive)
+                    return false;
+                // fall-through
+            case PSNodeType::CAST:
+                val.operands.push_back(nd->getOperand(0));
+                return true;
+            case PSNodeType::GEP:
+                val.operands.push_back(nd->getOperand(0));
+                val.offset = *PSNodeGep::get(nd)->getOffset();
+                return true;
+            case PSNodeType::CONSTANT:
+                assert(nd->pointsTo.size() == 1);
+                val.target = (*nd->pointsTo.begin()).target;
+                val.offset = *(*nd->pointsTo.begin()).offset;
+                return true;
+            case PSNodeType::PHI:
+                // the order and duplicates of operands do not matter,
+                // the PHI itself does not add anything
+                for (PSNode *op : nd->getOperands()) {
+                    if (op != nd)
+                        val.operands.push_back(op);
+                }
+                if (val.operands.empty())
+                    return false;
+
+                std::sort(val.operands.begin(), val.operands.end());
+                val.operands.erase(std::unique(val.operands.begin(),
+                                               val.operands.end()),
+                                   val.operands.end());
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // successors of the node in the CFG of its procedure,
+    // a call is followed by its call-return node
+    static void getIntraSuccessors(PSNode *nd, std::vector<PSNode *>& succs) {
+        for (PSNode *succ : nd->getSuccessors()) {
+            if (succ->getParent() == nd->getParent())
+                succs.push_back(succ);
+        }
+
+        if (nd->getType() == PSNodeType::CALL ||
+            nd->getType() == PSNodeType::CALL_FUNCPTR) {
+            PSNode *ret = nd->getPairedNode();
+            if (ret && ret != nd && ret->getParent() == nd->getParent())
+                succs.push_back(ret);
+        }
+    }
+
+    // Compute immediate dominators of the nodes of the procedure
+    // starting at 'root'. The algorithm is due:
+    //
+    // K. D. Cooper, T. J. Harvey, and K. Kennedy. 2001.
+    // A Simple, Fast Dominance Algorithm.
+    void computeDominators(PSNode *root) {
+        struct Frame {
+            PSNode *node;
+            std::vector<PSNode *> succs;
+            size_t next;
+        };
+
+        // the nodes in postorder and the predecessors of every node
+        std::vector<PSNode *> order;
+        std::map<PSNode *, std::vector<PSNode *>> preds;
+
+        std::vector<Frame> stack;
+        stack.push_back(Frame{root, {}, 0});
+        getIntraSuccessors(root, stack.back().succs);
+        visited[root->getID()] = true;
+
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            if (frame.next == frame.succs.size()) {
+                order.push_back(frame.node);
+                stack.pop_back();
+                continue;
+            }
+
+            PSNode *succ = frame.succs[frame.next++];
+            preds[succ].push_back(frame.node);
+            if (visited[succ->getID()])
+                continue;
+
+            visited[succ->getID()] = true;
+            // 'frame' is invalidated here
+            stack.push_back(Frame{succ, {}, 0});
+            getIntraSuccessors(succ, stack.back().succs);
+        }
+
+        for (unsigned i = 0; i < order.size(); ++i)
+            number[order[i]->getID()] = i + 1;
+
+        auto intersect = [this](unsigned a, unsigned b) {
+            while (a != b) {
+                while (number[a] < number[b])
+                    a = idom[a];
+                while (number[b] < number[a])
+                    b = idom[b];
+            }
+            return a;
+        };
+
+        idom[root->getID()] = root->getID();
+        bool changed;
+        do {
+            changed = false;
+            // reverse postorder without the root
+            for (auto it = order.rbegin() + 1, et = order.rend(); it != et; ++it) {
+                PSNode *nd = *it;
+                unsigned new_idom = 0;
+                for (PSNode *pred : preds[nd]) {
+                    if (!idom[pred->getID()])
+                        continue;
+                    new_idom = new_idom ? intersect(pred->getID(), new_idom)
+                                        : pred->getID();
+                }
+
+                if (idom[nd->getID()] != new_idom) {
+                    idom[nd->getID()] = new_idom;
+                    changed = true;
+                }
+            }
+        } while (changed);
+    }
+
+    void computeDominators() {
+        visited.assign(PS->size(), false);
+        number.assign(PS->size(), 0);
+        idom.assign(PS->size(), 0);
+
+        // the root of the graph (e.g. the globals) and the procedures
+        if (PS->getRoot())
+            computeDominators(PS->getRoot());
+
+        for (const auto& nodeptr : PS->getNodes()) {
+            PSNode *nd = nodeptr.get();
+            if (nd && nd->getType() == PSNodeType::ENTRY &&
+                nd->getParent() == nd && !visited[nd->getID()])
+                computeDominators(nd);
+        }
+    }
+
+    bool dominates(PSNode *a, PSNode *b) const {
+        if (a->getParent() != b->getParent() ||
+            !idom[a->getID()] || !idom[b->getID()])
+            return false;
+
+        // use only IDs here, the merged nodes are already deleted
+        unsigned id = b->getID();
+        while (number[id] < number[a->getID()])
+            id = idom[id];
+
+        return id == a->getID();
+    }
+
+    bool canReplace(PSNode *nd, PSNode *by) const {
+        if (isPreserved(preserved, nd))
+            return false;
+
+        return nd->getType() == PSNodeType::CONSTANT || dominates(by, nd);
+    }
+
+    bool mergeValues() {
+        bool changed = false;
+        // the nodes that compute the value and that
+        // could not be merged with each other
+        std::map<Value, std::vector<PSNode *>> values;
+
+        computeDominators();
+
+        for (const auto& nodeptr : PS->getNodes()) {
+            if (!nodeptr)
+                continue;
+
+            PSNode *node = nodeptr.get();
+            Value val;
+            if (!getValue(node, val))
+                continue;
+
+            auto& reps = values[std::move(val)];
+            bool merged = false;
+            for (PSNode *& rep : reps) {
+                if (canReplace(node, rep)) {
+                    merge(node, rep);
+                } else if (canReplace(rep, node)) {
+                    merge(rep, node);
+                    rep = node;
+                } else {
+                    continue;
+                }
+
+                merged = true;
+                break;
+            }
+
+            if (merged)
+                changed = true;
+            else
+                reps.push_back(node);
+        }
+
+        return changed;
+    }
+
+    void merge(PSNode *node, PSNode *rep) {
+        node->replaceAllUsesWith(rep);
+        removeNode(PS, node);
+
+        mapping.add(node, rep);
+        ++merged_nodes_num;
+    }
+
+    PointerSubgraph *PS;
+    const PreservedNodesT *preserved;
+    bool flow_insensitive;
+
+    // dominators of the nodes indexed by node IDs
+    std::vector<bool> visited;
+    std::vector<unsigned> number; // postorder number + 1
+    std::vector<unsigned> idom;   // ID of the immediate dominator
+
+    MappingT mapping;
+    unsigned merged_nodes_num{0};
+};
+
 class PointerSubgraphOptimizer {
     using MappingT = PointsToMapping<PSNode *>;
 
     PointerSubgraph *PS;
+    PreservedNodesT preserved;
+    bool flow_insensitive{false};
     MappingT mapping;
 
     unsigned removed = 0;
+
+    void addMapping(MappingT&& rhs) {
+        mapping.merge(std::move(rhs));
+
+        // a node that some removed node was mapped to
+        // may have been removed too, map it to the final node
+        for (auto& it : mapping) {
+            while (PSNode *nd = mapping.get(it.second))
+                it.second = nd;
+        }
+    }
+
 public:
-    PointerSubgraphOptimizer(PointerSubgraph *PS) : PS(PS) {}
+    PointerSubgraphOptimizer(PointerSubgraph *PS,
+                             PreservedNodesT preserved = {})
+    : PS(PS), preserved(std::move(preserved)) {}
+
+    // the results will be used by flow-insensitive analysis
+    void setFlowInsensitive(bool b) { flow_insensitive = b; }
 
     void removeNoops() {
-        PSNoopRemover remover(PS);
+        PSNoopRemover remover(PS, &preserved);
         removed += remover.run();
     }
 
     void removeUnknowns() {
-        PSUnknownsReducer reducer(PS);
+        PSUnknownsReducer reducer(PS, &preserved);
         if (auto r = reducer.run()) {
-            mapping.merge(std::move(reducer.getMapping()));
+            addMapping(std::move(reducer.getMapping()));
             removed += r;
         }
     }
 
     void removeEquivalentNodes() {
-        PSEquivalentNodesMerger merger(PS);
+        PSEquivalentNodesMerger merger(PS, &preserved);
         if (auto r = merger.run()) {
-                mapping.merge(std::move(merger.getMapping()));
+                addMapping(std::move(merger.getMapping()));
                 removed += r;
         }
     }
 
+    void removeEquivalentValues() {
+        PSEquivalentValuesMerger merger(PS, &preserved, flow_insensitive);
+        if (auto r = merger.run()) {
+            addMapping(std::move(merger.getMapping()));
+            removed += r;
+        }
+    }
+
     unsigned run() {
         removeNoops();
         removeEquivalentNodes();
@@ -235,6 +578,7 @@ public:
         // the same operands in a phi nodes,
         // which breaks the validity of the graph
         removeEquivalentNodes();
+        removeEquivalentValues();
 
         return removed;
     }
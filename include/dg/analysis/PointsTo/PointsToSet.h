@@ -2,10 +2,13 @@
 #define _DG_POINTS_TO_SET_H_
 
 #include "dg/analysis/PointsTo/Pointer.h"
+#include "dg/analysis/PointsTo/SharedPointsToSet.h"
+#include "dg/analysis/PointsTo/BitvectorPointsToSet.h"
 #include "dg/ADT/Bitvector.h"
 
 #include <map>
 #include <set>
+#include <memory>
 #include <cassert>
 
 namespace dg {
@@ -77,7 +80,12 @@ public:
             return false;
         }
 
-        return it->second.unset(*offset);
+        bool ret = it->second.unset(*offset);
+        // do not keep targets without offsets
+        if (it->second.empty())
+            pointers.erase(it);
+
+        return ret;
     }
 
     ///
@@ -170,6 +178,8 @@ public:
             }
         }
     public:
+        const_iterator() = default;
+
         const_iterator& operator++() {
             ++innerIt;
             if (innerIt == container_it->second.end()) {
@@ -210,6 +220,311 @@ public:
 };
 
 
+///
+// Points-to set that keeps up to INLINE_NUM pointers in a sorted array
+// stored directly in the object. Most of the points-to sets have just
+// a few elements, so this saves a lot of allocations and pointer chasing.
+// Once the set grows over INLINE_NUM pointers, it is lifted to PointsToSet
+// (the same way as SmallNumberSet is lifted to a bitvector)
+// and it stays lifted even if some pointers are removed later.
+template <size_t INLINE_NUM = 4>
+class SmallPointsToSetImpl {
+    // we keep plain data in the array so that
+    // we can move them around without any fuss
+    struct Entry {
+        PSNode *target;
+        Offset::type offset;
+    };
+
+    Entry _small[INLINE_NUM];
+    unsigned _size{0};
+    std::unique_ptr<PointsToSet> _big;
+
+    static bool _less(const Entry& e, PSNode *target, Offset::type off) {
+        return e.target == target ? e.offset < off : e.target < target;
+    }
+
+    // index of the first entry that is not less than (target, off)
+    unsigned _lowerBound(PSNode *target, Offset::type off) const {
+        unsigned l = 0, r = _size;
+        while (l < r) {
+            unsigned m = l + (r - l) / 2;
+            if (_less(_small[m], target, off))
+                l = m + 1;
+            else
+                r = m;
+        }
+
+        return l;
+    }
+
+    // index after the last entry with the given target
+    unsigned _targetEnd(PSNode *target, unsigned from) const {
+        while (from < _size && _small[from].target == target)
+            ++from;
+        return from;
+    }
+
+    void _insert(unsigned pos, PSNode *target, Offset::type off) {
+        assert(_size < INLINE_NUM);
+        for (unsigned i = _size; i > pos; --i)
+            _small[i] = _small[i - 1];
+
+        _small[pos] = {target, off};
+        ++_size;
+    }
+
+    void _erase(unsigned from, unsigned to) {
+        assert(from <= to && to <= _size);
+        for (unsigned i = to; i < _size; ++i)
+            _small[from + i - to] = _small[i];
+
+        _size -= to - from;
+    }
+
+    void _lift() {
+        assert(!_big);
+        _big.reset(new PointsToSet());
+        for (unsigned i = 0; i < _size; ++i)
+            _big->add(_small[i].target, _small[i].offset);
+        _size = 0;
+    }
+
+    void _copyFrom(const SmallPointsToSetImpl& rhs) {
+        _size = rhs._size;
+        for (unsigned i = 0; i < _size; ++i)
+            _small[i] = rhs._small[i];
+
+        if (rhs._big)
+            _big.reset(new PointsToSet(*rhs._big));
+        else
+            _big.reset();
+    }
+
+public:
+    SmallPointsToSetImpl() = default;
+    SmallPointsToSetImpl(SmallPointsToSetImpl&&) = default;
+    SmallPointsToSetImpl& operator=(SmallPointsToSetImpl&&) = default;
+
+    SmallPointsToSetImpl(const SmallPointsToSetImpl& rhs) { _copyFrom(rhs); }
+    SmallPointsToSetImpl& operator=(const SmallPointsToSetImpl& rhs) {
+        if (&rhs != this)
+            _copyFrom(rhs);
+        return *this;
+    }
+
+    bool isSmall() const { return !_big; }
+
+    bool add(PSNode *target, Offset off) {
+        if (_big)
+            return _big->add(target, off);
+
+        unsigned first = _lowerBound(target, 0);
+        unsigned last = _targetEnd(target, first);
+
+        // we already have this target with unknown offset
+        // (unknown offset is the greatest one, so it is the last)
+        if (last > first && _small[last - 1].offset == Offset::UNKNOWN)
+            return false;
+
+        if (off.isUnknown()) {
+            // get rid of other offsets and keep
+            // only the unknown offset
+            if (last > first) {
+                _erase(first, last);
+                _insert(first, target, Offset::UNKNOWN);
+                return true;
+            }
+        } else {
+            unsigned pos = _lowerBound(target, *off);
+            if (pos < last && _small[pos].offset == *off)
+                return false;
+        }
+
+        if (_size == INLINE_NUM) {
+            _lift();
+            return _big->add(target, off);
+        }
+
+        _insert(_lowerBound(target, *off), target, *off);
+        return true;
+    }
+
+    bool add(const Pointer& ptr) {
+        return add(ptr.target, ptr.offset);
+    }
+
+    bool remove(const Pointer& ptr) {
+        return remove(ptr.target, ptr.offset);
+    }
+
+    ///
+    // Remove pointer to this target with this offset.
+    // This is method really removes the pair
+    // (target, off) even when the off is unknown
+    bool remove(PSNode *target, Offset offset) {
+        if (_big)
+            return _big->remove(target, offset);
+
+        unsigned pos = _lowerBound(target, *offset);
+        if (pos == _size || _small[pos].target != target ||
+            _small[pos].offset != *offset)
+            return false;
+
+        _erase(pos, pos + 1);
+        return true;
+    }
+
+    ///
+    // Remove pointers pointing to this target
+    bool removeAny(PSNode *target) {
+        if (_big)
+            return _big->removeAny(target);
+
+        unsigned first = _lowerBound(target, 0);
+        unsigned last = _targetEnd(target, first);
+        if (first == last)
+            return false;
+
+        _erase(first, last);
+        return true;
+    }
+
+    // make union of the two sets and store it
+    // into 'this' set (i.e. merge rhs to this set)
+    bool merge(const SmallPointsToSetImpl& rhs) {
+        if (&rhs == this)
+            return false;
+
+        if (rhs._big) {
+            if (!_big)
+                _lift();
+            return _big->merge(*rhs._big);
+        }
+
+        bool changed = false;
+        for (unsigned i = 0; i < rhs._size; ++i)
+            changed |= add(rhs._small[i].target, rhs._small[i].offset);
+
+        return changed;
+    }
+
+    bool pointsTo(const Pointer& ptr) const {
+        if (_big)
+            return _big->pointsTo(ptr);
+
+        unsigned pos = _lowerBound(ptr.target, *ptr.offset);
+        return pos < _size && _small[pos].target == ptr.target &&
+                _small[pos].offset == *ptr.offset;
+    }
+
+    // points to the pointer or the the same target
+    // with unknown offset? Note: we do not count
+    // unknown memory here...
+    bool mayPointTo(const Pointer& ptr) const {
+        return pointsTo(ptr) ||
+                pointsTo(Pointer(ptr.target, Offset::UNKNOWN));
+    }
+
+    bool mustPointTo(const Pointer& ptr) const {
+        assert(!ptr.offset.isUnknown() && "Makes no sense");
+        return pointsTo(ptr) && isSingleton();
+    }
+
+    bool pointsToTarget(PSNode *target) const {
+        if (_big)
+            return _big->pointsToTarget(target);
+
+        unsigned pos = _lowerBound(target, 0);
+        return pos < _size && _small[pos].target == target;
+    }
+
+    // the same semantics as PointsToSet::isSingleton(),
+    // i.e. we have pointers to a single target
+    bool isSingleton() const {
+        if (_big)
+            return _big->isSingleton();
+
+        return _size > 0 && _small[0].target == _small[_size - 1].target;
+    }
+
+    bool empty() const { return _big ? _big->empty() : _size == 0; }
+
+    size_t count(const Pointer& ptr) const {
+        return pointsTo(ptr);
+    }
+
+    bool has(const Pointer& ptr) const {
+        return count(ptr) > 0;
+    }
+
+    size_t size() const { return _big ? _big->size() : _size; }
+
+    void swap(SmallPointsToSetImpl& rhs) {
+        SmallPointsToSetImpl tmp(std::move(rhs));
+        rhs = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    class const_iterator {
+        const SmallPointsToSetImpl *set{nullptr};
+        unsigned pos{0};
+        typename PointsToSet::const_iterator bigIt;
+
+        const_iterator(const SmallPointsToSetImpl *s, bool end = false)
+        : set(s), pos(end ? s->_size : 0) {
+            if (s->_big)
+                bigIt = end ? s->_big->end() : s->_big->begin();
+        }
+
+    public:
+        const_iterator() = default;
+
+        const_iterator& operator++() {
+            if (set->_big)
+                ++bigIt;
+            else
+                ++pos;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        Pointer operator*() const {
+            if (set->_big)
+                return *bigIt;
+
+            assert(pos < set->_size);
+            return Pointer(set->_small[pos].target, set->_small[pos].offset);
+        }
+
+        bool operator==(const const_iterator& rhs) const {
+            if (set->_big)
+                return bigIt == rhs.bigIt;
+            return pos == rhs.pos;
+        }
+
+        bool operator!=(const const_iterator& rhs) const {
+            return !operator==(rhs);
+        }
+
+        friend class SmallPointsToSetImpl;
+    };
+
+    const_iterator begin() const { return const_iterator(this); }
+    const_iterator end() const { return const_iterator(this, true /* end */); }
+
+    friend class const_iterator;
+};
+
+using SmallPointsToSet = SmallPointsToSetImpl<4>;
+using SharedPointsToSet = SharedPointsToSetImpl<PointsToSet>;
+
+
 ///
 // We keep the implementation of this points-to set because
 // it is good for comparison and regression testing
@@ -333,7 +648,15 @@ public:
 
 
 
+#if defined(POINTS_TO_SET_SMALL)
+using PointsToSetT = SmallPointsToSet;
+#elif defined(POINTS_TO_SET_SHARED)
+using PointsToSetT = SharedPointsToSet;
+#elif defined(POINTS_TO_SET_BITVECTOR)
+using PointsToSetT = BitvectorPointsToSet;
+#else
 using PointsToSetT = PointsToSet;
+#endif
 using PointsToMapT = std::map<Offset, PointsToSetT>;
 
 } // namespace pta
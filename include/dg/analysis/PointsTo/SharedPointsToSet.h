@@ -0,0 +1,440 @@
+#ifndef _DG_SHARED_POINTS_TO_SET_H_
+#define _DG_SHARED_POINTS_TO_SET_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "dg/analysis/PointsTo/Pointer.h"
+
+namespace dg {
+namespace analysis {
+namespace pta {
+
+///
+// Table of unique (hash-consed) points-to sets. Every distinct set
+// is stored only once and it is identified by a 32-bit ID.
+// The sets are reference-counted, a set that is not referenced
+// anymore is freed and its ID is reused. The ID 0 is reserved
+// for the empty set, which is never freed.
+// The results of merging and adding pointers are cached. The cache
+// does not hold references to the sets, the entries remember
+// the generations of the IDs and an entry is used only if none
+// of its sets has been freed since the entry was created.
+template <typename SetT>
+class PointsToSetsTable {
+public:
+    using IDT = uint32_t;
+
+private:
+    struct Entry {
+        SetT set;
+        size_t hash{0};
+        size_t refs{0};
+        // incremented whenever the set is freed,
+        // so that the ID can be reused
+        uint32_t generation{0};
+    };
+
+    // weak reference to a set (not counted in refs)
+    struct WeakID {
+        IDT id;
+        uint32_t generation;
+    };
+
+    // cached result of an operation with the set 'a' (and 'b')
+    struct CacheEntry {
+        WeakID a;
+        WeakID b;
+        WeakID result;
+    };
+
+    struct AddKey {
+        IDT id;
+        PSNode *target;
+        Offset::type offset;
+
+        bool operator==(const AddKey& rhs) const {
+            return id == rhs.id && target == rhs.target && offset == rhs.offset;
+        }
+    };
+
+    struct AddKeyHash {
+        size_t operator()(const AddKey& k) const {
+            return _combine(_combine(k.id, std::hash<PSNode *>()(k.target)),
+                            std::hash<Offset::type>()(k.offset));
+        }
+    };
+
+    // std::deque does not move the elements when growing,
+    // so the references to the sets stay valid
+    std::deque<Entry> _entries;
+    std::vector<IDT> _freeIds;
+    // hash of a set -> IDs of sets with this hash
+    std::unordered_multimap<size_t, IDT> _index;
+
+    // cached results of merge and add operations,
+    // the key of merge is (smaller ID, bigger ID)
+    std::unordered_map<uint64_t, CacheEntry> _mergeCache;
+    std::unordered_map<AddKey, CacheEntry, AddKeyHash> _addCache;
+    size_t _cacheLimit{1 << 20};
+
+    static size_t _combine(size_t h, size_t v) {
+        return h ^ (v + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+
+    static size_t _hash(const SetT& S) {
+        size_t h = 0;
+        for (const auto& ptr : S) {
+            h = _combine(h, std::hash<PSNode *>()(ptr.target));
+            h = _combine(h, std::hash<Offset::type>()(*ptr.offset));
+        }
+        return h;
+    }
+
+    // the sets keep the pointers sorted,
+    // so we can compare them element by element
+    static bool _equal(const SetT& A, const SetT& B) {
+        if (A.size() != B.size())
+            return false;
+
+        auto it = B.begin();
+        for (const auto& ptr : A) {
+            if (!(ptr == *it))
+                return false;
+            ++it;
+        }
+
+        return true;
+    }
+
+    void _clearCaches() {
+        _mergeCache.clear();
+        _addCache.clear();
+    }
+
+    WeakID _weak(IDT id) const { return {id, _entries[id].generation}; }
+
+    bool _valid(const WeakID& w) const {
+        return _entries[w.id].generation == w.generation;
+    }
+
+    bool _valid(const CacheEntry& E) const {
+        return _valid(E.a) && _valid(E.b) && _valid(E.result);
+    }
+
+    // the entries with freed sets stay in the cache until it is full,
+    // but they are small (the sets themselves are freed)
+    template <typename CacheT, typename KeyT>
+    void _cache(CacheT& cache, const KeyT& key, const CacheEntry& E) {
+        if (_mergeCache.size() + _addCache.size() >= _cacheLimit)
+            _clearCaches();
+        cache[key] = E;
+    }
+
+    void _free(IDT id) {
+        Entry& E = _entries[id];
+        auto range = _index.equal_range(E.hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == id) {
+                _index.erase(it);
+                break;
+            }
+        }
+
+        SetT().swap(E.set);
+        ++E.generation;
+        _freeIds.push_back(id);
+    }
+
+public:
+    PointsToSetsTable() {
+        // the empty set
+        _entries.emplace_back();
+    }
+
+    // get an ID of the set, the returned ID is referenced
+    IDT intern(SetT&& S) {
+        if (S.empty())
+            return 0;
+
+        size_t h = _hash(S);
+        auto range = _index.equal_range(h);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (_equal(_entries[it->second].set, S)) {
+                retain(it->second);
+                return it->second;
+            }
+        }
+
+        IDT id;
+        if (_freeIds.empty()) {
+            assert(_entries.size() < std::numeric_limits<IDT>::max()
+                   && "Run out of IDs of points-to sets");
+            id = static_cast<IDT>(_entries.size());
+            _entries.emplace_back();
+        } else {
+            id = _freeIds.back();
+            _freeIds.pop_back();
+        }
+
+        Entry& E = _entries[id];
+        E.set.swap(S);
+        E.hash = h;
+        E.refs = 1;
+        _index.emplace(h, id);
+
+        return id;
+    }
+
+    void retain(IDT id) {
+        if (id != 0)
+            ++_entries[id].refs;
+    }
+
+    void release(IDT id) {
+        if (id == 0)
+            return;
+
+        assert(_entries[id].refs > 0);
+        if (--_entries[id].refs == 0)
+            _free(id);
+    }
+
+    const SetT& get(IDT id) const {
+        assert(id < _entries.size());
+        return _entries[id].set;
+    }
+
+    // get the (referenced) ID of the union of the two sets
+    IDT merge(IDT a, IDT b) {
+        if (a == b || b == 0) {
+            retain(a);
+            return a;
+        }
+
+        if (a == 0) {
+            retain(b);
+            return b;
+        }
+
+        uint64_t key = a < b ? (static_cast<uint64_t>(a) << 32) | b
+                             : (static_cast<uint64_t>(b) << 32) | a;
+        auto it = _mergeCache.find(key);
+        if (it != _mergeCache.end() && _valid(it->second)) {
+            retain(it->second.result.id);
+            return it->second.result.id;
+        }
+
+        SetT S(get(a));
+        S.merge(get(b));
+        IDT c = intern(std::move(S));
+
+        // the reference from intern() is returned to the caller
+        _cache(_mergeCache, key, {_weak(a), _weak(b), _weak(c)});
+
+        return c;
+    }
+
+    // get the (referenced) ID of the set 'a' with the added pointer
+    IDT add(IDT a, PSNode *target, Offset off) {
+        AddKey key{a, target, *off};
+        auto it = _addCache.find(key);
+        if (it != _addCache.end() && _valid(it->second)) {
+            retain(it->second.result.id);
+            return it->second.result.id;
+        }
+
+        SetT S(get(a));
+        S.add(target, off);
+        IDT c = intern(std::move(S));
+
+        _cache(_addCache, key, {_weak(a), _weak(0), _weak(c)});
+
+        return c;
+    }
+
+    // the number of distinct sets that are alive
+    // (including the empty set)
+    size_t size() const { return _entries.size() - _freeIds.size(); }
+    size_t cacheSize() const { return _mergeCache.size() + _addCache.size(); }
+
+    void setCacheLimit(size_t limit) { _cacheLimit = limit; }
+    void clearCaches() { _clearCaches(); }
+};
+
+///
+// Immutable points-to set shared among all its holders.
+// The object is only a (reference-counted) handle to a set
+// in the global table of points-to sets, so equal sets are
+// stored only once and comparing sets is comparing integers.
+// Modifying the set means getting a handle to another set.
+template <typename SetT>
+class SharedPointsToSetImpl {
+public:
+    using TableT = PointsToSetsTable<SetT>;
+    using IDT = typename TableT::IDT;
+
+private:
+    IDT _id{0};
+
+    static TableT& _table() {
+        // local static so that the table is initialized before
+        // any global object (e.g. NULLPTR node) that has a points-to set.
+        // The table is never destroyed, because the global objects
+        // may release their sets after the static objects are destroyed
+        static TableT *table = new TableT();
+        return *table;
+    }
+
+    const SetT& _set() const { return _table().get(_id); }
+
+    // take over the (already referenced) ID
+    // and return whether the set changed
+    bool _replace(IDT id) {
+        if (id == _id) {
+            // we have one more reference than we need
+            _table().release(id);
+            return false;
+        }
+
+        _table().release(_id);
+        _id = id;
+        return true;
+    }
+
+public:
+    SharedPointsToSetImpl() = default;
+    SharedPointsToSetImpl(const SharedPointsToSetImpl& rhs) : _id(rhs._id) {
+        if (_id != 0)
+            _table().retain(_id);
+    }
+    SharedPointsToSetImpl(SharedPointsToSetImpl&& rhs) : _id(rhs._id) {
+        rhs._id = 0;
+    }
+    ~SharedPointsToSetImpl() {
+        if (_id != 0)
+            _table().release(_id);
+    }
+
+    SharedPointsToSetImpl& operator=(const SharedPointsToSetImpl& rhs) {
+        _table().retain(rhs._id);
+        _table().release(_id);
+        _id = rhs._id;
+        return *this;
+    }
+
+    SharedPointsToSetImpl& operator=(SharedPointsToSetImpl&& rhs) {
+        if (&rhs != this) {
+            _table().release(_id);
+            _id = rhs._id;
+            rhs._id = 0;
+        }
+        return *this;
+    }
+
+    static TableT& getTable() { return _table(); }
+    IDT getID() const { return _id; }
+
+    bool operator==(const SharedPointsToSetImpl& rhs) const { return _id == rhs._id; }
+    bool operator!=(const SharedPointsToSetImpl& rhs) const { return _id != rhs._id; }
+
+    bool add(PSNode *target, Offset off) {
+        // check whether the pointer is already there
+        // before we search the table
+        if (pointsTo(Pointer(target, Offset::UNKNOWN)) ||
+            pointsTo(Pointer(target, off)))
+            return false;
+
+        return _replace(_table().add(_id, target, off));
+    }
+
+    bool add(const Pointer& ptr) {
+        return add(ptr.target, ptr.offset);
+    }
+
+    bool remove(const Pointer& ptr) {
+        return remove(ptr.target, ptr.offset);
+    }
+
+    bool remove(PSNode *target, Offset offset) {
+        if (!pointsTo(Pointer(target, offset)))
+            return false;
+
+        SetT S(_set());
+        S.remove(target, offset);
+        return _replace(_table().intern(std::move(S)));
+    }
+
+    bool removeAny(PSNode *target) {
+        if (!pointsToTarget(target))
+            return false;
+
+        SetT S(_set());
+        S.removeAny(target);
+        return _replace(_table().intern(std::move(S)));
+    }
+
+    bool merge(const SharedPointsToSetImpl& rhs) {
+        return _replace(_table().merge(_id, rhs._id));
+    }
+
+    bool pointsTo(const Pointer& ptr) const { return _set().pointsTo(ptr); }
+    bool mayPointTo(const Pointer& ptr) const { return _set().mayPointTo(ptr); }
+    bool mustPointTo(const Pointer& ptr) const { return _set().mustPointTo(ptr); }
+    bool pointsToTarget(PSNode *target) const { return _set().pointsToTarget(target); }
+    bool isSingleton() const { return _set().isSingleton(); }
+    bool empty() const { return _id == 0; }
+    size_t count(const Pointer& ptr) const { return _set().count(ptr); }
+    bool has(const Pointer& ptr) const { return _set().has(ptr); }
+    size_t size() const { return _set().size(); }
+
+    void swap(SharedPointsToSetImpl& rhs) { std::swap(_id, rhs._id); }
+
+    class const_iterator {
+        // keep the reference to the set, so that
+        // it is not freed while we iterate over it
+        SharedPointsToSetImpl ref;
+        typename SetT::const_iterator it;
+
+        const_iterator(const SharedPointsToSetImpl& S, bool end = false)
+        : ref(S), it(end ? S._set().end() : S._set().begin()) {}
+
+    public:
+        const_iterator() = default;
+
+        const_iterator& operator++() {
+            ++it;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        Pointer operator*() const { return *it; }
+
+        bool operator==(const const_iterator& rhs) const { return it == rhs.it; }
+        bool operator!=(const const_iterator& rhs) const { return !operator==(rhs); }
+
+        friend class SharedPointsToSetImpl;
+    };
+
+    const_iterator begin() const { return const_iterator(*this); }
+    const_iterator end() const { return const_iterator(*this, true /* end */); }
+
+    friend class const_iterator;
+};
+
+} // namespace pta
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_SHARED_POINTS_TO_SET_H_
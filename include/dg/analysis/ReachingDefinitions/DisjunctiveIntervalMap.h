@@ -3,17 +3,41 @@
 
 #include "dg/analysis/Offset.h"
 #include <cassert>
+#include <iterator>
 #include <map>
 #include <set>
+#include <vector>
 
 namespace dg {
 namespace analysis {
 namespace rd {
 
+// Add values from the set 'from' to the set 'to'.
+// Return true if some value was added. Sets that can
+// be merged more efficiently can overload this function.
+template <typename SetT>
+bool mergeValues(SetT& to, const SetT& from) {
+    bool changed = false;
+    for (const auto& val : from)
+        changed |= to.insert(val).second;
+    return changed;
+}
+
+// Is every value from the set 'sub' in the set 'sup'?
+template <typename SetT>
+bool includesValues(const SetT& sup, const SetT& sub) {
+    for (const auto& val : sub) {
+        if (sup.count(val) == 0)
+            return false;
+    }
+    return true;
+}
+
 ///
 // Mapping of disjunctive discrete intervals of values
 // to sets of ValueT.
-template <typename ValueT, typename IntervalValueT = Offset>
+template <typename ValueT, typename IntervalValueT = Offset,
+          typename ValuesSetT = std::set<ValueT>>
 class DisjunctiveIntervalMap {
 public:
     template <typename T = int64_t>
@@ -64,7 +88,7 @@ public:
     };
 
     using IntervalT = Interval<IntervalValueT>;
-    using ValuesT = std::set<ValueT>;
+    using ValuesT = ValuesSetT;
     using MappingT = std::map<IntervalT, ValuesT>;
     using iterator = typename MappingT::iterator;
     using const_iterator = typename MappingT::const_iterator;
@@ -101,7 +125,14 @@ public:
             auto last = _get_last();
             return last->first.end >= I.start;
         } else {
-            return ge->first.start <= I.end;
+            if (ge->first.start <= I.end)
+                return true;
+            // the previous interval may span over the start of I
+            if (ge == _mapping.begin())
+                return false;
+            auto prev = ge;
+            --prev;
+            return prev->first.end >= I.start;
         }
     }
 
@@ -150,6 +181,68 @@ public:
         return overlapsFull(IntervalT(start, end));
     }
 
+    ///
+    // Merge the intervals from 'rhs' for which 'keep' returns true
+    // to this map in one pass over both mappings. The intervals are
+    // split (as in add()) only where some value is added, the rest
+    // of the mapping is left untouched. Return true if some value
+    // was added.
+    template <typename FilterT>
+    bool merge(const DisjunctiveIntervalMap& rhs, FilterT keep) {
+        bool changed = false;
+        auto it = _mapping.begin();
+        for (const auto& R : rhs._mapping) {
+            if (keep(R.first))
+                changed |= _mergeInterval(it, R.first, R.second);
+        }
+
+        _check();
+        return changed;
+    }
+
+    bool merge(const DisjunctiveIntervalMap& rhs) {
+        return merge(rhs, [](const IntervalT&) { return true; });
+    }
+
+    ///
+    // Merge the intervals from 'rhs' without the parts that are covered
+    // by the intervals 'without' (sorted by the start), e.g., the bytes
+    // that are overwritten. Return true if some value was added.
+    bool mergeWithout(const DisjunctiveIntervalMap& rhs,
+                      const std::vector<IntervalT>& without) {
+        bool changed = false;
+        auto it = _mapping.begin();
+        for (const auto& R : rhs._mapping) {
+            _forEachPart(R.first, without, [&](const IntervalT& P) {
+                changed |= _mergeInterval(it, P, R.second);
+                return true;
+            });
+        }
+
+        _check();
+        return changed;
+    }
+
+    ///
+    // Return true if merging 'rhs' would not add any value to this map
+    bool includes(const DisjunctiveIntervalMap& rhs) const {
+        return includesWithout(rhs, {});
+    }
+
+    // the same as includes(), but for mergeWithout()
+    bool includesWithout(const DisjunctiveIntervalMap& rhs,
+                         const std::vector<IntervalT>& without) const {
+        auto it = _mapping.begin();
+        for (const auto& R : rhs._mapping) {
+            if (!_forEachPart(R.first, without, [&](const IntervalT& P) {
+                    return _includesInterval(it, P, R.second);
+                }))
+                return false;
+        }
+
+        return true;
+    }
+
     bool empty() const { return _mapping.empty(); }
     size_t size() const { return _mapping.size(); }
 
@@ -178,7 +271,7 @@ public:
     }
 
 #ifndef NDEBUG
-    friend std::ostream& operator<<(std::ostream& os, const DisjunctiveIntervalMap<ValueT, IntervalValueT>& map) {
+    friend std::ostream& operator<<(std::ostream& os, const DisjunctiveIntervalMap& map) {
         os << "{";
         for (const auto& pair : map) {
             if (pair.second.empty())
@@ -311,6 +404,10 @@ private:
                 auto prev = ge;
                 --prev;
                 if (prev->first.end >= I.start) {
+                    // the previous interval may also span over
+                    // the whole I, then we must split it twice
+                    if (prev->first.end > I.end)
+                        prev = splitIntervalHint(prev, I.end, ge);
                     splitIntervalHint(prev, I.start - 1, ge);
                     changed = true;
                 }
@@ -322,6 +419,92 @@ private:
         return false;
     }
 
+    // Call f on the parts of I that are not covered by the intervals
+    // 'without' (sorted by the start) until f returns false.
+    // Return false if f returned false.
+    template <typename F>
+    static bool _forEachPart(const IntervalT& I,
+                             const std::vector<IntervalT>& without, F f) {
+        IntervalValueT start = I.start;
+        for (const auto& W : without) {
+            if (W.start > I.end)
+                break;
+            if (W.end < start)
+                continue;
+
+            if (start < W.start && !f(IntervalT(start, W.start - 1)))
+                return false;
+            if (W.end >= I.end)
+                return true;
+            start = W.end + 1;
+        }
+
+        return f(IntervalT(start, I.end));
+    }
+
+    // Do the intervals that overlap R cover R (without gaps)
+    // and contain the values 'vals'? The iterator 'it' is shifted
+    // as in _mergeInterval().
+    bool _includesInterval(const_iterator& it, const IntervalT& R,
+                           const ValuesT& vals) const {
+        while (it != _mapping.end() && it->first.end < R.start)
+            ++it;
+
+        IntervalValueT start = R.start;
+        for (auto cur = it;; ++cur) {
+            if (cur == _mapping.end() || cur->first.start > start ||
+                !includesValues(cur->second, vals))
+                return false;
+
+            if (cur->first.end >= R.end)
+                return true;
+            start = cur->first.end + 1;
+        }
+    }
+
+    // Add the values 'vals' to the interval R. The iterator 'it' points
+    // to the first interval that may overlap R (the intervals before it
+    // end before R) and it is shifted so that the same holds
+    // for the next interval from a merged map.
+    bool _mergeInterval(iterator& it, const IntervalT& R, const ValuesT& vals) {
+        while (it != _mapping.end() && it->first.end < R.start)
+            ++it;
+
+        bool changed = false;
+        IntervalValueT start = R.start;
+        while (true) {
+            if (it == _mapping.end() || it->first.start > R.end) {
+                _mapping.emplace_hint(it, IntervalT(start, R.end), vals);
+                return true;
+            }
+
+            if (start < it->first.start) {
+                // the gap before the interval
+                _mapping.emplace_hint(it, IntervalT(start, it->first.start - 1),
+                                      vals);
+                changed = true;
+                start = it->first.start;
+            }
+
+            if (!includesValues(it->second, vals)) {
+                // split the interval so that we add the values only to R
+                if (it->first.start < start)
+                    it = std::next(splitIntervalHint(it, start - 1,
+                                                     std::next(it)));
+                if (it->first.end > R.end)
+                    it = splitIntervalHint(it, R.end, std::next(it));
+
+                changed |= mergeValues(it->second, vals);
+            }
+
+            if (it->first.end >= R.end)
+                return changed;
+
+            start = it->first.end + 1;
+            ++it;
+        }
+    }
+
     template <typename IteratorT>
     bool _addValue(IteratorT I, ValueT val, bool update) {
         if (update) {
@@ -433,6 +616,9 @@ private:
 
     void _check() const {
 #ifndef NDEBUG
+        if (_mapping.empty())
+            return;
+
         // check that the keys are disjunctive
         auto it = _mapping.begin();
         auto last = it->first;
@@ -0,0 +1,512 @@
+#ifndef _DG_FLAT_DISJUNCTIVE_INTERVAL_MAP_H_
+#define _DG_FLAT_DISJUNCTIVE_INTERVAL_MAP_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "dg/analysis/ReachingDefinitions/DisjunctiveIntervalMap.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+///
+// Mapping of disjunctive discrete intervals of values to sets of ValueT
+// with the same semantics as DisjunctiveIntervalMap, but stored in flat
+// arrays. The starts and the ends of the intervals are kept in two sorted
+// arrays and the sets of values are sorted ranges in one pool of values.
+// Queries are binary searches followed by scans of contiguous memory
+// (that the compiler can vectorize for integral IntervalValueT)
+// and there is no allocation per interval.
+//
+// Adding an interval moves the intervals that lie after it, so the map
+// is meant for maps that are queried and merged more often than they
+// are updated. The ranges of values returned by the map are valid only
+// until the map is modified.
+template <typename ValueT, typename IntervalValueT = Offset>
+class FlatDisjunctiveIntervalMap {
+public:
+    using IntervalT =
+        typename DisjunctiveIntervalMap<ValueT, IntervalValueT>::IntervalT;
+
+    // the sorted values of one interval
+    class ValuesRef {
+        const ValueT *_begin;
+        const ValueT *_end;
+
+    public:
+        ValuesRef(const ValueT *b, const ValueT *e) : _begin(b), _end(e) {}
+
+        const ValueT *begin() const { return _begin; }
+        const ValueT *end() const { return _end; }
+        size_t size() const { return _end - _begin; }
+        bool empty() const { return _begin == _end; }
+
+        size_t count(const ValueT& val) const {
+            return std::binary_search(_begin, _end, val) ? 1 : 0;
+        }
+    };
+
+    class const_iterator {
+        const FlatDisjunctiveIntervalMap *_map;
+        size_t _idx;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<IntervalT, ValuesRef>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type *;
+        using reference = value_type;
+
+        const_iterator(const FlatDisjunctiveIntervalMap *m, size_t idx)
+        : _map(m), _idx(idx) {}
+
+        value_type operator*() const {
+            return value_type(_map->interval(_idx), _map->values(_idx));
+        }
+
+        const_iterator& operator++() { ++_idx; return *this; }
+        const_iterator operator++(int) { auto tmp = *this; ++_idx; return tmp; }
+        bool operator==(const const_iterator& rhs) const { return _idx == rhs._idx; }
+        bool operator!=(const const_iterator& rhs) const { return _idx != rhs._idx; }
+
+        size_t index() const { return _idx; }
+    };
+
+    ///
+    // Return true if the mapping is updated anyhow
+    // (intervals split, value added).
+    bool add(const IntervalValueT start, const IntervalValueT end,
+             const ValueT& val) {
+        return add(IntervalT(start, end), val);
+    }
+
+    bool add(const IntervalT& I, const ValueT& val) {
+        return _add(I, val, false);
+    }
+
+    bool update(const IntervalValueT start, const IntervalValueT end,
+                const ValueT& val) {
+        return update(IntervalT(start, end), val);
+    }
+
+    bool update(const IntervalT& I, const ValueT& val) {
+        return _add(I, val, true);
+    }
+
+    // return true if some intervals from the map
+    // has a overlap with I
+    bool overlaps(const IntervalT& I) const {
+        size_t lo = _first_overlapping(I);
+        return lo < size() && _starts[lo] <= I.end;
+    }
+
+    bool overlaps(IntervalValueT start, IntervalValueT end) const {
+        return overlaps(IntervalT(start, end));
+    }
+
+    // return true if the map has an entry for
+    // each single byte from the interval I
+    bool overlapsFull(const IntervalT& I) const {
+        size_t lo = _first_overlapping(I);
+        if (lo == size() || _starts[lo] > I.start)
+            return false;
+
+        size_t hi = _last_overlapping(I, lo);
+        if (_ends[hi - 1] < I.end)
+            return false;
+
+        // the intervals [lo, hi) must follow each other without gaps.
+        // Do not break the loop, so that it can be vectorized.
+        bool gap = false;
+        for (size_t i = lo + 1; i < hi; ++i)
+            gap |= _starts[i] != _ends[i - 1] + 1;
+
+        return !gap;
+    }
+
+    bool overlapsFull(IntervalValueT start, IntervalValueT end) const {
+        return overlapsFull(IntervalT(start, end));
+    }
+
+    ///
+    // Merge the intervals from 'rhs' for which 'keep' returns true
+    // to this map in one pass over both mappings (the intervals
+    // are split as in add()). Return true if some value was added.
+    template <typename FilterT>
+    bool merge(const FlatDisjunctiveIntervalMap& rhs, FilterT keep) {
+        size_t ri = 0;
+        const size_t rsize = rhs.size();
+        auto skipFiltered = [&]() {
+            while (ri < rsize && !keep(rhs.interval(ri)))
+                ++ri;
+        };
+
+        skipFiltered();
+        if (ri == rsize)
+            return false;
+
+        bool changed = false;
+        FlatDisjunctiveIntervalMap result;
+        result._reserve(size() + rsize, _pool.size() + rhs._pool.size());
+
+        // the starts of the parts of the current intervals
+        // that were not processed yet
+        size_t i = 0;
+        IntervalValueT start = i < size() ? _starts[i] : IntervalValueT(0);
+        IntervalValueT rstart = rhs._starts[ri];
+
+        auto nextOur = [&]() {
+            ++i;
+            if (i < size())
+                start = _starts[i];
+        };
+        auto nextRhs = [&]() {
+            ++ri;
+            skipFiltered();
+            if (ri < rsize)
+                rstart = rhs._starts[ri];
+        };
+
+        while (i < size() && ri < rsize) {
+            IntervalValueT end = _ends[i];
+            IntervalValueT rend = rhs._ends[ri];
+
+            if (end < rstart) {
+                result._emit(start, end, values(i));
+                nextOur();
+            } else if (rend < start) {
+                result._emit(rstart, rend, rhs.values(ri));
+                changed = true;
+                nextRhs();
+            } else if (start < rstart) {
+                result._emit(start, rstart - 1, values(i));
+                start = rstart;
+            } else if (rstart < start) {
+                result._emit(rstart, start - 1, rhs.values(ri));
+                changed = true;
+                rstart = start;
+            } else {
+                // the intervals start at the same value
+                IntervalValueT e = end < rend ? end : rend;
+                changed |= result._emitUnion(start, e, values(i),
+                                             rhs.values(ri));
+
+                if (e == end)
+                    nextOur();
+                else
+                    start = e + 1;
+
+                if (e == rend)
+                    nextRhs();
+                else
+                    rstart = e + 1;
+            }
+        }
+
+        while (i < size()) {
+            result._emit(start, _ends[i], values(i));
+            nextOur();
+        }
+
+        while (ri < rsize) {
+            result._emit(rstart, rhs._ends[ri], rhs.values(ri));
+            changed = true;
+            nextRhs();
+        }
+
+        swap(result);
+        _check();
+        return changed;
+    }
+
+    bool merge(const FlatDisjunctiveIntervalMap& rhs) {
+        return merge(rhs, [](const IntervalT&) { return true; });
+    }
+
+    bool empty() const { return _starts.empty(); }
+    size_t size() const { return _starts.size(); }
+
+    IntervalT interval(size_t idx) const {
+        assert(idx < size());
+        return IntervalT(_starts[idx], _ends[idx]);
+    }
+
+    ValuesRef values(size_t idx) const {
+        assert(idx < size());
+        const ValueT *b = _pool.data() + _vbegin[idx];
+        return ValuesRef(b, b + _vsize[idx]);
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    // return the iterator to an element that is the first
+    // that overlaps the interval I or end() if there is
+    // no such interval
+    const_iterator le(const IntervalT& I) const {
+        return overlaps(I) ? const_iterator(this, _first_overlapping(I)) : end();
+    }
+
+    const_iterator le(const IntervalValueT start, const IntervalValueT end) const {
+        return le(IntervalT(start, end));
+    }
+
+    void swap(FlatDisjunctiveIntervalMap& rhs) {
+        _starts.swap(rhs._starts);
+        _ends.swap(rhs._ends);
+        _vbegin.swap(rhs._vbegin);
+        _vsize.swap(rhs._vsize);
+        _pool.swap(rhs._pool);
+    }
+
+private:
+    // a part of the mapping, used when the mapping is rewritten
+    struct Segment {
+        IntervalValueT start;
+        IntervalValueT end;
+        uint32_t vbegin;
+        uint32_t vsize;
+    };
+
+    // the index of the first interval that ends at I.start
+    // or later (it overlaps I if it starts at I.end or before)
+    size_t _first_overlapping(const IntervalT& I) const {
+        return std::lower_bound(_ends.begin(), _ends.end(), I.start)
+                - _ends.begin();
+    }
+
+    // the index of the first interval from 'from'
+    // that starts after the end of I
+    size_t _last_overlapping(const IntervalT& I, size_t from) const {
+        return std::upper_bound(_starts.begin() + from, _starts.end(), I.end)
+                - _starts.begin();
+    }
+
+    void _reserve(size_t intervals, size_t values) {
+        _starts.reserve(intervals);
+        _ends.reserve(intervals);
+        _vbegin.reserve(intervals);
+        _vsize.reserve(intervals);
+        _pool.reserve(values);
+    }
+
+    uint32_t _poolSize() const { return static_cast<uint32_t>(_pool.size()); }
+
+    // append an interval with a copy of the values
+    // (used only when building a new map)
+    void _emit(IntervalValueT start, IntervalValueT end, ValuesRef vals) {
+        _starts.push_back(start);
+        _ends.push_back(end);
+        _vbegin.push_back(_poolSize());
+        _vsize.push_back(vals.size());
+        _pool.insert(_pool.end(), vals.begin(), vals.end());
+    }
+
+    // append an interval with the union of the values,
+    // return true if the union is bigger than 'ours'
+    bool _emitUnion(IntervalValueT start, IntervalValueT end,
+                    ValuesRef ours, ValuesRef theirs) {
+        uint32_t b = _poolSize();
+        std::set_union(ours.begin(), ours.end(), theirs.begin(), theirs.end(),
+                       std::back_inserter(_pool));
+        _starts.push_back(start);
+        _ends.push_back(end);
+        _vbegin.push_back(b);
+        _vsize.push_back(_poolSize() - b);
+        return _poolSize() - b > ours.size();
+    }
+
+    // Create the values of the interval 'idx' after adding (or, with 'update',
+    // setting) the value 'val'. The new values are stored to 'seg'.
+    // 'single' is the range in the pool with only 'val' (created lazily).
+    bool _addValue(size_t idx, const ValueT& val, bool update,
+                   Segment& seg, uint32_t& single) {
+        uint32_t b = _vbegin[idx];
+        uint32_t n = _vsize[idx];
+
+        if (update) {
+            if (n == 1 && _pool[b] == val) {
+                seg.vbegin = b;
+                seg.vsize = n;
+                return false;
+            }
+
+            seg.vbegin = _single(val, single);
+            seg.vsize = 1;
+            return true;
+        }
+
+        auto first = _pool.begin() + b;
+        uint32_t pos = std::lower_bound(first, first + n, val) - first;
+        if (pos < n && _pool[b + pos] == val) {
+            seg.vbegin = b;
+            seg.vsize = n;
+            return false;
+        }
+
+        // copy the values with 'val' inserted to the end of the pool
+        _pool.reserve(_pool.size() + n + 1);
+        seg.vbegin = _poolSize();
+        seg.vsize = n + 1;
+        for (uint32_t i = 0; i < pos; ++i)
+            _pool.push_back(_pool[b + i]);
+        _pool.push_back(val);
+        for (uint32_t i = pos; i < n; ++i)
+            _pool.push_back(_pool[b + i]);
+        return true;
+    }
+
+    uint32_t _single(const ValueT& val, uint32_t& single) {
+        if (single == NO_VALUES) {
+            single = _poolSize();
+            _pool.push_back(val);
+        }
+        return single;
+    }
+
+    // If the boolean 'update' is set to true, the value
+    // is not added, but rewritten
+    bool _add(const IntervalT& I, const ValueT& val, bool update) {
+        // the intervals [lo, hi) overlap I, we replace them by segments
+        // that are split at the borders of I and that have the new values
+        size_t lo = _first_overlapping(I);
+        size_t hi = _last_overlapping(I, lo);
+
+        auto& segs = _segs;
+        segs.clear();
+        uint32_t single = NO_VALUES;
+        bool changed = false;
+
+        if (lo == hi) {
+            segs.push_back(Segment{I.start, I.end, _single(val, single), 1});
+            _splice(lo, hi, segs);
+            _check();
+            return true;
+        }
+
+        // the part of the first interval before I
+        if (_starts[lo] < I.start) {
+            segs.push_back(Segment{_starts[lo], I.start - 1,
+                                   _vbegin[lo], _vsize[lo]});
+            changed = true;
+        }
+
+        for (size_t j = lo; j < hi; ++j) {
+            IntervalValueT s = _starts[j] < I.start ? I.start : _starts[j];
+            IntervalValueT e = _ends[j] > I.end ? I.end : _ends[j];
+
+            // the gap before this interval
+            IntervalValueT gap_start = j == lo ? I.start : _ends[j - 1] + 1;
+            if (gap_start < s) {
+                segs.push_back(Segment{gap_start, s - 1, _single(val, single), 1});
+                changed = true;
+            }
+
+            Segment seg{s, e, 0, 0};
+            changed |= _addValue(j, val, update, seg, single);
+            segs.push_back(seg);
+        }
+
+        // the gap after the last interval and the part
+        // of the last interval after I
+        if (_ends[hi - 1] < I.end) {
+            segs.push_back(Segment{_ends[hi - 1] + 1, I.end,
+                                   _single(val, single), 1});
+            changed = true;
+        } else if (_ends[hi - 1] > I.end) {
+            segs.push_back(Segment{I.end + 1, _ends[hi - 1],
+                                   _vbegin[hi - 1], _vsize[hi - 1]});
+            changed = true;
+        }
+
+        _splice(lo, hi, segs);
+        _collectGarbage();
+        _check();
+        return changed;
+    }
+
+    // replace the intervals [lo, hi) with the segments
+    void _splice(size_t lo, size_t hi, const std::vector<Segment>& segs) {
+        size_t old = hi - lo;
+        size_t num = segs.size();
+        if (num > old) {
+            size_t diff = num - old;
+            _starts.insert(_starts.begin() + hi, diff, IntervalValueT());
+            _ends.insert(_ends.begin() + hi, diff, IntervalValueT());
+            _vbegin.insert(_vbegin.begin() + hi, diff, 0);
+            _vsize.insert(_vsize.begin() + hi, diff, 0);
+        } else if (num < old) {
+            _starts.erase(_starts.begin() + lo + num, _starts.begin() + hi);
+            _ends.erase(_ends.begin() + lo + num, _ends.begin() + hi);
+            _vbegin.erase(_vbegin.begin() + lo + num, _vbegin.begin() + hi);
+            _vsize.erase(_vsize.begin() + lo + num, _vsize.begin() + hi);
+        }
+
+        for (size_t k = 0; k < num; ++k) {
+            _starts[lo + k] = segs[k].start;
+            _ends[lo + k] = segs[k].end;
+            _vbegin[lo + k] = segs[k].vbegin;
+            _vsize[lo + k] = segs[k].vsize;
+        }
+    }
+
+    // add() leaves the old values in the pool,
+    // copy the used values when the pool gets too big
+    void _collectGarbage() {
+        size_t used = 0;
+        for (uint32_t n : _vsize)
+            used += n;
+
+        if (_pool.size() <= 2 * used + 16)
+            return;
+
+        std::vector<ValueT> pool;
+        pool.reserve(used);
+        for (size_t i = 0; i < size(); ++i) {
+            uint32_t b = static_cast<uint32_t>(pool.size());
+            pool.insert(pool.end(), _pool.begin() + _vbegin[i],
+                        _pool.begin() + _vbegin[i] + _vsize[i]);
+            _vbegin[i] = b;
+        }
+        _pool.swap(pool);
+    }
+
+    void _check() const {
+#ifndef NDEBUG
+        assert(_starts.size() == _ends.size());
+        assert(_starts.size() == _vbegin.size());
+        assert(_starts.size() == _vsize.size());
+        for (size_t i = 0; i < size(); ++i) {
+            assert(_starts[i] <= _ends[i]);
+            assert(i == 0 || _ends[i - 1] < _starts[i]);
+            assert(_vsize[i] > 0);
+            assert(_vbegin[i] + _vsize[i] <= _pool.size());
+            assert(std::is_sorted(_pool.begin() + _vbegin[i],
+                                  _pool.begin() + _vbegin[i] + _vsize[i]));
+        }
+#endif // NDEBUG
+    }
+
+    static const uint32_t NO_VALUES = ~static_cast<uint32_t>(0);
+
+    std::vector<IntervalValueT> _starts;
+    std::vector<IntervalValueT> _ends;
+    // the values of the i-th interval are
+    // _pool[_vbegin[i]], ..., _pool[_vbegin[i] + _vsize[i] - 1]
+    std::vector<uint32_t> _vbegin;
+    std::vector<uint32_t> _vsize;
+    std::vector<ValueT> _pool;
+    // the buffer for _add(), kept to avoid an allocation in every call
+    std::vector<Segment> _segs;
+};
+
+} // namespace rd
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_FLAT_DISJUNCTIVE_INTERVAL_MAP_H_
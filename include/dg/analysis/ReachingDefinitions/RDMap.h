@@ -1,11 +1,17 @@
 #ifndef _DG_DEF_MAP_H_
 #define _DG_DEF_MAP_H_
 
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
 #include <set>
 #include <map>
+#include <vector>
 #include <cassert>
 
 #include "dg/analysis/Offset.h"
+#include "dg/analysis/ReachingDefinitions/DisjunctiveIntervalMap.h"
 
 namespace dg {
 namespace analysis {
@@ -159,8 +165,116 @@ public:
 
 };
 
+// the same as RDNodesSet, but the nodes are kept
+// in a sorted vector (used by IntervalRDMap)
+class RDNodesFlatSet {
+    using ContainerTy = std::vector<RDNode *>;
+
+    ContainerTy nodes;
+    bool is_unknown{false};
+
+public:
+    using const_iterator = ContainerTy::const_iterator;
+
+    RDNodesFlatSet() = default;
+    RDNodesFlatSet(std::initializer_list<RDNode *> il) {
+        for (RDNode *n : il)
+            insert(n);
+    }
+
+    void makeUnknown()
+    {
+        nodes.clear();
+        nodes.push_back(UNKNOWN_MEMORY);
+        is_unknown = true;
+    }
+
+    std::pair<const_iterator, bool> insert(RDNode *n)
+    {
+        if (is_unknown)
+            return {nodes.begin(), false};
+
+        if (n == UNKNOWN_MEMORY) {
+            makeUnknown();
+            return {nodes.begin(), true};
+        }
+
+        auto it = std::lower_bound(nodes.begin(), nodes.end(), n);
+        if (it != nodes.end() && *it == n)
+            return {it, false};
+
+        return {nodes.insert(it, n), true};
+    }
+
+    // add the nodes from the other set (in one pass over both sets),
+    // return true if some node was added
+    bool merge(const RDNodesFlatSet& oth)
+    {
+        if (is_unknown || oth.nodes.empty())
+            return false;
+
+        if (oth.is_unknown) {
+            makeUnknown();
+            return true;
+        }
+
+        if (includes(oth))
+            return false;
+
+        size_t oldSize = nodes.size();
+        ContainerTy result;
+        result.reserve(oldSize + oth.nodes.size());
+        std::set_union(nodes.begin(), nodes.end(),
+                       oth.nodes.begin(), oth.nodes.end(),
+                       std::back_inserter(result));
+        nodes.swap(result);
+        return nodes.size() != oldSize;
+    }
+
+    size_t count(RDNode *n) const
+    {
+        return std::binary_search(nodes.begin(), nodes.end(), n) ? 1 : 0;
+    }
+
+    // would merging the other set add nothing?
+    bool includes(const RDNodesFlatSet& oth) const
+    {
+        if (is_unknown)
+            return true;
+        if (oth.is_unknown)
+            return false;
+
+        return std::includes(nodes.begin(), nodes.end(),
+                             oth.nodes.begin(), oth.nodes.end());
+    }
+
+    size_t size() const { return nodes.size(); }
+    bool empty() const { return nodes.empty(); }
+
+    void clear()
+    {
+        nodes.clear();
+        is_unknown = false;
+    }
+
+    bool isUnknown() const { return is_unknown; }
+
+    const_iterator begin() const { return nodes.begin(); }
+    const_iterator end() const { return nodes.end(); }
+};
+
+inline bool mergeValues(RDNodesFlatSet& to, const RDNodesFlatSet& from) {
+    return to.merge(from);
+}
+
+inline bool includesValues(const RDNodesFlatSet& sup, const RDNodesFlatSet& sub) {
+    return sup.includes(sub);
+}
+
 using DefSiteSetT = std::set<DefSite>;
 
+class IntervalRDMap;
+
 class BasicRDMap
 {
 public:
@@ -171,6 +285,13 @@ public:
         merge(&o);
     }
 
+    // copy the definitions from the interval map
+    explicit BasicRDMap(const IntervalRDMap& o);
+
+    BasicRDMap(BasicRDMap&&) = default;
+    BasicRDMap& operator=(const BasicRDMap&) = default;
+    BasicRDMap& operator=(BasicRDMap&&) = default;
+
     bool merge(const BasicRDMap *o,
                DefSiteSetT *without = nullptr,
                bool strong_update_unknown = true,
@@ -180,6 +301,8 @@ public:
     bool add(const DefSite&, RDNode *n);
     bool update(const DefSite&, RDNode *n);
     bool empty() const { return _defs.empty(); }
+    // the number of def-sites in the map
+    size_t size() const { return _defs.size(); }
 
     // gather reaching definitions of memory [n + off, n + off + len]
     // and store them to the @ret
@@ -228,6 +351,102 @@ private:
     MapT _defs;
 };
 
+///
+// Reaching definitions stored per target in DisjunctiveIntervalMap,
+// so the defined bytes of a target are disjunctive intervals. The
+// definitions of a target are shared between the maps until one
+// of the maps modifies them (copy-on-write), so merging maps of
+// neighbouring nodes copies only the targets that change.
+class IntervalRDMap
+{
+public:
+    using NodesT = RDNodesFlatSet;
+    using IntervalsT = DisjunctiveIntervalMap<RDNode *, Offset::type, NodesT>;
+
+    // definitions of one target
+    struct TargetDefs {
+        // definitions with concrete offset
+        IntervalsT intervals;
+        // definitions with unknown offset
+        NodesT unknown;
+
+        bool empty() const { return intervals.empty() && unknown.empty(); }
+        size_t size() const { return intervals.size() + (unknown.empty() ? 0 : 1); }
+    };
+
+private:
+    // sorted by the target
+    using TargetsT = std::vector<std::pair<RDNode *, std::shared_ptr<TargetDefs>>>;
+
+public:
+    IntervalRDMap() = default;
+    // copy the definitions from the basic map
+    explicit IntervalRDMap(const BasicRDMap& o);
+
+    bool merge(const IntervalRDMap *o,
+               DefSiteSetT *without = nullptr,
+               bool strong_update_unknown = true,
+               Offset::type max_set_size  = Offset::UNKNOWN,
+               bool merge_unknown     = false);
+
+    bool add(const DefSite&, RDNode *n);
+    bool update(const DefSite&, RDNode *n);
+    bool empty() const { return _targets.empty(); }
+    // the number of def-sites (intervals and definitions
+    // with unknown offset) in the map
+    size_t size() const;
+
+    size_t get(RDNode *n, const Offset& off,
+               const Offset& len, std::set<RDNode *>& ret) const;
+    size_t get(const DefSite& ds, std::set<RDNode *>& ret) const;
+
+    // iterate over pairs (def-site, definitions)
+    class const_iterator {
+        TargetsT::const_iterator _it;
+        TargetsT::const_iterator _end;
+        // are we at the definitions with unknown offset?
+        bool _atUnknown{true};
+        IntervalsT::const_iterator _interval;
+
+        void _skipEmpty();
+
+        const_iterator(TargetsT::const_iterator b, TargetsT::const_iterator e)
+        : _it(b), _end(e) { _skipEmpty(); }
+
+        friend class IntervalRDMap;
+
+    public:
+        const_iterator() = default;
+
+        std::pair<DefSite, const NodesT&> operator*() const;
+        const_iterator& operator++();
+        const_iterator operator++(int) { auto tmp = *this; operator++(); return tmp; }
+
+        bool operator==(const const_iterator& oth) const {
+            if (_it != oth._it)
+                return false;
+            if (_it == _end)
+                return true;
+            return _atUnknown == oth._atUnknown &&
+                   (_atUnknown || _interval == oth._interval);
+        }
+
+        bool operator!=(const const_iterator& oth) const { return !operator==(oth); }
+    };
+
+    const_iterator begin() const { return const_iterator(_targets.begin(), _targets.end()); }
+    const_iterator end() const { return const_iterator(_targets.end(), _targets.end()); }
+
+private:
+    TargetsT::const_iterator _find(RDNode *target) const;
+    // get the definitions of the target such that they can be modified
+    // (copy them if they are shared, create them if there are none)
+    TargetDefs& _getWritable(RDNode *target);
+
+    TargetsT _targets;
+};
+
+// the maps with the reaching definitions of RDNode
 using RDMap = BasicRDMap;
 
 } // rd
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <set>
+#include <memory>
 #include <cassert>
 #include <cstring>
 
@@ -27,9 +28,11 @@ namespace rd {
 
 namespace srg {
     class AssignmentFinder;
+    class SparseRDGraph;
 }
 
 class RDNode;
+struct RDBBlock;
 class ReachingDefinitionsAnalysis;
 
 // here the types are for type-checking (optional - user can do it
@@ -58,12 +61,26 @@ enum class RDNodeType {
 
 extern RDNode *UNKNOWN_MEMORY;
 
+///
+// Computes the reaching definitions of nodes on demand
+// (of the nodes that have it set as their resolver)
+class RDResolver {
+public:
+    virtual ~RDResolver() = default;
+
+    // compute the reaching definitions of the node
+    // and reset its resolver
+    virtual void resolve(RDNode *n) = 0;
+};
+
 class RDNode : public SubgraphNode<RDNode> {
     RDNodeType type;
 
     BBlock<RDNode> *bblock = nullptr;
     // marks for DFS/BFS
     unsigned int dfsid;
+    // the ID of the node in a sparse RD graph (see srg::SparseRDGraph)
+    unsigned int srg_id{0};
 public:
 
     RDNode(RDNodeType t = RDNodeType::NONE)
@@ -84,6 +101,12 @@ public:
 
     RDMap def_map;
 
+    // if set, the reaching definitions of this node were not computed
+    // yet and def_map contains only the definitions of this node.
+    // The resolver computes them on the first query
+    // (see getReachingDefinitions()).
+    RDResolver *resolver{nullptr};
+
     RDNodeType getType() const { return type; }
     DefSiteSetT& getDefines() { return defs; }
     DefSiteSetT& getOverwrites() { return overwrites; }
@@ -187,12 +210,21 @@ public:
         return overwrites.find(ds) != overwrites.end();
     }
 
-    const RDMap& getReachingDefinitions() const { return def_map; }
-    RDMap& getReachingDefinitions() { return def_map; }
+    // Get the reaching definitions of the node. If the node has a resolver,
+    // the definitions are computed here and stored into def_map
+    // (together with the definitions of the preceding nodes that
+    // were not computed yet), so this modifies the graph
+    // and it is not safe to call it concurrently.
+    RDMap& getReachingDefinitions() {
+        if (resolver)
+            resolver->resolve(this);
+        return def_map;
+    }
+
     size_t getReachingDefinitions(RDNode *n, const Offset& off,
                                   const Offset& len, std::set<RDNode *>& ret)
     {
-        return def_map.get(n, off, len, ret);
+        return getReachingDefinitions().get(n, off, len, ret);
     }
 
     bool isUnknown() const
@@ -240,16 +272,100 @@ public:
 
     friend class ReachingDefinitionsAnalysis;
     friend class dg::analysis::rd::srg::AssignmentFinder;
+    friend class dg::analysis::rd::srg::SparseRDGraph;
+};
+
+///
+// A sequence of nodes such that every node but the first has only
+// one predecessor and every node but the last has only one successor.
+// The block-level analysis keeps the reaching definitions only in the
+// last node of the block. The other nodes compute them on demand
+// (the analysis creates the blocks with a resolver for its maps).
+struct RDBBlock : public RDResolver {
+    std::vector<RDNode *> nodes;
+    // the strong updates of all the nodes in the block
+    DefSiteSetT kills;
+    const ReachingDefinitionsAnalysisOptions *options;
+
+    RDBBlock(const ReachingDefinitionsAnalysisOptions *opts) : options(opts) {}
+
+    RDNode *getFirstNode() const { return nodes.front(); }
+    RDNode *getLastNode() const { return nodes.back(); }
+};
+
+struct ReachingDefinitionsAnalysisStatistics {
+    // number of processed nodes (a node is counted
+    // every time it is processed)
+    size_t processedNodes{0};
+    // how many times processing a node changed its map
+    size_t changedNodes{0};
+    // number of merges of a predecessor's map into a node's map
+    size_t merges{0};
+    // number of iterations. In the worklist mode, a new iteration
+    // starts whenever the solver returns to a node that is earlier
+    // in the reverse postorder than the previously processed node
+    size_t iterations{0};
+    // the maximal number of def-sites in a map of a node
+    size_t maxMapSize{0};
+    // the maximal number of definitions of a def-site
+    size_t maxDefinitionsSize{0};
+
+    template <typename MapT>
+    void updateMaxSizes(const MapT& map) {
+        if (map.size() > maxMapSize)
+            maxMapSize = map.size();
+        for (const auto& it : map) {
+            if (it.second.size() > maxDefinitionsSize)
+                maxDefinitionsSize = it.second.size();
+        }
+    }
 };
 
 class ReachingDefinitionsAnalysis
 {
+    // The dense analysis is instantiated with the maps of the nodes
+    // that it works with (MapsT), see run(). MapsT gives the map of
+    // a node by operator[] and stores the maps to the nodes by store().
+
+    // merge the map of the predecessor 'pred' to the map of 'node'
+    template <typename MapsT>
+    bool mergeMaps(MapsT& maps, RDNode *node, RDNode *pred);
+    template <typename MapsT>
+    bool processNode(MapsT& maps, RDNode *node);
+
+    // run the dense analysis over the maps MapsT
+    template <typename MapsT>
+    void runDense();
+
+    // the dense analysis with a worklist ordered by the reverse postorder.
+    // Only the successors of the nodes whose map changed are re-processed
+    // and they merge only the maps of the predecessors that changed.
+    template <typename MapsT>
+    void runWorklist(MapsT& maps);
+    // re-process all nodes reachable from the nodes that changed
+    // until a fixpoint is reached
+    template <typename MapsT>
+    void runIterative(MapsT& maps);
+
+    // split the nodes (in the reverse postorder) to blocks
+    // and summarize the definitions of every block
+    template <typename MapsT>
+    void buildBlocks(MapsT& maps, const std::vector<RDNode *>& nodes);
+    // the worklist analysis over the blocks, the maps are kept
+    // only in the last nodes of the blocks
+    template <typename MapsT>
+    void runBlocks(MapsT& maps);
+
+    std::vector<std::unique_ptr<RDBBlock>> blocks;
+
 protected:
     RDNode *root{nullptr};
     unsigned int dfsnum;
 
     const ReachingDefinitionsAnalysisOptions options;
 
+    ReachingDefinitionsAnalysisStatistics statistics;
+
 public:
     ReachingDefinitionsAnalysis(RDNode *r,
                                 const ReachingDefinitionsAnalysisOptions& opts)
@@ -334,9 +450,16 @@ public:
     }
 
 
+    // get the nodes reachable from the root in the reverse postorder
+    std::vector<RDNode *> getNodesRPO();
+
     RDNode *getRoot() const { return root; }
     void setRoot(RDNode *r) { root = r; }
 
+    const ReachingDefinitionsAnalysisStatistics& getStatistics() const {
+        return statistics;
+    }
+
     bool processNode(RDNode *n);
     virtual void run();
 };
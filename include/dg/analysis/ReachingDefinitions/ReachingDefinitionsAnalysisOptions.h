@@ -26,6 +26,27 @@ struct ReachingDefinitionsAnalysisOptions : AnalysisOptions {
     // or just objects?
     bool fieldInsensitive{false};
 
+    // Process the nodes using a worklist ordered by the reverse
+    // postorder instead of re-processing all nodes reachable from
+    // the changed nodes in every iteration (dense analysis only)
+    bool worklist{false};
+
+    // Compute the reaching definitions in IntervalRDMap
+    // instead of BasicRDMap (dense analysis only).
+    // The results are copied to the maps of the nodes.
+    bool intervalMaps{false};
+
+    // Keep the reaching definitions only at the ends of blocks
+    // (sequences of nodes without branching) and compute them for
+    // the other nodes on demand (dense analysis only). The analysis
+    // object must exist as long as the reaching definitions are queried.
+    bool blocks{false};
+
+    // Resolve the reaching definitions of a node with uses only
+    // when they are queried for the first time (semi-sparse analysis
+    // only). The analysis object must exist as long as the reaching
+    // definitions are queried.
+    bool onDemand{false};
 
     ReachingDefinitionsAnalysisOptions& setStrongUpdateUnknown(bool b) {
         strongUpdateUnknown = b; return *this;
@@ -46,6 +67,22 @@ struct ReachingDefinitionsAnalysisOptions : AnalysisOptions {
     ReachingDefinitionsAnalysisOptions& setFieldInsensitive(bool b) {
         fieldInsensitive = b; return *this;
     }
+
+    ReachingDefinitionsAnalysisOptions& setWorklist(bool b) {
+        worklist = b; return *this;
+    }
+
+    ReachingDefinitionsAnalysisOptions& setIntervalMaps(bool b) {
+        intervalMaps = b; return *this;
+    }
+
+    ReachingDefinitionsAnalysisOptions& setBlocks(bool b) {
+        blocks = b; return *this;
+    }
+
+    ReachingDefinitionsAnalysisOptions& setOnDemand(bool b) {
+        onDemand = b; return *this;
+    }
 };
 
 } // namespace analysis
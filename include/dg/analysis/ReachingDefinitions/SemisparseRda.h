@@ -2,24 +2,29 @@
 #define _DG_SEMISPARSERDA_H_
 
 #include <vector>
-#include <queue>
-#include <unordered_set>
+#include <memory>
 
 #include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
+#include "dg/analysis/ReachingDefinitions/SparseRDGraph.h"
 
 namespace dg {
 namespace analysis {
 namespace rd {
 
-class SemisparseRda : public ReachingDefinitionsAnalysis
+class SemisparseRda : public ReachingDefinitionsAnalysis, public RDResolver
 {
+    // the edges of the sparse RD graph, pairs (variable, definition),
+    // lead from the definitions to the nodes (see srg::SparseRDGraph)
+    using SrgT = srg::SparseRDGraph;
+    using SrgEdgeT = SrgT::EdgeT;
+
     bool merge_maps(RDNode *source, RDNode *dest, DefSite& var) {
         bool changed = false;
 
         if (source->getType() != RDNodeType::PHI)
             changed |= dest->def_map.add(var, source);
 
-        for (auto& pair : source->def_map) {
+        for (const auto& pair : source->def_map) {
             const DefSite& ds = pair.first;
             auto& nodes = pair.second;
 
@@ -33,14 +38,50 @@ class SemisparseRda : public ReachingDefinitionsAnalysis
         return changed;
     }
 
+    SrgT srg;
     std::vector<std::unique_ptr<RDNode>> phi_nodes;
 
+    // the edges reachable backwards from the SRG nodes (sorted).
+    // The nodes of a strongly connected component share the edges.
+    // The edges of a component are released once they are not needed,
+    // i.e., when its nodes are resolved and the edges were copied
+    // to all the components that depend on it (see 'references').
+    std::vector<std::vector<SrgEdgeT>> reaching;
+    // the index of the component of a resolved SRG node in 'reaching',
+    // indexed by the IDs of the nodes in the SRG
+    static const unsigned NO_COMPONENT = ~0U;
+    std::vector<unsigned> component;
+    // the number of pending reads of the reaching edges of a node
+    // (its edges to other nodes and its own resolving), indexed by IDs.
+    // The components sum the references of their nodes.
+    std::vector<unsigned> node_references;
+    std::vector<unsigned> references;
+
+    // the state of Tarjan's algorithm in resolveComponents(),
+    // kept between the calls so that it is not initialized every time
+    std::vector<unsigned> tarjan_index;
+    std::vector<unsigned> tarjan_lowlink;
+    std::vector<bool> tarjan_on_stack;
+    unsigned tarjan_next_index{1};
+
+    // compute the reaching edges for the nodes
+    // reachable backwards from the node with the ID 'from'
+    void resolveComponents(unsigned from);
+    const std::vector<SrgEdgeT>& getReachingEdges(RDNode *n);
+    // drop one reference to the edges of the component,
+    // the last one releases the edges
+    void release(unsigned comp);
+
 public:
     SemisparseRda(RDNode *root, ReachingDefinitionsAnalysisOptions opts)
         : ReachingDefinitionsAnalysis(root, opts.setSparse(true)) {}
     SemisparseRda(RDNode *root) : SemisparseRda(root, {}) {}
 
     void run() override;
+
+    // compute the reaching definitions of a node with uses
+    // (with the onDemand option, on its first query)
+    void resolve(RDNode *n) override;
 };
 
 }
@@ -0,0 +1,286 @@
+#ifndef _DG_SPARSE_RD_GRAPH_H_
+#define _DG_SPARSE_RD_GRAPH_H_
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+
+#include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+namespace srg {
+
+///
+// Sparse graph for RD information propagation. Every node has
+// a list of edges (pairs (variable, node)), the meaning of the edges
+// (whether they lead to the definitions or to the uses) is up to
+// the builder of the graph. Optionally, the graph keeps also the reversed
+// edges (the builders need them only while building the graph).
+//
+// The nodes get dense IDs when they are added to the graph, so the graph
+// and the analyses working on it can keep their data in vectors instead
+// of hash maps. The ID is stored in the node, so a node can have an ID
+// only in one graph at a time. Removed edges are only marked (tombstoned) and they are
+// skipped when iterating, so the edges do not move. If the builder is going
+// to remove edges, the graph keeps a hash index of their positions to remove
+// an edge in constant time (the other builders do not pay for the index).
+// compact() moves the edges into one array (compressed sparse row format)
+// and drops the removed edges and the index.
+class SparseRDGraph {
+public:
+    using NodeT = RDNode;
+    using VarT = DefSite;
+    using EdgeT = std::pair<VarT, NodeT *>;
+
+    // iterate over the edges of a node, skipping the removed edges
+    class edge_iterator {
+        const EdgeT *it;
+        const EdgeT *end;
+
+        void skipRemoved() {
+            while (it != end && it->second == nullptr)
+                ++it;
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = EdgeT;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const EdgeT *;
+        using reference = const EdgeT&;
+
+        edge_iterator(const EdgeT *i, const EdgeT *e) : it(i), end(e) {
+            skipRemoved();
+        }
+
+        edge_iterator& operator++() { ++it; skipRemoved(); return *this; }
+        edge_iterator operator++(int) { auto tmp = *this; operator++(); return tmp; }
+        const EdgeT& operator*() const { return *it; }
+        const EdgeT *operator->() const { return it; }
+        bool operator==(const edge_iterator& rhs) const { return it == rhs.it; }
+        bool operator!=(const edge_iterator& rhs) const { return it != rhs.it; }
+    };
+
+    class edges_range {
+        const EdgeT *b;
+        const EdgeT *e;
+
+    public:
+        edges_range(const EdgeT *b_, const EdgeT *e_) : b(b_), e(e_) {}
+
+        edge_iterator begin() const { return edge_iterator(b, e); }
+        edge_iterator end() const { return edge_iterator(e, e); }
+        bool empty() const { return begin() == end(); }
+    };
+
+private:
+    static const unsigned NO_ID = ~0U;
+
+    // ID -> node
+    std::vector<NodeT *> _nodes;
+    // the edges of the nodes while the graph is built
+    std::vector<std::vector<EdgeT>> _edges;
+    // the reversed edges, if they are kept
+    std::vector<std::vector<EdgeT>> _reverse;
+    bool _keep_reverse{false};
+    // can the edges be removed (do we keep the index of the edges)?
+    bool _removable{false};
+
+    // (node, var, other) -> positions of the edge (var, other)
+    // in the edges of node and of the reversed edge in the edges of other
+    struct _EdgeKey {
+        unsigned node;
+        unsigned other;
+        VarT var;
+
+        bool operator==(const _EdgeKey& rhs) const {
+            return node == rhs.node && other == rhs.other && var == rhs.var;
+        }
+    };
+
+    struct _EdgeKeyHash {
+        static size_t _combine(size_t h, size_t v) {
+            return h ^ (v + 0x9e3779b9 + (h << 6) + (h >> 2));
+        }
+
+        size_t operator()(const _EdgeKey& k) const {
+            size_t h = _combine(k.node, k.other);
+            h = _combine(h, std::hash<NodeT *>()(k.var.target));
+            h = _combine(h, std::hash<Offset::type>()(*k.var.offset));
+            return _combine(h, std::hash<Offset::type>()(*k.var.len));
+        }
+    };
+
+    std::unordered_multimap<_EdgeKey, std::pair<size_t, size_t>,
+                            _EdgeKeyHash> _positions;
+    // the edges of the nodes after compact(),
+    // the edges of the node with ID i are [_csr[_offsets[i]], _csr[_offsets[i + 1]])
+    std::vector<size_t> _offsets;
+    std::vector<EdgeT> _csr;
+    bool _compact{false};
+
+    // the ID of the node in this graph, or NO_ID. The ID is stored
+    // in the node, we check that it belongs to this graph.
+    unsigned _findId(const NodeT *n) const {
+        unsigned id = n->srg_id;
+        if (id < _nodes.size() && _nodes[id] == n)
+            return id;
+        return NO_ID;
+    }
+
+    unsigned _getId(NodeT *n) {
+        unsigned id = _findId(n);
+        if (id != NO_ID)
+            return id;
+
+        assert(!_compact && "Adding a node to a compacted graph");
+        id = static_cast<unsigned>(_nodes.size());
+        n->srg_id = id;
+        _nodes.push_back(n);
+        _edges.emplace_back();
+        if (_keep_reverse)
+            _reverse.emplace_back();
+        return id;
+    }
+
+    static edges_range _range(const std::vector<EdgeT>& edges) {
+        return edges_range(edges.data(), edges.data() + edges.size());
+    }
+
+public:
+    explicit SparseRDGraph(bool keep_reverse = false, bool removable = false)
+        : _keep_reverse(keep_reverse), _removable(removable) {}
+
+    // add the edge (var, other) to the edges of the node
+    // (and the edge (var, node) to the reversed edges of other).
+    // Both the nodes get an ID.
+    void addEdge(NodeT *node, const VarT& var, NodeT *other) {
+        assert(other && "Edge to nullptr");
+        assert(!_compact && "Adding an edge to a compacted graph");
+        unsigned id = _getId(node);
+        unsigned other_id = _getId(other);
+        size_t pos = _edges[id].size();
+        size_t reverse_pos = 0;
+        _edges[id].emplace_back(var, other);
+        if (_keep_reverse) {
+            reverse_pos = _reverse[other_id].size();
+            _reverse[other_id].emplace_back(var, node);
+        }
+
+        if (_removable)
+            _positions.emplace(_EdgeKey{id, other_id, var},
+                               std::make_pair(pos, reverse_pos));
+    }
+
+    // remove an edge (var, other) of the node.
+    // Returns false if there is no such edge.
+    bool removeEdge(NodeT *node, const VarT& var, NodeT *other) {
+        assert(!_compact && "Removing an edge from a compacted graph");
+        assert(_removable && "The graph does not allow removing edges");
+        unsigned id = _findId(node);
+        unsigned other_id = _findId(other);
+        if (id == NO_ID || other_id == NO_ID)
+            return false;
+
+        auto it = _positions.find(_EdgeKey{id, other_id, var});
+        if (it == _positions.end())
+            return false;
+
+        assert(_edges[id][it->second.first].second == other);
+        _edges[id][it->second.first].second = nullptr;
+        if (_keep_reverse) {
+            assert(_reverse[other_id][it->second.second].second == node);
+            _reverse[other_id][it->second.second].second = nullptr;
+        }
+
+        _positions.erase(it);
+        return true;
+    }
+
+    // drop the removed edges and the reversed edges
+    // and store the edges in one array
+    void compact() {
+        if (_compact)
+            return;
+
+        size_t num = 0;
+        for (const auto& edges : _edges)
+            num += edges.size();
+
+        _offsets.reserve(_nodes.size() + 1);
+        _csr.reserve(num);
+        for (const auto& edges : _edges) {
+            _offsets.push_back(_csr.size());
+            for (const EdgeT& edge : edges) {
+                if (edge.second)
+                    _csr.push_back(edge);
+            }
+        }
+        _offsets.push_back(_csr.size());
+        _csr.shrink_to_fit();
+
+        _edges.clear();
+        _edges.shrink_to_fit();
+        _reverse.clear();
+        _reverse.shrink_to_fit();
+        _positions.clear();
+        _keep_reverse = false;
+        _removable = false;
+        _compact = true;
+    }
+
+    bool contains(const NodeT *n) const { return _findId(n) != NO_ID; }
+
+    // the ID of a node that is in the graph
+    unsigned getId(const NodeT *n) const {
+        unsigned id = _findId(n);
+        assert(id != NO_ID && "The node is not in the graph");
+        return id;
+    }
+
+    NodeT *getNode(unsigned id) const {
+        assert(id < _nodes.size());
+        return _nodes[id];
+    }
+
+    // the nodes in the order of their IDs
+    const std::vector<NodeT *>& getNodes() const { return _nodes; }
+    size_t size() const { return _nodes.size(); }
+
+    edges_range edges(unsigned id) const {
+        assert(id < _nodes.size());
+        if (_compact)
+            return edges_range(_csr.data() + _offsets[id],
+                               _csr.data() + _offsets[id + 1]);
+
+        return _range(_edges[id]);
+    }
+
+    edges_range edges(const NodeT *n) const {
+        unsigned id = _findId(n);
+        if (id == NO_ID)
+            return edges_range(nullptr, nullptr);
+        return edges(id);
+    }
+
+    // the reversed edges, available until compact()
+    edges_range reverseEdges(const NodeT *n) const {
+        assert(_keep_reverse && "The graph does not keep reversed edges");
+        unsigned id = _findId(n);
+        if (id == NO_ID)
+            return edges_range(nullptr, nullptr);
+        return _range(_reverse[id]);
+    }
+};
+
+} // namespace srg
+} // namespace rd
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_SPARSE_RD_GRAPH_H_
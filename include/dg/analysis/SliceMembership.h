@@ -0,0 +1,172 @@
+#ifndef _DG_SLICE_MEMBERSHIP_H_
+#define _DG_SLICE_MEMBERSHIP_H_
+
+#include <map>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include <cassert>
+
+#include "dg/ADT/DenseBitvector.h"
+
+namespace dg {
+namespace analysis {
+
+///
+// Membership of nodes in slices. The nodes get dense IDs when they
+// are first put into some slice and every slice is a bitvector
+// over these IDs. Thus we can keep many slices of the same graph
+// at once (the slice_id stamped into the nodes keeps only the last one)
+// and compare them without walking the graph again.
+//
+// The slices are identified by the slice IDs used for marking.
+// The Slicer fills the slices during marking if it is given
+// SliceMembership object (see Slicer::setSliceMembership)
+// and it slices w.r.t. the slices kept here, so a slice computed
+// from other slices (setSlice()) can be sliced without marking.
+template <typename NodeT>
+class SliceMembership
+{
+public:
+    using SliceT = ADT::DenseBitvector;
+
+private:
+    // node -> ID and ID -> node
+    std::unordered_map<const NodeT *, unsigned> _ids;
+    std::vector<NodeT *> _nodes;
+
+    // slice ID -> nodes in the slice
+    std::map<uint32_t, SliceT> _slices;
+
+    static const SliceT& _emptySlice() {
+        static const SliceT empty;
+        return empty;
+    }
+
+public:
+    // the dense ID of the node, the node gets a new ID
+    // if it has not any yet
+    unsigned getId(NodeT *n) {
+        auto it = _ids.find(n);
+        if (it != _ids.end())
+            return it->second;
+
+        unsigned id = static_cast<unsigned>(_nodes.size());
+        _ids.emplace(n, id);
+        _nodes.push_back(n);
+        return id;
+    }
+
+    NodeT *getNode(unsigned id) const {
+        assert(id < _nodes.size());
+        return _nodes[id];
+    }
+
+    // the number of nodes that have an ID
+    size_t nodesNum() const { return _nodes.size(); }
+
+    // returns true if the node was not in the slice yet
+    bool add(uint32_t sl_id, NodeT *n) {
+        return !_slices[sl_id].set(getId(n));
+    }
+
+    bool contains(uint32_t sl_id, const NodeT *n) const {
+        auto it = _ids.find(n);
+        if (it == _ids.end())
+            return false;
+
+        return getSlice(sl_id).get(it->second);
+    }
+
+    bool hasSlice(uint32_t sl_id) const {
+        return _slices.count(sl_id) > 0;
+    }
+
+    const SliceT& getSlice(uint32_t sl_id) const {
+        auto it = _slices.find(sl_id);
+        if (it == _slices.end())
+            return _emptySlice();
+        return it->second;
+    }
+
+    // store a slice computed from other slices
+    // (e.g. an union of slices) under the given slice ID
+    void setSlice(uint32_t sl_id, SliceT slice) {
+        _slices[sl_id] = std::move(slice);
+    }
+
+    void removeSlice(uint32_t sl_id) { _slices.erase(sl_id); }
+
+    const std::map<uint32_t, SliceT>& getSlices() const { return _slices; }
+
+    // the nodes in the slice
+    std::vector<NodeT *> getNodes(uint32_t sl_id) const {
+        std::vector<NodeT *> ret;
+        for (size_t id : getSlice(sl_id))
+            ret.push_back(_nodes[id]);
+        return ret;
+    }
+
+    size_t size(uint32_t sl_id) const { return getSlice(sl_id).size(); }
+
+    // the sizes of more slices at once
+    std::vector<size_t> sizes(const std::vector<uint32_t>& sl_ids) const {
+        std::vector<size_t> ret;
+        ret.reserve(sl_ids.size());
+        for (uint32_t sl_id : sl_ids)
+            ret.push_back(size(sl_id));
+        return ret;
+    }
+
+    SliceT getUnion(uint32_t a, uint32_t b) const {
+        SliceT ret = getSlice(a);
+        ret.merge(getSlice(b));
+        return ret;
+    }
+
+    SliceT getIntersection(uint32_t a, uint32_t b) const {
+        SliceT ret = getSlice(a);
+        ret.intersect(getSlice(b));
+        return ret;
+    }
+
+    // the nodes that are in the slice 'a', but not in the slice 'b'
+    SliceT getDifference(uint32_t a, uint32_t b) const {
+        SliceT ret = getSlice(a);
+        ret.subtract(getSlice(b));
+        return ret;
+    }
+
+    // do the slices have a common node?
+    bool overlap(uint32_t a, uint32_t b) const {
+        return getSlice(a).intersects(getSlice(b));
+    }
+
+    // the number of nodes that are in both the slices
+    size_t overlapSize(uint32_t a, uint32_t b) const {
+        return getSlice(a).intersectionSize(getSlice(b));
+    }
+
+    // the number of common nodes for every pair of the given slices,
+    // the result is the symmetric matrix indexed as 'sl_ids'
+    std::vector<std::vector<size_t>>
+    overlapSizes(const std::vector<uint32_t>& sl_ids) const {
+        std::vector<std::vector<size_t>> ret(sl_ids.size(),
+                                             std::vector<size_t>(sl_ids.size()));
+        for (size_t i = 0; i < sl_ids.size(); ++i) {
+            const SliceT& si = getSlice(sl_ids[i]);
+            ret[i][i] = si.size();
+            for (size_t j = i + 1; j < sl_ids.size(); ++j) {
+                ret[i][j] = si.intersectionSize(getSlice(sl_ids[j]));
+                ret[j][i] = ret[i][j];
+            }
+        }
+
+        return ret;
+    }
+};
+
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_SLICE_MEMBERSHIP_H_
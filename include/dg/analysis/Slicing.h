@@ -2,11 +2,15 @@
 #define _DG_SLICING_H_
 
 #include <set>
+#include <vector>
 
 #include "dg/analysis/NodesWalk.h"
 #include "dg/analysis/BFS.h"
+#include "dg/analysis/SliceMembership.h"
 #include "dg/ADT/Queue.h"
+#include "dg/ADT/ParallelFor.h"
 #include "dg/DependenceGraph.h"
+#include "dg/FrozenEdges.h"
 
 #ifdef ENABLE_CFG
 #include "dg/BBlock.h"
@@ -48,9 +52,13 @@ public:
     // returns marked blocks, but only for forward slicing atm
     const std::set<BBlock<NodeT> *>& getMarkedBlocks() { return markedBlocks; }
 
+    // record the marked nodes also into the given slices
+    void setSliceMembership(SliceMembership<NodeT> *m) { membership = m; }
+
 private:
     bool forward_slice{false};
     std::set<BBlock<NodeT> *> markedBlocks;
+    SliceMembership<NodeT> *membership{nullptr};
 
 
     struct WalkData
@@ -74,6 +82,8 @@ private:
     {
         uint32_t slice_id = data->slice_id;
         n->setSlice(slice_id);
+        if (data->analysis->membership)
+            data->analysis->membership->add(slice_id, n);
 
 #ifdef ENABLE_CFG
         // when we marked a node, we need to mark even
@@ -88,6 +98,9 @@ private:
         // the same with dependence graph, if we keep a node from
         // a dependence graph, we need to keep the dependence graph
         if (DependenceGraph<NodeT> *dg = n->getDG()) {
+            // the walk follows the control dependencies
+            // of the node's block right after this
+            dg->ensureControlDependencies();
             dg->setSlice(slice_id);
             if (!data->analysis->isForward()) {
                 // and keep also all call-sites of this func (they are
@@ -102,6 +115,187 @@ private:
     }
 };
 
+///
+// Parallel variant of WalkAndMark for backward slicing. The walk is
+// level-synchronous: the nodes of one level are split into chunks
+// that are processed in parallel and the nodes reached from a chunk
+// are claimed using atomic visited flags (lastwalkid of the nodes),
+// so every node gets into exactly one next level. The blocks and
+// the graphs of the marked nodes are shared by more nodes, so they are
+// marked between the levels by one thread (the control dependencies
+// of newly reached graphs are computed in parallel, as the graphs
+// are independent). It marks the same nodes as WalkAndMark.
+//
+// Computing the data dependencies on demand is not supported,
+// the provider adds edges to the nodes that other threads walk.
+// If it is given frozen edges, it walks them instead of the edges
+// in the nodes (it is the only walk that can do that).
+template <typename NodeT>
+class ParallelWalkAndMark : public NodesWalkBase<NodeT>
+{
+    // the number of nodes of a level processed by one task
+    static size_t chunkSize() { return 256; }
+
+    // the nodes, graphs and blocks reached from one chunk of a level
+    struct ChunkResult
+    {
+        std::vector<NodeT *> nodes;
+        std::vector<DependenceGraph<NodeT> *> graphs;
+#ifdef ENABLE_CFG
+        std::vector<BBlock<NodeT> *> blocks;
+#endif
+    };
+
+    unsigned threads;
+    unsigned int run_id{0};
+    SliceMembership<NodeT> *membership{nullptr};
+    const FrozenEdges<NodeT> *frozen{nullptr};
+    std::set<DependenceGraph<NodeT> *> markedGraphs;
+
+    // returns true if the node was not reached in this walk yet
+    bool claim(NodeT *n)
+    {
+        AnalysesAuxiliaryData& aad = this->getAnalysisData(n);
+        return __atomic_exchange_n(&aad.lastwalkid, run_id,
+                                   __ATOMIC_RELAXED) != run_id;
+    }
+
+    void reach(NodeT *n, ChunkResult& res)
+    {
+        if (!claim(n))
+            return;
+
+        res.nodes.push_back(n);
+        // the neighbours are mostly from the same graph,
+        // the duplicates are removed between the levels
+        DependenceGraph<NodeT> *dg = n->getDG();
+        if (dg && (res.graphs.empty() || res.graphs.back() != dg))
+            res.graphs.push_back(dg);
+    }
+
+    template <typename IT>
+    void reachAll(IT begin, IT end, ChunkResult& res)
+    {
+        for (IT I = begin; I != end; ++I)
+            reach(*I, res);
+    }
+
+    void reachFrozen(NodeT *n, typename FrozenEdges<NodeT>::EdgeKind kind,
+                     ChunkResult& res)
+    {
+        for (unsigned id : frozen->edges(n, kind))
+            reach(frozen->getNode(id), res);
+    }
+
+    void processNode(NodeT *n, uint32_t slice_id, ChunkResult& res)
+    {
+        n->setSlice(slice_id);
+
+        if (frozen)
+            reachFrozen(n, FrozenEdges<NodeT>::REV_CONTROL, res);
+        else
+            reachAll(n->rev_control_begin(), n->rev_control_end(), res);
+#ifdef ENABLE_CFG
+        if (BBlock<NodeT> *B = n->getBBlock()) {
+            if (res.blocks.empty() || res.blocks.back() != B)
+                res.blocks.push_back(B);
+
+            for (BBlock<NodeT> *CD : B->revControlDependence())
+                reach(CD->getLastNode(), res);
+        }
+#endif
+
+        if (frozen) {
+            reachFrozen(n, FrozenEdges<NodeT>::REV_DATA, res);
+            reachFrozen(n, FrozenEdges<NodeT>::USER, res);
+        } else {
+            reachAll(n->rev_data_begin(), n->rev_data_end(), res);
+            reachAll(n->user_begin(), n->user_end(), res);
+        }
+    }
+
+    // mark the graphs that were reached for the first time
+    // and add their entry nodes to the level (the call-sites
+    // are control dependent on the entry node)
+    void markGraphs(const std::vector<DependenceGraph<NodeT> *>& graphs,
+                    uint32_t slice_id, std::vector<NodeT *>& level)
+    {
+        std::vector<DependenceGraph<NodeT> *> newGraphs;
+        for (DependenceGraph<NodeT> *dg : graphs) {
+            if (markedGraphs.insert(dg).second)
+                newGraphs.push_back(dg);
+        }
+
+        ADT::parallelFor(newGraphs.size(), threads, [&newGraphs](size_t i) {
+            newGraphs[i]->ensureControlDependencies();
+        });
+
+        for (DependenceGraph<NodeT> *dg : newGraphs) {
+            dg->setSlice(slice_id);
+            NodeT *entry = dg->getEntry();
+            assert(entry && "No entry node in dg");
+            if (claim(entry))
+                level.push_back(entry);
+        }
+    }
+
+public:
+    ParallelWalkAndMark(unsigned thr) : threads(thr) {}
+
+    // record the marked nodes also into the given slices
+    void setSliceMembership(SliceMembership<NodeT> *m) { membership = m; }
+
+    // walk the frozen edges instead of the edges in the nodes
+    void setFrozenEdges(const FrozenEdges<NodeT> *f) { frozen = f; }
+
+    void mark(const std::set<NodeT *>& start, uint32_t slice_id)
+    {
+        assert(!start.empty() && "Need entry node for traversing nodes");
+        run_id = ++NodesWalkBase<NodeT>::walk_run_counter;
+
+        ChunkResult res;
+        for (NodeT *n : start)
+            reach(n, res);
+
+        std::vector<NodeT *> level = std::move(res.nodes);
+        std::vector<DependenceGraph<NodeT> *> graphs = std::move(res.graphs);
+        std::vector<ChunkResult> results;
+
+        while (!level.empty()) {
+            markGraphs(graphs, slice_id, level);
+            graphs.clear();
+
+            size_t chunks = (level.size() + chunkSize() - 1) / chunkSize();
+            results.clear();
+            results.resize(chunks);
+            ADT::parallelFor(chunks, threads, [&](size_t c) {
+                size_t b = c * chunkSize();
+                size_t e = b + chunkSize();
+                if (e > level.size())
+                    e = level.size();
+                for (size_t i = b; i < e; ++i)
+                    processNode(level[i], slice_id, results[c]);
+            });
+
+            if (membership) {
+                for (NodeT *n : level)
+                    membership->add(slice_id, n);
+            }
+
+            // gather the next level
+            level.clear();
+            for (ChunkResult& r : results) {
+#ifdef ENABLE_CFG
+                for (BBlock<NodeT> *B : r.blocks)
+                    B->setSlice(slice_id);
+#endif
+                level.insert(level.end(), r.nodes.begin(), r.nodes.end());
+                graphs.insert(graphs.end(), r.graphs.begin(), r.graphs.end());
+            }
+        }
+    }
+};
+
 struct SlicerStatistics
 {
     SlicerStatistics()
@@ -121,16 +315,31 @@ class Slicer : Analysis<NodeT>
 {
     uint32_t options;
     uint32_t slice_id;
+    unsigned threads{1};
+    DataDependenceProvider<NodeT> *dd_provider{nullptr};
+    const FrozenEdges<NodeT> *frozen{nullptr};
+    SliceMembership<NodeT> *membership{nullptr};
 
     std::set<DependenceGraph<NodeT> *> sliced_graphs;
 
+    // the slice that is being sliced if it is kept in 'membership'
+    // (then it does not need to be stamped into the nodes, e.g.,
+    // it may be an union of other slices)
+    const typename SliceMembership<NodeT>::SliceT *members{nullptr};
+#ifdef ENABLE_CFG
+    // the blocks of the nodes in 'members'
+    std::set<BBlock<NodeT> *> members_blocks;
+#endif
+
     // slice nodes from the graph; do it recursively for call-nodes
     void sliceNodes(DependenceGraph<NodeT> *dg, uint32_t slice_id)
     {
-        for (auto& it : *dg) {
-            NodeT *n = it.second;
+        for (auto I = dg->begin(), E = dg->end(); I != E;) {
+            NodeT *n = I->second;
+            // move on before the node is deleted
+            ++I;
 
-            if (n->getSlice() != slice_id) {
+            if (!inSlice(n, slice_id)) {
                 if (removeNode(n)) // do backend's specific logic
                     dg->deleteNode(n);
 
@@ -154,6 +363,48 @@ protected:
     // how many nodes and blocks were removed or kept
     SlicerStatistics statistics;
 
+    // Slice w.r.t. the slice 'sl_id' kept in the slice membership
+    // (if there is any) until resetMembers() is called.
+    // inSlice() then reads the membership instead of the slice IDs
+    // stamped into the nodes and blocks.
+    void setMembers(uint32_t sl_id)
+    {
+        if (!membership || !membership->hasSlice(sl_id))
+            return;
+
+        members = &membership->getSlice(sl_id);
+#ifdef ENABLE_CFG
+        for (size_t id : *members) {
+            if (BBlock<NodeT> *B = membership->getNode(id)->getBBlock())
+                members_blocks.insert(B);
+        }
+#endif // ENABLE_CFG
+    }
+
+    void resetMembers()
+    {
+        members = nullptr;
+#ifdef ENABLE_CFG
+        members_blocks.clear();
+#endif // ENABLE_CFG
+    }
+
+    bool inSlice(const NodeT *n, uint32_t sl_id) const
+    {
+        if (members)
+            return membership->contains(sl_id, n);
+        return n->getSlice() == sl_id;
+    }
+
+#ifdef ENABLE_CFG
+    bool inSlice(BBlock<NodeT> *B, uint32_t sl_id) const
+    {
+        if (members)
+            return members_blocks.count(B) > 0;
+        return B->getSlice() == sl_id;
+    }
+#endif
+
 public:
     Slicer<NodeT>(uint32_t opt = 0)
         :options(opt), slice_id(0) {}
@@ -161,15 +412,62 @@ public:
     SlicerStatistics& getStatistics() { return statistics; }
     const SlicerStatistics& getStatistics() const { return statistics; }
 
+    // compute the data dependencies of the nodes during marking,
+    // only for the nodes that are reached (backward slicing only)
+    void setDataDependenceProvider(DataDependenceProvider<NodeT> *p)
+    {
+        dd_provider = p;
+    }
+
+    // mark the backward slices using ParallelWalkAndMark
+    // with the given number of threads
+    void setThreads(unsigned thr) { threads = thr; }
+
+    // walk the frozen edges when marking (backward slicing only),
+    // the edges in the nodes may be released then
+    void setFrozenEdges(const FrozenEdges<NodeT> *f) { frozen = f; }
+
+    // keep the marked nodes also in the given slices
+    // (under the slice ID), so that the slices can be compared
+    // after the graph is marked w.r.t. other criteria.
+    // slice() then slices w.r.t. the slice kept there, if there is any.
+    void setSliceMembership(SliceMembership<NodeT> *m)
+    {
+        membership = m;
+    }
+
     ///
     // Mark nodes dependent on 'start' with 'sl_id'.
     // If 'forward_slice' is true, mark the nodes depending on 'start' instead.
     uint32_t mark(NodeT *start, uint32_t sl_id = 0, bool forward_slice = false)
+    {
+        return mark(std::set<NodeT *>{start}, sl_id, forward_slice);
+    }
+
+    ///
+    // Mark nodes dependent on any of the nodes from 'start' with 'sl_id'.
+    uint32_t mark(const std::set<NodeT *>& start, uint32_t sl_id = 0,
+                  bool forward_slice = false)
     {
         if (sl_id == 0)
             sl_id = ++slice_id;
 
+        assert((!forward_slice || !dd_provider)
+               && "Forward slicing needs all data dependencies computed");
+        assert((!frozen || (!forward_slice && !dd_provider))
+               && "Frozen edges can be used only for backward slicing");
+
+        if ((threads > 1 || frozen) && !forward_slice && !dd_provider) {
+            ParallelWalkAndMark<NodeT> pwm(threads);
+            pwm.setSliceMembership(membership);
+            pwm.setFrozenEdges(frozen);
+            pwm.mark(start, sl_id);
+            return sl_id;
+        }
+
         WalkAndMark<NodeT> wm(forward_slice);
+        wm.setDataDependenceProvider(dd_provider);
+        wm.setSliceMembership(membership);
         wm.mark(start, sl_id);
 
         ///
@@ -191,6 +489,7 @@ public:
 
             if (!branchings.empty()) {
                 WalkAndMark<NodeT> wm2;
+                wm2.setSliceMembership(membership);
                 wm2.mark(branchings, sl_id);
             }
         }
@@ -202,6 +501,8 @@ public:
     // before this routine (otherwise everything is sliced)
     uint32_t slice(DependenceGraph<NodeT> *dg, uint32_t sl_id = 0)
     {
+        setMembers(sl_id);
+
 #ifdef ENABLE_CFG
         // first slice away bblocks that should go away
         sliceBBlocks(dg, sl_id);
@@ -210,6 +511,8 @@ public:
         // now slice the nodes from the remaining graphs
         sliceNodes(dg, sl_id);
 
+        resetMembers();
+
         return sl_id;
     }
 
@@ -275,7 +578,7 @@ public:
         // through the constructed blocks (keep temporary always-valid iterator)
         std::set<BBlock<NodeT> *> blocks;
         for (auto& it : CB) {
-            if (it.second->getSlice() != sl_id)
+            if (!inSlice(it.second, sl_id))
                 blocks.insert(it.second);
         }
 
@@ -324,6 +324,15 @@ public:
         users.clear();
     }
 
+    // remove all operands of this node
+    // (and this node from the users of the operands)
+    void removeAllOperands() {
+        for (NodeT *op : operands)
+            op->removeUser(static_cast<NodeT *>(this));
+
+        operands.clear();
+    }
+
     size_t predecessorsNum() const {
         return predecessors.size();
     }
@@ -377,6 +386,15 @@ private:
 
         users.push_back(nd);
     }
+
+    void removeUser(NodeT *nd) {
+        for (auto it = users.begin(); it != users.end(); ++it) {
+            if (*it == nd) {
+                users.erase(it);
+                return;
+            }
+        }
+    }
 };
 
 } // analysis
@@ -90,7 +90,7 @@ public:
     LLVMDG2Dot(LLVMDependenceGraph *dg,
                uint32_t opts = debug::PRINT_CFG | debug::PRINT_DD | debug::PRINT_CD,
                const char *file = NULL)
-        : debug::DG2Dot<LLVMNode>(dg, opts, file) {}
+        : debug::DG2Dot<LLVMNode>(dg, opts, file), llvmDG(dg) {}
 
     /* virtual */
     std::ostream& printKey(std::ostream& os, llvm::Value *val)
@@ -175,7 +175,7 @@ public:
             return false;
 
         const std::map<llvm::Value *,
-                       LLVMDependenceGraph *>& CF = getConstructedFunctions();
+                       LLVMDependenceGraph *>& CF = llvmDG->getConstructedFunctions();
 
         start();
 
@@ -207,6 +207,9 @@ private:
 
         dumpSubgraphEnd(graph);
     }
+
+private:
+    LLVMDependenceGraph *llvmDG;
 };
 
 class LLVMDGDumpBlocks : public debug::DG2Dot<LLVMNode>
@@ -216,7 +219,7 @@ public:
     LLVMDGDumpBlocks(LLVMDependenceGraph *dg,
                   uint32_t opts = debug::PRINT_CFG | debug::PRINT_DD | debug::PRINT_CD,
                   const char *file = NULL)
-        : debug::DG2Dot<LLVMNode>(dg, opts, file) {}
+        : debug::DG2Dot<LLVMNode>(dg, opts, file), llvmDG(dg) {}
 
     /* virtual
     std::ostream& printKey(std::ostream& os, llvm::Value *val)
@@ -239,7 +242,7 @@ public:
             return false;
 
         const std::map<llvm::Value *,
-                       LLVMDependenceGraph *>& CF = getConstructedFunctions();
+                       LLVMDependenceGraph *>& CF = llvmDG->getConstructedFunctions();
 
         start();
 
@@ -323,6 +326,9 @@ private:
                 << " [color=blue constraint=false]\n";
         }
     }
+
+private:
+    LLVMDependenceGraph *llvmDG;
 };
 } /* namespace debug */
 } /* namespace dg */
@@ -13,7 +13,10 @@
 #endif
 
 #include <map>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 // forward declaration of llvm classes
 namespace llvm {
@@ -49,6 +52,39 @@ using analysis::rd::LLVMReachingDefinitions;
 
 using LLVMBBlock = dg::BBlock<LLVMNode>;
 
+class LLVMDependenceGraph;
+
+///
+// The functions whose graphs were constructed by one build.
+// The registry is shared by the graph of the entry function
+// and all its subgraphs, and it can be used from several threads.
+class LLVMConstructedFunctions {
+public:
+    using MapT = std::map<llvm::Value *, LLVMDependenceGraph *>;
+
+    // return the graph of the function or nullptr
+    LLVMDependenceGraph *get(llvm::Value *func) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _functions.find(func);
+        return it == _functions.end() ? nullptr : it->second;
+    }
+
+    // register the graph of the function,
+    // return false if the function has a graph already
+    bool add(llvm::Value *func, LLVMDependenceGraph *graph) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _functions.emplace(func, graph).second;
+    }
+
+    // NOTE: the map must not be used while
+    // some other thread registers functions
+    const MapT& getMap() const { return _functions; }
+
+private:
+    mutable std::mutex _mutex;
+    MapT _functions;
+};
+
 /// ------------------------------------------------------------------
 //  -- LLVMDependenceGraph
 /// ------------------------------------------------------------------
@@ -61,12 +97,20 @@ public:
     LLVMDependenceGraph()
         : gather_callsites(nullptr), module(nullptr), PTA(nullptr) {}
 
+    // use this number of threads when building the graph
+    // and computing the control dependencies
+    // (see build(llvm::Module *, llvm::Function *))
+    void setThreads(unsigned num) { threads = num; }
+    unsigned getThreads() const { return threads; }
+
     // free all allocated memory and unref subgraphs
     ~LLVMDependenceGraph();
 
     // build a nodes and CFG edges from module.
     // This method will build also all subgraphs. If entry is nullptr,
     // then this methods looks for function named 'main'.
+    // With more than one thread, the blocks and nodes of the functions
+    // are built in parallel and the call-sites are linked afterwards.
     // NOTE: this methods does not compute the dependence edges.
     // For that functionality check the LLVMDependenceGraphBuilder.
     bool build(llvm::Module *m, llvm::Function *entry = nullptr);
@@ -84,6 +128,10 @@ public:
 
     llvm::Module *getModule() const { return module; }
 
+    // the graphs of all the functions constructed
+    // together with this graph (including this one)
+    const LLVMConstructedFunctions::MapT& getConstructedFunctions() const;
+
     // if we want to slice according some call-site(s),
     // we can gather the relevant call-sites while building
     // graph and do not need to recursively find in the graph
@@ -128,6 +176,15 @@ public:
             abort();
     }
 
+    // do not compute the control dependencies now, compute them
+    // for each function when they are first needed
+    // (see ensureControlDependencies())
+    void computeControlDependenciesOnDemand(CD_ALG alg_type);
+
+    // compute the control dependencies of the function
+    // if they are computed on demand and were not computed yet
+    void ensureControlDependencies() override;
+
     bool verify() const;
 
     /* virtual */
@@ -146,8 +203,13 @@ public:
     LLVMReachingDefinitions *getRDA() const { return RDA; }
 
 private:
+    // compute the control dependencies in all constructed functions,
+    // using 'threads' threads (the functions are independent)
     void computePostDominators(bool addPostDomFrontiers = false);
     void computeControlExpression(bool addCDs = false);
+    // the same for the function of this graph only
+    void computeFunctionPostDominators(bool addPostDomFrontiers);
+    ControlExpression computeFunctionControlExpression(bool addCDs);
 
     // add formal parameters of the function to the graph
     // (graph is a graph of one procedure)
@@ -161,8 +223,31 @@ private:
     // convert llvm basic block to our basic block
     // That includes creating all the nodes and adding them
     // to this graph and creating the basic block and
-    // setting first and last instructions
-    LLVMBBlock *build(llvm::BasicBlock& BB);
+    // setting first and last instructions.
+    // If handleInstructions is false, handleInstruction()
+    // is not called for the nodes (see linkInstructions())
+    LLVMBBlock *build(llvm::BasicBlock& BB, bool handleInstructions = true);
+
+    // the parts of build(llvm::Function *). buildEntry() registers
+    // the function and creates the entry node and the formal parameters,
+    // buildBlocks() creates the nodes, blocks and CFG edges
+    void buildEntry(llvm::Function *func);
+    void buildBlocks(llvm::Function *func, bool handleInstructions = true);
+    // call handleInstruction() for all nodes in the order of instructions
+    void linkInstructions();
+
+    // build the graphs of all functions reachable from 'entry'
+    // using 'threads' threads
+    void buildParallel(llvm::Function *entry);
+
+    // create an empty graph for the function that shares
+    // the global nodes and the constructed functions with this graph
+    LLVMDependenceGraph *createSubgraph();
+
+    // add the functions that are called by the call instruction
+    // and whose graphs we build to 'functions'
+    void getCalledFunctions(llvm::Value *call,
+                            std::vector<llvm::Function *>& functions) const;
 
     // gather call-sites of functions with given name
     // when building the graph
@@ -182,6 +267,17 @@ private:
     // reaching definitions information (if available)
     LLVMReachingDefinitions *RDA;
 
+    // the functions constructed together with this graph
+    std::shared_ptr<LLVMConstructedFunctions> constructedFunctions;
+
+    // the number of threads used for building the graph
+    unsigned threads{1};
+
+    // compute the control dependencies of this function on demand
+    bool cdOnDemand{false};
+    CD_ALG cdAlgorithm{CD_ALG::CLASSIC};
+    std::once_flag cdComputed;
+
     // control expression for this graph
     ControlExpression CE;
 
@@ -189,9 +285,6 @@ private:
     friend class LLVMDGVerifier;
 };
 
-const std::map<llvm::Value *,
-               LLVMDependenceGraph *>& getConstructedFunctions();
-
 } // namespace dg
 
 #endif // _DEPENDENCE_GRAPH_H_
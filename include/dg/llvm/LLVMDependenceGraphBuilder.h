@@ -1,6 +1,7 @@
 #ifndef _DG_LLVM_DEPENDENCE_GRAPH_BUILDER_H_
 #define _DG_LLVM_DEPENDENCE_GRAPH_BUILDER_H_
 
+#include <chrono>
 #include <string>
 
 // ignore unused parameters in LLVM libraries
@@ -32,6 +33,7 @@
 #include "dg/analysis/PointsTo/PointerAnalysisFI.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFS.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFSInv.h"
+#include "dg/analysis/PointsTo/PointerAnalysisSFS.h"
 #include "dg/analysis/PointsTo/Pointer.h"
 #include "dg/analysis/Offset.h"
 
@@ -51,22 +53,60 @@ struct LLVMDependenceGraphOptions {
     LLVMReachingDefinitionsAnalysisOptions RDAOptions{};
 
     CD_ALG cdAlgorithm{CD_ALG::CLASSIC};
+    // compute the control dependencies of a function
+    // only when the slicer reaches it
+    bool cdOnDemand{false};
+    // do not add the data dependencies to the graph, let the slicer
+    // compute them for the nodes it reaches (see getDataDependenceProvider()).
+    // Usable only for backward slicing
+    bool ddOnDemand{false};
 
     bool verifyGraph{true};
     bool DUUndefinedArePure{false};
     std::string entryFunction{"main"};
+    // the number of threads used for building the graph
+    unsigned threads{1};
 };
 
 class LLVMDependenceGraphBuilder {
+public:
+    // the time spent in the phases of the construction
+    struct Statistics {
+        using DurationT = std::chrono::steady_clock::duration;
+
+        DurationT ptaTime{};
+        DurationT rdaTime{};
+        DurationT buildTime{};
+        DurationT defUseTime{};
+        DurationT cdTime{};
+    };
+
+private:
+    // add the time from the construction
+    // to the destruction of the object to 'time'
+    class PhaseTimer {
+        using Clock = std::chrono::steady_clock;
+
+        Statistics::DurationT& time;
+        Clock::time_point start;
+
+    public:
+        PhaseTimer(Statistics::DurationT& t) : time(t), start(Clock::now()) {}
+        ~PhaseTimer() { time += Clock::now() - start; }
+    };
+
     llvm::Module *_M;
     const LLVMDependenceGraphOptions _options;
     std::unique_ptr<LLVMPointerAnalysis> _PTA{};
     std::unique_ptr<LLVMReachingDefinitions> _RD{};
     std::unique_ptr<LLVMDependenceGraph> _dg{};
+    std::unique_ptr<LLVMDefUseAnalysis> _DU{};
     llvm::Function *_entryFunction{nullptr};
+    Statistics _statistics{};
 
     void _runPointerAnalysis() {
         assert(_PTA && "BUG: No PTA");
+        PhaseTimer timer(_statistics.ptaTime);
 
         if (_options.PTAOptions.isFS())
             _PTA->run<analysis::pta::PointerAnalysisFS>();
@@ -74,6 +114,8 @@ class LLVMDependenceGraphBuilder {
             _PTA->run<analysis::pta::PointerAnalysisFI>();
         else if (_options.PTAOptions.isFSInv())
             _PTA->run<analysis::pta::PointerAnalysisFSInv>();
+        else if (_options.PTAOptions.isSFS())
+            _PTA->run<analysis::pta::PointerAnalysisSFS>();
         else {
             assert(0 && "Wrong pointer analysis");
             abort();
@@ -82,6 +124,7 @@ class LLVMDependenceGraphBuilder {
 
     void _runReachingDefinitionsAnalysis() {
         assert(_RD && "BUG: No RD");
+        PhaseTimer timer(_statistics.rdaTime);
 
         if (_options.RDAOptions.isDense()) {
             _RD->run<dg::analysis::rd::ReachingDefinitionsAnalysis>();
@@ -94,16 +137,27 @@ class LLVMDependenceGraphBuilder {
     }
 
     void _runDefUseAnalysis() {
-        LLVMDefUseAnalysis DUA(_dg.get(),
-                               _RD.get(),
-                               _PTA.get(),
-                               // FIXME: this should go to DU Options
-                               _options.DUUndefinedArePure);
-        DUA.run(); // add def-use edges according that
+        PhaseTimer timer(_statistics.defUseTime);
+        _DU.reset(new LLVMDefUseAnalysis(_dg.get(),
+                                         _RD.get(),
+                                         _PTA.get(),
+                                         // FIXME: this should go to DU Options
+                                         _options.DUUndefinedArePure));
+        if (!_options.ddOnDemand)
+            _DU->run(); // add def-use edges according that
     }
 
     void _runControlDependenceAnalysis() {
-        _dg->computeControlDependencies(_options.cdAlgorithm);
+        PhaseTimer timer(_statistics.cdTime);
+        if (_options.cdOnDemand)
+            _dg->computeControlDependenciesOnDemand(_options.cdAlgorithm);
+        else
+            _dg->computeControlDependencies(_options.cdAlgorithm);
+    }
+
+    void _buildGraph() {
+        PhaseTimer timer(_statistics.buildTime);
+        _dg->build(_M, _PTA.get(), _RD.get(), _entryFunction);
     }
 
     bool verify() const {
@@ -123,10 +177,17 @@ public:
       _dg(new LLVMDependenceGraph()),
       _entryFunction(M->getFunction(_options.entryFunction)) {
         assert(_entryFunction && "The entry function not found");
+        _dg->setThreads(_options.threads);
     }
 
     LLVMPointerAnalysis *getPTA() { return _PTA.get(); }
     LLVMReachingDefinitions *getRDA() { return _RD.get(); }
+    const Statistics& getStatistics() const { return _statistics; }
+
+    // the provider of data dependencies if they are computed on demand
+    analysis::DataDependenceProvider<LLVMNode> *getDataDependenceProvider() {
+        return _options.ddOnDemand ? _DU.get() : nullptr;
+    }
 
     // construct the whole graph with all edges
     std::unique_ptr<LLVMDependenceGraph>&& build() {
@@ -135,7 +196,7 @@ public:
         _runReachingDefinitionsAnalysis();
 
         // build the graph itself
-        _dg->build(_M, _PTA.get(), _RD.get(), _entryFunction);
+        _buildGraph();
 
         // insert the data dependencies edges
         _runDefUseAnalysis();
@@ -163,7 +224,7 @@ public:
         _runPointerAnalysis();
 
         // build the graph itself
-        _dg->build(_M, _PTA.get(), _RD.get(), _entryFunction);
+        _buildGraph();
 
         // verify if the graph is built correctly
         if (_options.verifyGraph && !_dg->verify()) {
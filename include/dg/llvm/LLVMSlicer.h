@@ -133,7 +133,7 @@ public:
         return 0;
     }
 
-    uint32_t slice(LLVMDependenceGraph *,
+    uint32_t slice(LLVMDependenceGraph *dg,
                    LLVMNode *start, uint32_t sl_id = 0)
     {
         // mark nodes for slicing
@@ -141,11 +141,11 @@ public:
         if (start)
             sl_id = mark(start, sl_id);
 
+        setMembers(sl_id);
+
         // take every subgraph and slice it intraprocedurally
         // this includes the main graph
-        extern std::map<const llvm::Value *,
-                        LLVMDependenceGraph *> constructedFunctions;
-        for (auto& it : constructedFunctions) {
+        for (auto& it : dg->getConstructedFunctions()) {
             if (dontTouch(it.first->getName()))
                 continue;
 
@@ -153,6 +153,7 @@ public:
             sliceGraph(subdg, sl_id);
         }
 
+        resetMembers();
         return sl_id;
     }
 
@@ -311,7 +312,7 @@ private:
             // to the other branch
             // NOTE: do this before the next action, to rename the label if needed
             if (BB->successorsNum() == 2
-                && BB->getLastNode()->getSlice() != slice_id
+                && !inSlice(BB->getLastNode(), slice_id)
                 && !BB->successorsAreSame()) {
 
 #ifndef NDEBUG
@@ -332,7 +333,7 @@ private:
             // this is going to be an unconditional jump,
             // so just make the label 0
             if (BB->successorsNum() == 1
-                && BB->getLastNode()->getSlice() != slice_id) {
+                && !inSlice(BB->getLastNode(), slice_id)) {
                 auto edge = *(BB->successors().begin());
 
                 // modify the edge
@@ -466,7 +467,7 @@ private:
                 sliceCallNode(n, slice_id);
                 */
 
-            if (n->getSlice() != slice_id) {
+            if (!inSlice(n, slice_id)) {
                 removeNode(n);
                 graph->deleteNode(n);
                 ++statistics.nodesRemoved;
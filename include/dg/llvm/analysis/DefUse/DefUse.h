@@ -21,7 +21,10 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include <set>
+
 #include "dg/analysis/DataFlowAnalysis.h"
+#include "dg/analysis/NodesWalk.h"
 #include "dg/llvm/analysis/ReachingDefinitions/ReachingDefinitions.h"
 
 using dg::analysis::rd::LLVMReachingDefinitions;
@@ -36,13 +39,21 @@ namespace dg {
 class LLVMDependenceGraph;
 class LLVMNode;
 
-class LLVMDefUseAnalysis : public analysis::DataFlowAnalysis<LLVMNode>
+///
+// Adds the data dependence and use edges. Either run() adds
+// the edges for all the nodes, or the analysis is used as
+// a data dependence provider for the slicer and it adds
+// the edges of the nodes that the slicer reaches.
+class LLVMDefUseAnalysis : public analysis::DataFlowAnalysis<LLVMNode>,
+                           public analysis::DataDependenceProvider<LLVMNode>
 {
     LLVMDependenceGraph *dg;
     LLVMReachingDefinitions *RD;
     LLVMPointerAnalysis *PTA;
     const llvm::DataLayout *DL;
     bool assume_pure_functions;
+    // the nodes processed by computeDataDependencies()
+    std::set<LLVMNode *> processed;
 public:
     LLVMDefUseAnalysis(LLVMDependenceGraph *dg,
                        LLVMReachingDefinitions *rd,
@@ -52,6 +63,8 @@ public:
 
     /* virtual */
     bool runOnNode(LLVMNode *node, LLVMNode *prev);
+
+    void computeDataDependencies(LLVMNode *node) override;
 private:
     void addDataDependence(LLVMNode *node,
                            analysis::pta::PSNode *pts,
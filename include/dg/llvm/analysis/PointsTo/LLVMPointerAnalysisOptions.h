@@ -9,11 +9,20 @@ namespace analysis {
 
 struct LLVMPointerAnalysisOptions : public LLVMAnalysisOptions, PointerAnalysisOptions
 {
-    enum class AnalysisType { fi, fs, inv } analysisType{AnalysisType::fi};
+    enum class AnalysisType { fi, fs, inv, sfs } analysisType{AnalysisType::fi};
+
+    // shrink the pointer subgraph (merge equivalent nodes,
+    // remove no-ops and so on) before running the analysis
+    bool optimizeSubgraph{false};
+
+    LLVMPointerAnalysisOptions& setOptimizeSubgraph(bool b) {
+        optimizeSubgraph = b; return *this;
+    }
 
     bool isFS() const { return analysisType == AnalysisType::fs; }
     bool isFSInv() const { return analysisType == AnalysisType::inv; }
     bool isFI() const { return analysisType == AnalysisType::fi; }
+    bool isSFS() const { return analysisType == AnalysisType::sfs; }
 };
 
 } // namespace analysis
@@ -1,6 +1,8 @@
 #ifndef _LLVM_DG_POINTS_TO_ANALYSIS_H_
 #define _LLVM_DG_POINTS_TO_ANALYSIS_H_
 
+#include <type_traits>
+
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
 #pragma clang diagnostic push
@@ -23,6 +25,7 @@
 #include "dg/analysis/PointsTo/PointerSubgraph.h"
 #include "dg/analysis/PointsTo/PointerAnalysis.h"
 #include "dg/analysis/PointsTo/PointerSubgraphOptimizations.h"
+#include "dg/analysis/PointsTo/PointerAnalysisFI.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFSInv.h"
 
 #include "dg/llvm/analysis/PointsTo/LLVMPointerAnalysisOptions.h"
@@ -42,11 +45,17 @@ template <typename PTType>
 class LLVMPointerAnalysisImpl : public PTType
 {
     LLVMPointerSubgraphBuilder *builder;
+    // the number of replaced nodes that the builder knows about
+    size_t composedReplaced{0};
 
 public:
     LLVMPointerAnalysisImpl(PointerSubgraph *PS, LLVMPointerSubgraphBuilder *b)
     : PTType(PS), builder(b) {}
 
+    LLVMPointerAnalysisImpl(PointerSubgraph *PS, LLVMPointerSubgraphBuilder *b,
+                            const LLVMPointerAnalysisOptions& opts)
+    : PTType(PS, opts), builder(b) {}
+
     // build new subgraphs on calls via pointer
     bool functionPointerCall(PSNode *callsite, PSNode *called) override
     {
@@ -66,6 +75,9 @@ public:
         if (!LLVMPointerSubgraphBuilder::callIsCompatible(callsite, called))
             return false;
 
+        // the builder must not use the nodes replaced by the analysis
+        // as operands of the new nodes
+        composeReplacedNodes();
         builder->insertFunctionCall(callsite, called);
 
 #ifndef NDEBUG
@@ -81,12 +93,25 @@ public:
 
         return true; // we changed the graph
     }
+
+    // map the values to the nodes that replaced
+    // their nodes during the analysis (if any)
+    void composeReplacedNodes()
+    {
+        auto replaced = PTType::getReplacedNodes();
+        if (replaced.size() == composedReplaced)
+            return;
+
+        composedReplaced = replaced.size();
+        builder->composeMapping(std::move(replaced));
+    }
 };
 
 class LLVMPointerAnalysis
 {
     PointerSubgraph *PS = nullptr;
     std::unique_ptr<LLVMPointerSubgraphBuilder> _builder;
+    const LLVMPointerAnalysisOptions _options;
 
     LLVMPointerAnalysisOptions createOptions(const char *entry_func,
                                              uint64_t field_sensitivity)
@@ -105,7 +130,18 @@ public:
         : LLVMPointerAnalysis(m, createOptions(entry_func, field_sensitivity)) {}
 
     LLVMPointerAnalysis(const llvm::Module *m, const LLVMPointerAnalysisOptions opts)
-        : _builder(new LLVMPointerSubgraphBuilder(m, opts)) {}
+        : _builder(new LLVMPointerSubgraphBuilder(m, opts)), _options(opts) {}
+
+    const LLVMPointerAnalysisOptions& getOptions() const { return _options; }
+
+    // map the values to the nodes that replaced their nodes
+    // during the analysis (use with the analysis from createPTA())
+    void composeReplacedNodes(const analysis::pta::PointerAnalysis *PTA)
+    {
+        auto replaced = PTA->getReplacedNodes();
+        if (replaced.size() > 0)
+            _builder->composeMapping(std::move(replaced));
+    }
 
     PSNode *getPointsTo(const llvm::Value *val)
     {
@@ -130,7 +166,9 @@ public:
     PointerSubgraph *getPS() { return PS; }
     const PointerSubgraph *getPS() const { return PS; }
 
-    void buildSubgraph()
+    // build the pointer subgraph (and optimize it if requested).
+    // Some optimizations are valid only for flow-insensitive analysis
+    void buildSubgraph(bool flow_insensitive = false)
     {
         // run the analysis itself
         assert(_builder && "Incorrectly constructed PTA, missing builder");
@@ -141,47 +179,44 @@ public:
             abort();
         }
 
-/*
-        analysis::pta::PointerSubgraphOptimizer optimizer(PS);
-        optimizer.run();
-
-        if (optimizer.getNumOfRemovedNodes() > 0)
-            _builder->composeMapping(std::move(optimizer.getMapping()));
-
-        llvm::errs() << "PS optimization removed " << optimizer.getNumOfRemovedNodes() << " nodes\n";
+        if (_options.optimizeSubgraph) {
+            unsigned removed = _builder->optimizeSubgraph(flow_insensitive);
+#ifdef DEBUG_ENABLED
+            llvm::errs() << "PS optimization removed " << removed << " nodes\n";
+#endif
+            (void) removed;
 
 #ifndef NDEBUG
-        analysis::pta::debug::LLVMPointerSubgraphValidator validator(_builder->getPS());
-        if (validator.validate()) {
-            llvm::errs() << "Pointer Subgraph is broken!\n";
-            llvm::errs() << "This happend after optimizing the graph.";
-            assert(!validator.getErrors().empty());
-            llvm::errs() << validator.getErrors();
-            abort();
-        }
+            if (!_builder->validateSubgraph()) {
+                llvm::errs() << "Pointer Subgraph is broken!\n";
+                llvm::errs() << "This happend after optimizing the graph.\n";
+                abort();
+            }
 #endif // NDEBUG
-*/
-
+        }
     }
 
     template <typename PTType>
     void run()
     {
-        buildSubgraph();
+        buildSubgraph(std::is_base_of<analysis::pta::PointerAnalysisFI, PTType>::value);
 
-        LLVMPointerAnalysisImpl<PTType> PTA(PS, _builder.get());
+        LLVMPointerAnalysisImpl<PTType> PTA(PS, _builder.get(), _options);
         PTA.run();
+        PTA.composeReplacedNodes();
     }
 
     // this method creates PointerAnalysis object and returns it.
     // It is alternative to run() method, but it does not delete all
     // the analysis data as the run() (like memory objects and so on).
-    // run() preserves only PointerSubgraph and the builder
+    // run() preserves only PointerSubgraph and the builder.
+    // NOTE: the caller is responsible for calling composeReplacedNodes()
+    // after running the analysis
     template <typename PTType>
     analysis::pta::PointerAnalysis *createPTA()
     {
-        buildSubgraph();
-        return new LLVMPointerAnalysisImpl<PTType>(PS, _builder.get());
+        buildSubgraph(std::is_base_of<analysis::pta::PointerAnalysisFI, PTType>::value);
+        return new LLVMPointerAnalysisImpl<PTType>(PS, _builder.get(), _options);
     }
 };
 
@@ -193,8 +228,9 @@ inline void LLVMPointerAnalysis::run<analysis::pta::PointerAnalysisFSInv>()
     _builder->setInvalidateNodesFlag(true);
     buildSubgraph();
 
-    LLVMPointerAnalysisImpl<analysis::pta::PointerAnalysisFSInv> PTA(PS, _builder.get());
+    LLVMPointerAnalysisImpl<analysis::pta::PointerAnalysisFSInv> PTA(PS, _builder.get(), _options);
     PTA.run();
+    PTA.composeReplacedNodes();
 }
 
 template <>
@@ -205,7 +241,7 @@ inline analysis::pta::PointerAnalysis *LLVMPointerAnalysis::createPTA<analysis::
     _builder->setInvalidateNodesFlag(true);
     buildSubgraph();
 
-    return new LLVMPointerAnalysisImpl<analysis::pta::PointerAnalysisFSInv>(PS, _builder.get());
+    return new LLVMPointerAnalysisImpl<analysis::pta::PointerAnalysisFSInv>(PS, _builder.get(), _options);
 }
 
 } // namespace dg
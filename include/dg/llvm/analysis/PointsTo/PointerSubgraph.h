@@ -1,6 +1,7 @@
 #ifndef _LLVM_DG_POINTER_SUBGRAPH_H_
 #define _LLVM_DG_POINTER_SUBGRAPH_H_
 
+#include <set>
 #include <unordered_map>
 
 // ignore unused parameters in LLVM libraries
@@ -124,6 +125,13 @@ public:
 
     bool validateSubgraph(bool no_connectivity = false) const;
 
+    // Run the PointerSubgraphOptimizer on the built graph
+    // and update the mappings of LLVM values to the nodes.
+    // Keeps the nodes that are needed to extend the graph
+    // later (on calls via function pointers).
+    // \return the number of removed nodes
+    unsigned optimizeSubgraph(bool flow_insensitive = false);
+
     PSNodesSeq
     createFuncptrCall(const llvm::CallInst *CInst,
                       const llvm::Function *F);
@@ -218,6 +226,9 @@ private:
         setMapping(val, seq.second);
     }
 
+    // the nodes that must not be removed by optimizations
+    std::set<PSNode *> getPreservedNodes() const;
+
     bool isRelevantInstruction(const llvm::Instruction& Inst);
 
     PSNode *createAlloc(const llvm::Instruction *Inst);
@@ -84,6 +84,11 @@ public:
     RDNode *getRoot();
     RDNode *getNode(const llvm::Value *val);
 
+    const ReachingDefinitionsAnalysisStatistics& getStatistics() const {
+        assert(RDA);
+        return RDA->getStatistics();
+    }
+
     // let the user get the nodes map, so that we can
     // map the points-to informatio back to LLVM nodes
     const std::unordered_map<const llvm::Value *, RDNode *>& getNodesMap() const;
@@ -42,7 +42,11 @@ bool PointerAnalysis::processLoad(PSNode *node)
     if (operand->pointsTo.empty())
         return error(operand, "Load's operand has no points-to set");
 
-    for (const Pointer& ptr : operand->pointsTo) {
+    PointsToSetT newPtrs;
+    const PointsToSetT& ptrs = getNewPointers(node, 0, newPtrs) ?
+                                newPtrs : operand->pointsTo;
+
+    for (const Pointer& ptr : ptrs) {
         if (ptr.isUnknown()) {
             // load from unknown pointer yields unknown pointer
             changed |= node->addPointsTo(UNKNOWN_MEMORY);
@@ -264,13 +268,68 @@ bool PointerAnalysis::processMemcpy(std::vector<MemoryObject *>& srcObjects,
     return changed;
 }
 
+// store the pointers 'values' to the memory pointed by 'targets'
+bool PointerAnalysis::processStore(PSNode *node,
+                                   const PointsToSetT& targets,
+                                   const PointsToSetT& values)
+{
+    bool changed = false;
+    std::vector<MemoryObject *> objects;
+
+    if (values.empty())
+        return false;
+
+    for (const Pointer& ptr : targets) {
+        assert(ptr.target && "Got nullptr as target");
+
+        if (!canBeDereferenced(ptr))
+            continue;
+
+        objects.clear();
+        getMemoryObjects(node, ptr, objects);
+        for (MemoryObject *o : objects) {
+            for (const Pointer& to : values) {
+                changed |= o->addPointsTo(ptr.offset, to);
+            }
+        }
+    }
+
+    return changed;
+}
+
+bool PointerAnalysis::processStore(PSNode *node)
+{
+    PSNode *valNode = node->getOperand(0);
+    PSNode *ptrNode = node->getOperand(1);
+
+    PointsToSetT newTargets;
+    if (!getNewPointers(node, 1, newTargets))
+        return processStore(node, ptrNode->pointsTo, valNode->pointsTo);
+
+    // new targets get all the values and all the targets get
+    // the new values (the new values are stored to the new targets
+    // twice, but that is only adding what is already there)
+    PointsToSetT newValues;
+    getNewPointers(node, 0, newValues);
+
+    bool changed = false;
+    changed |= processStore(node, newTargets, valNode->pointsTo);
+    changed |= processStore(node, ptrNode->pointsTo, newValues);
+
+    return changed;
+}
+
 bool PointerAnalysis::processGep(PSNode *node) {
     bool changed = false;
 
     PSNodeGep *gep = PSNodeGep::get(node);
     assert(gep && "Non-GEP given");
 
-    for (const Pointer& ptr : gep->getSource()->pointsTo) {
+    PointsToSetT newPtrs;
+    const PointsToSetT& ptrs = getNewPointers(node, 0, newPtrs) ?
+                                newPtrs : gep->getSource()->pointsTo;
+
+    for (const Pointer& ptr : ptrs) {
         Offset::type new_offset;
         if (ptr.offset.isUnknown() || gep->getOffset().isUnknown())
             // set it like this to avoid overflow when adding
@@ -294,7 +353,6 @@ bool PointerAnalysis::processGep(PSNode *node) {
 bool PointerAnalysis::processNode(PSNode *node)
 {
     bool changed = false;
-    std::vector<MemoryObject *> objects;
 
 #ifdef DEBUG_ENABLED
     size_t prev_size = node->pointsTo.size();
@@ -305,20 +363,7 @@ bool PointerAnalysis::processNode(PSNode *node)
             changed |= processLoad(node);
             break;
         case PSNodeType::STORE:
-            for (const Pointer& ptr : node->getOperand(1)->pointsTo) {
-                assert(ptr.target && "Got nullptr as target");
-
-                if (!canBeDereferenced(ptr))
-                    continue;
-
-                objects.clear();
-                getMemoryObjects(node, ptr, objects);
-                for (MemoryObject *o : objects) {
-                    for (const Pointer& to : node->getOperand(0)->pointsTo) {
-                        changed |= o->addPointsTo(ptr.offset, to);
-                    }
-                }
-            }
+            changed |= processStore(node);
             break;
         case PSNodeType::INVALIDATE_OBJECT:
         case PSNodeType::FREE:
@@ -331,11 +376,14 @@ bool PointerAnalysis::processNode(PSNode *node)
         case PSNodeType::GEP:
             changed |= processGep(node);
             break;
-        case PSNodeType::CAST:
+        case PSNodeType::CAST: {
             // cast only copies the pointers
-            for (const Pointer& ptr : node->getOperand(0)->pointsTo)
-                changed |= node->addPointsTo(ptr);
-            break;
+            PointsToSetT newPtrs;
+            if (getNewPointers(node, 0, newPtrs))
+                changed |= node->addPointsTo(newPtrs);
+            else
+                changed |= node->addPointsTo(node->getOperand(0)->pointsTo);
+            } break;
         case PSNodeType::CONSTANT:
             // maybe warn? It has no sense to insert the constants into the graph.
             // On the other hand it is harmless. We can at least check if it is
@@ -421,6 +469,74 @@ bool PointerAnalysis::processNode(PSNode *node)
     return changed;
 }
 
+// can processing the node change the memory
+// (or the graph) and not only its points-to set?
+static inline bool changesMemory(PSNode *node)
+{
+    switch (node->getType()) {
+        case PSNodeType::STORE:
+        case PSNodeType::MEMCPY:
+        case PSNodeType::CALL_FUNCPTR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void PointerAnalysis::runWorklist()
+{
+    for (PSNode *n : to_process)
+        pushToWorklist(n);
+    to_process.clear();
+
+    bool first = true;
+    WorklistItem last(PS->getRoot());
+
+    while (!worklist.empty()) {
+        WorklistItem item = worklist.top();
+        worklist.pop();
+
+        PSNode *cur = item.node;
+        queued[cur->getID()] = false;
+
+        // going back in the topological order starts a new iteration
+        if (first || last < item)
+            ++statistics.iterations;
+        first = false;
+        last = item;
+
+        statistics.addProcessed(cur);
+
+        // the hooks change the memory (the state of the analysis),
+        // processNode changes the points-to set of the node
+        // or the memory on stores
+        bool memChanged = beforeProcessed(cur);
+        bool changed = processNode(cur);
+        bool after = afterProcessed(cur);
+        memChanged |= after;
+
+        if (!changed && !memChanged)
+            continue;
+
+        ++statistics.changedNodes;
+        pushUsersToWorklist(cur);
+
+        // the node has not seen the changes made after processing it
+        if (after)
+            pushToWorklist(cur);
+
+        if (memChanged || changesMemory(cur))
+            enqueueMemoryDependencies(cur);
+
+        // the call via function pointer may set the points-to set
+        // of the paired node directly (e.g. on calls of undefined functions)
+        if (cur->getType() == PSNodeType::CALL_FUNCPTR && cur->getPairedNode()) {
+            pushToWorklist(cur->getPairedNode());
+            pushUsersToWorklist(cur->getPairedNode());
+        }
+    }
+}
+
 void PointerAnalysis::sanityCheck() {
 #ifndef NDEBUG
     assert(NULLPTR->pointsTo.size() == 1
@@ -0,0 +1,410 @@
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <vector>
+
+#include "dg/analysis/ReachingDefinitions/RDMap.h"
+#include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
+
+namespace dg {
+namespace analysis {
+namespace rd {
+
+static bool comp_ds(const DefSite& a, const DefSite& b)
+{
+    return a.target < b.target;
+}
+
+static bool comp_target(const std::pair<RDNode *, std::shared_ptr<IntervalRDMap::TargetDefs>>& a,
+                        RDNode *b)
+{
+    return a.first < b;
+}
+
+// the last byte defined by the def-site with concrete offset,
+// definitions with unknown length span to the end of the memory
+static Offset::type intervalEnd(const DefSite& ds)
+{
+    assert(!ds.offset.isUnknown());
+    if (ds.len.isUnknown() || *ds.len >= Offset::UNKNOWN - *ds.offset)
+        return Offset::UNKNOWN - 1;
+
+    assert(*ds.len > 0 && "Interval of length 0 given");
+    return *ds.offset + *ds.len - 1;
+}
+
+static Offset intervalLength(const IntervalRDMap::IntervalsT::IntervalT& I)
+{
+    if (I.end == Offset::UNKNOWN - 1)
+        return Offset::UNKNOWN;
+    return I.length();
+}
+
+using DefSiteRange = std::pair<DefSiteSetT::const_iterator, DefSiteSetT::const_iterator>;
+
+// does some of the strong updates overwrite the whole memory?
+static bool overwritesWholeMemory(RDNode *target, const DefSiteRange& overwrites)
+{
+    for (auto I = overwrites.first; I != overwrites.second; ++I) {
+        const DefSite& ds2 = *I;
+        assert(ds2.target == target);
+        if (*ds2.offset == 0 && *ds2.len >= target->getSize())
+            return true;
+    }
+
+    return false;
+}
+
+// the bytes overwritten by the strong updates (sorted by the start)
+static std::vector<IntervalRDMap::IntervalsT::IntervalT>
+overwrittenIntervals(const DefSiteRange& overwrites)
+{
+    std::vector<IntervalRDMap::IntervalsT::IntervalT> ret;
+    for (auto it = overwrites.first; it != overwrites.second; ++it)
+        ret.emplace_back(*it->offset, intervalEnd(*it));
+
+    // the def-sites are sorted by the offset
+    return ret;
+}
+
+static void cropSets(IntervalRDMap::TargetDefs& defs, Offset::type max_set_size)
+{
+    if (defs.unknown.size() > max_set_size)
+        defs.unknown.makeUnknown();
+
+    for (auto& it : defs.intervals) {
+        if (it.second.size() > max_set_size)
+            it.second.makeUnknown();
+    }
+}
+
+// are the definitions of the target with unknown offset kept
+// when merging them through the strong updates?
+static bool keepsUnknown(RDNode *target, const DefSiteRange& overwrites,
+                         bool strong_update_unknown)
+{
+    // definitions with unknown offset are overwritten only
+    // if some strong update overwrites the whole memory
+    return !(overwrites.first != overwrites.second && strong_update_unknown &&
+             target->getSize() > 0 &&
+             overwritesWholeMemory(target, overwrites));
+}
+
+// are the definitions with concrete offsets filtered by the strong updates?
+static bool doesStrongUpdate(RDNode *target, const DefSiteRange& overwrites)
+{
+    // we don't want to do strong updates for heap allocated objects,
+    // since they are all represented by the call site. If we have
+    // a strong update with unknown offset, keep all the definitions
+    if (overwrites.first == overwrites.second ||
+        target->getType() == RDNodeType::DYN_ALLOC)
+        return false;
+
+    for (auto it = overwrites.first; it != overwrites.second; ++it) {
+        if (it->offset.isUnknown())
+            return false;
+    }
+
+    return true;
+}
+
+// would merging definitions of 'target' from 'from' to 'to'
+// (see mergeTarget) leave 'to' unchanged?
+static bool includesTarget(RDNode *target,
+                           const IntervalRDMap::TargetDefs& to,
+                           const IntervalRDMap::TargetDefs& from,
+                           const DefSiteRange& overwrites,
+                           bool strong_update_unknown,
+                           bool merge_unknown)
+{
+    bool keep_unknown = !from.unknown.empty() &&
+                        keepsUnknown(target, overwrites, strong_update_unknown);
+    if (keep_unknown && !includesValues(to.unknown, from.unknown))
+        return false;
+
+    // the definitions with concrete offsets would be moved
+    // to the definitions with unknown offset, that changes
+    // the definitions only if some of them are not there yet
+    if (merge_unknown && (keep_unknown || !to.unknown.empty())) {
+        for (const auto *intervals : {&to.intervals, &from.intervals}) {
+            for (const auto& it : *intervals) {
+                if (!includesValues(to.unknown, it.second))
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    if (doesStrongUpdate(target, overwrites))
+        return to.intervals.includesWithout(from.intervals,
+                                            overwrittenIntervals(overwrites));
+
+    return to.intervals.includes(from.intervals);
+}
+
+// merge definitions of 'target' from 'from' to 'to' with the same
+// semantics as BasicRDMap::merge, only the strong updates remove
+// exactly the overwritten bytes (not whole def-sites)
+static bool mergeTarget(RDNode *target,
+                        IntervalRDMap::TargetDefs& to,
+                        const IntervalRDMap::TargetDefs& from,
+                        const DefSiteRange& overwrites,
+                        bool strong_update_unknown,
+                        Offset::type max_set_size,
+                        bool merge_unknown)
+{
+    bool changed = false;
+
+    if (!from.unknown.empty() &&
+        keepsUnknown(target, overwrites, strong_update_unknown))
+        changed |= mergeValues(to.unknown, from.unknown);
+
+    if (doesStrongUpdate(target, overwrites)) {
+        // the overwritten bytes are not merged
+        changed |= to.intervals.mergeWithout(from.intervals,
+                                             overwrittenIntervals(overwrites));
+    } else {
+        changed |= to.intervals.merge(from.intervals);
+    }
+
+    // merge the definitions with concrete offsets
+    // to the definitions with unknown offset
+    if (merge_unknown && !to.unknown.empty() && !to.intervals.empty()) {
+        for (const auto& it : to.intervals)
+            changed |= mergeValues(to.unknown, it.second);
+        to.intervals = IntervalRDMap::IntervalsT();
+    }
+
+    // crop the sets to UNKNOWN_MEMORY if they are too big
+    // (but not if the target is unknown, see BasicRDMap::merge)
+    if (!target->isUnknown() && max_set_size != Offset::UNKNOWN)
+        cropSets(to, max_set_size);
+
+    return changed;
+}
+
+bool IntervalRDMap::merge(const IntervalRDMap *oth,
+                          DefSiteSetT *no_update,
+                          bool strong_update_unknown,
+                          Offset::type max_set_size,
+                          bool merge_unknown)
+{
+    if (this == oth || oth->_targets.empty())
+        return false;
+
+    bool changed = false;
+    // the targets that we do not have yet (sorted)
+    TargetsT added;
+
+    // both vectors are sorted, so merge them in one pass
+    auto I = _targets.begin();
+    for (const auto& it : oth->_targets) {
+        RDNode *target = it.first;
+        while (I != _targets.end() && I->first < target)
+            ++I;
+
+        // merging the same (shared) definitions changes nothing
+        if (I != _targets.end() && I->first == target && I->second == it.second)
+            continue;
+
+        static const DefSiteSetT no_overwrites;
+        DefSiteRange overwrites{no_overwrites.end(), no_overwrites.end()};
+        if (no_update)
+            overwrites = std::equal_range(no_update->begin(), no_update->end(),
+                                          DefSite(target), comp_ds);
+
+        if (I == _targets.end() || I->first != target) {
+            // we do not have this target yet
+            if (overwrites.first == overwrites.second && !merge_unknown) {
+                // just share the definitions
+                added.push_back(it);
+                changed |= !it.second->empty();
+            } else {
+                auto defs = std::make_shared<TargetDefs>();
+                changed |= mergeTarget(target, *defs, *it.second, overwrites,
+                                       strong_update_unknown, max_set_size,
+                                       merge_unknown);
+                if (!defs->empty())
+                    added.emplace_back(target, std::move(defs));
+            }
+
+            continue;
+        }
+
+        // copy the shared definitions only if they are going to change
+        if (includesTarget(target, *I->second, *it.second, overwrites,
+                           strong_update_unknown, merge_unknown))
+            continue;
+
+        if (I->second.use_count() > 1)
+            I->second = std::make_shared<TargetDefs>(*I->second);
+
+        changed |= mergeTarget(target, *I->second, *it.second, overwrites,
+                               strong_update_unknown, max_set_size,
+                               merge_unknown);
+    }
+
+    if (!added.empty()) {
+        size_t num = _targets.size();
+        _targets.insert(_targets.end(),
+                        std::make_move_iterator(added.begin()),
+                        std::make_move_iterator(added.end()));
+        std::inplace_merge(_targets.begin(), _targets.begin() + num,
+                           _targets.end(),
+                           [](const TargetsT::value_type& a,
+                              const TargetsT::value_type& b) {
+                               return a.first < b.first;
+                           });
+    }
+
+    return changed;
+}
+
+IntervalRDMap::TargetsT::const_iterator IntervalRDMap::_find(RDNode *target) const
+{
+    auto it = std::lower_bound(_targets.begin(), _targets.end(), target, comp_target);
+    if (it != _targets.end() && it->first == target)
+        return it;
+    return _targets.end();
+}
+
+IntervalRDMap::TargetDefs& IntervalRDMap::_getWritable(RDNode *target)
+{
+    auto it = std::lower_bound(_targets.begin(), _targets.end(), target, comp_target);
+    if (it == _targets.end() || it->first != target)
+        it = _targets.emplace(it, target, std::make_shared<TargetDefs>());
+    else if (it->second.use_count() > 1)
+        it->second = std::make_shared<TargetDefs>(*it->second);
+
+    return *it->second;
+}
+
+bool IntervalRDMap::add(const DefSite& ds, RDNode *n)
+{
+    TargetDefs& defs = _getWritable(ds.target);
+    if (ds.offset.isUnknown())
+        return defs.unknown.insert(n).second;
+
+    return defs.intervals.add(*ds.offset, intervalEnd(ds), n);
+}
+
+bool IntervalRDMap::update(const DefSite& ds, RDNode *n)
+{
+    TargetDefs& defs = _getWritable(ds.target);
+    if (ds.offset.isUnknown()) {
+        bool ret = defs.unknown.count(n) == 0 || defs.unknown.size() > 1;
+        defs.unknown.clear();
+        defs.unknown.insert(n);
+        return ret;
+    }
+
+    return defs.intervals.update(*ds.offset, intervalEnd(ds), n);
+}
+
+size_t IntervalRDMap::size() const
+{
+    size_t ret = 0;
+    for (const auto& it : _targets)
+        ret += it.second->size();
+
+    return ret;
+}
+
+size_t IntervalRDMap::get(RDNode *n, const Offset& off,
+                          const Offset& len, std::set<RDNode *>& ret) const
+{
+    return get(DefSite(n, off, len), ret);
+}
+
+size_t IntervalRDMap::get(const DefSite& ds, std::set<RDNode *>& ret) const
+{
+    auto it = _find(ds.target);
+    if (it == _targets.end())
+        return ret.size();
+
+    const TargetDefs& defs = *it->second;
+    // definitions with unknown offset may define any byte
+    ret.insert(defs.unknown.begin(), defs.unknown.end());
+
+    if (defs.intervals.empty())
+        return ret.size();
+
+    if (ds.offset.isUnknown()) {
+        for (const auto& I : defs.intervals)
+            ret.insert(I.second.begin(), I.second.end());
+    } else {
+        Offset::type end = intervalEnd(ds);
+        for (auto I = defs.intervals.le(*ds.offset, end);
+             I != defs.intervals.end() && I->first.start <= end; ++I) {
+            ret.insert(I->second.begin(), I->second.end());
+        }
+    }
+
+    return ret.size();
+}
+
+void IntervalRDMap::const_iterator::_skipEmpty()
+{
+    while (_it != _end) {
+        if (_atUnknown) {
+            if (!_it->second->unknown.empty())
+                return;
+
+            _atUnknown = false;
+            _interval = _it->second->intervals.begin();
+        }
+
+        if (_interval != _it->second->intervals.end())
+            return;
+
+        ++_it;
+        _atUnknown = true;
+    }
+}
+
+std::pair<DefSite, const IntervalRDMap::NodesT&>
+IntervalRDMap::const_iterator::operator*() const
+{
+    assert(_it != _end);
+    if (_atUnknown)
+        return {DefSite(_it->first), _it->second->unknown};
+
+    return {DefSite(_it->first, _interval->first.start,
+                    intervalLength(_interval->first)),
+            _interval->second};
+}
+
+IntervalRDMap::const_iterator& IntervalRDMap::const_iterator::operator++()
+{
+    assert(_it != _end);
+    if (_atUnknown) {
+        _atUnknown = false;
+        _interval = _it->second->intervals.begin();
+    } else {
+        ++_interval;
+    }
+
+    _skipEmpty();
+    return *this;
+}
+
+IntervalRDMap::IntervalRDMap(const BasicRDMap& o)
+{
+    for (const auto& it : o) {
+        for (RDNode *n : it.second)
+            add(it.first, n);
+    }
+}
+
+BasicRDMap::BasicRDMap(const IntervalRDMap& o)
+{
+    for (const auto& it : o) {
+        for (RDNode *n : it.second)
+            add(it.first, n);
+    }
+}
+
+} // rd
+} // analysis
+} // dg
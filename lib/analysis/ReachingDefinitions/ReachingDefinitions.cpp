@@ -1,4 +1,10 @@
+#include <algorithm>
+#include <functional>
+#include <queue>
 #include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "dg/analysis/ReachingDefinitions/RDMap.h"
 #include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
@@ -10,26 +16,245 @@ namespace rd {
 RDNode UNKNOWN_MEMLOC;
 RDNode *UNKNOWN_MEMORY = &UNKNOWN_MEMLOC;
 
-bool ReachingDefinitionsAnalysis::processNode(RDNode *node)
+template <typename MapT>
+static bool mergeMaps(MapT& to, const MapT& from, DefSiteSetT *overwrites,
+                      const ReachingDefinitionsAnalysisOptions& options)
+{
+    return to.merge(&from,
+                    overwrites /* strong update */,
+                    options.strongUpdateUnknown,
+                    *options.maxSetSize, /* max size of set of reaching definition
+                                            of one definition site */
+                    false /* merge unknown */);
+}
+
+// RDMap is the map of RDNode, so the analysis
+// works directly with the maps of the nodes
+struct NodeRDMaps {
+    RDMap& operator[](RDNode *n) { return n->def_map; }
+
+    // the definitions are already in the nodes
+    void store(RDNode *) {}
+    void store() {}
+};
+
+// the maps of other types are kept aside and the definitions
+// are copied to the maps of the nodes when they are computed
+template <typename MapT>
+class SideRDMaps {
+    std::unordered_map<RDNode *, MapT> _maps;
+
+public:
+    MapT& operator[](RDNode *n) {
+        auto it = _maps.find(n);
+        if (it == _maps.end()) {
+            // start from the definitions that the node has now
+            // (its own definitions if it was not computed yet)
+            it = _maps.emplace(n, MapT(n->def_map)).first;
+        }
+
+        return it->second;
+    }
+
+    void store(RDNode *n) {
+        auto it = _maps.find(n);
+        if (it != _maps.end())
+            n->def_map = RDMap(it->second);
+    }
+
+    void store() {
+        for (auto& it : _maps)
+            it.first->def_map = RDMap(it.second);
+    }
+};
+
+// computes the reaching definitions of the nodes in a block
+// with the same maps as the analysis that created the block
+template <typename MapsT>
+struct RDBBlockResolver : public RDBBlock {
+    RDBBlockResolver(const ReachingDefinitionsAnalysisOptions *opts)
+    : RDBBlock(opts) {}
+
+    // compute the reaching definitions of the node and of the preceding
+    // nodes in the block that were not computed yet
+    void resolve(RDNode *n) override;
+};
+
+template <typename MapsT>
+bool ReachingDefinitionsAnalysis::mergeMaps(MapsT& maps, RDNode *node, RDNode *pred)
+{
+    ++statistics.merges;
+    return rd::mergeMaps(maps[node], maps[pred],
+                         &node->overwrites, options);
+}
+
+template <typename MapsT>
+void RDBBlockResolver<MapsT>::resolve(RDNode *n)
+{
+    assert(n->resolver == this && "The node is not resolved by this block");
+    auto it = std::find(nodes.begin(), nodes.end(), n);
+    assert(it != nodes.end() && "The node is not in the block");
+    assert(n != getLastNode() && "The last node has the definitions");
+
+    // start from the closest preceding node that has the reaching
+    // definitions computed or from the beginning of the block
+    auto start = it;
+    while (start != nodes.begin() && (*(start - 1))->resolver)
+        --start;
+
+    // def_map of the nodes that were not computed yet contains only
+    // the definitions of the node itself. Merge the definitions
+    // of the predecessor into it, so every node on the way keeps
+    // its result and does not need to be computed again.
+    MapsT maps;
+    for (;; ++start) {
+        RDNode *cur = *start;
+        if (start == nodes.begin()) {
+            // the predecessors of the first node are the last nodes
+            // of other blocks (or nodes unreachable from the root)
+            for (RDNode *pred : cur->getPredecessors())
+                mergeMaps(maps[cur], maps[pred],
+                          &cur->overwrites, *options);
+        } else {
+            mergeMaps(maps[cur], maps[*(start - 1)],
+                      &cur->overwrites, *options);
+        }
+
+        maps.store(cur);
+        cur->resolver = nullptr;
+        if (start == it)
+            break;
+    }
+}
+
+template <typename MapsT>
+bool ReachingDefinitionsAnalysis::processNode(MapsT& maps, RDNode *node)
 {
     bool changed = false;
 
     // merge maps from predecessors
     for (RDNode *n : node->predecessors)
-        changed |= node->def_map.merge(&n->def_map,
-                                       &node->overwrites /* strong update */,
-                                       options.strongUpdateUnknown,
-                                       *options.maxSetSize, /* max size of set of reaching definition
-                                                              of one definition site */
-                                       false /* merge unknown */);
+        changed |= mergeMaps(maps, node, n);
 
     return changed;
 }
 
-void ReachingDefinitionsAnalysis::run()
+bool ReachingDefinitionsAnalysis::processNode(RDNode *node)
+{
+    NodeRDMaps maps;
+    return processNode(maps, node);
+}
+
+std::vector<RDNode *> ReachingDefinitionsAnalysis::getNodesRPO()
 {
     assert(root && "Do not have root");
 
+    ++dfsnum;
+
+    std::vector<RDNode *> postorder;
+    // the node and the index of the next successor to visit
+    std::vector<std::pair<RDNode *, size_t>> stack;
+    stack.emplace_back(root, 0);
+    root->dfsid = dfsnum;
+
+    while (!stack.empty()) {
+        RDNode *cur = stack.back().first;
+        size_t& idx = stack.back().second;
+
+        if (idx < cur->successors.size()) {
+            RDNode *succ = cur->successors[idx++];
+            if (succ->dfsid != dfsnum) {
+                succ->dfsid = dfsnum;
+                stack.emplace_back(succ, 0);
+            }
+        } else {
+            postorder.push_back(cur);
+            stack.pop_back();
+        }
+    }
+
+    std::reverse(postorder.begin(), postorder.end());
+    return postorder;
+}
+
+template <typename MapsT>
+void ReachingDefinitionsAnalysis::runWorklist(MapsT& maps)
+{
+    std::vector<RDNode *> nodes = getNodesRPO();
+
+    // the position of the nodes in the reverse postorder
+    std::unordered_map<RDNode *, unsigned> order;
+    order.reserve(nodes.size());
+    for (unsigned i = 0; i < nodes.size(); ++i)
+        order[nodes[i]] = i;
+
+    // the predecessors whose maps changed since the node
+    // has been processed the last time (per position in RPO)
+    std::vector<std::vector<RDNode *>> changedPreds(nodes.size());
+    std::vector<bool> processed(nodes.size(), false);
+
+    // the worklist, the node with the lowest position goes first
+    std::vector<bool> queued(nodes.size(), true);
+    std::priority_queue<unsigned, std::vector<unsigned>,
+                        std::greater<unsigned>> worklist;
+    for (unsigned i = 0; i < nodes.size(); ++i)
+        worklist.push(i);
+
+    unsigned last = 0;
+    while (!worklist.empty()) {
+        unsigned idx = worklist.top();
+        worklist.pop();
+        queued[idx] = false;
+
+        if (idx <= last)
+            ++statistics.iterations;
+        last = idx;
+
+        RDNode *cur = nodes[idx];
+        ++statistics.processedNodes;
+
+        bool changed = false;
+        if (!processed[idx]) {
+            // the first visit, merge all the predecessors
+            // (also the ones that are not reachable from the root)
+            processed[idx] = true;
+            changed = processNode(maps, cur);
+        } else {
+            for (RDNode *pred : changedPreds[idx])
+                changed |= mergeMaps(maps, cur, pred);
+        }
+        changedPreds[idx].clear();
+
+        if (!changed)
+            continue;
+
+        ++statistics.changedNodes;
+        // an unchanged map was already accounted for
+        statistics.updateMaxSizes(maps[cur]);
+
+        for (RDNode *succ : cur->successors) {
+            assert(order.count(succ) > 0 && "Successor not in RPO");
+            unsigned sidx = order[succ];
+            // the first visit merges all the predecessors anyway
+            // (the successor is still in the worklist)
+            if (!processed[sidx])
+                continue;
+
+            auto& preds = changedPreds[sidx];
+            if (std::find(preds.begin(), preds.end(), cur) == preds.end())
+                preds.push_back(cur);
+
+            if (!queued[sidx]) {
+                queued[sidx] = true;
+                worklist.push(sidx);
+            }
+        }
+    }
+}
+
+template <typename MapsT>
+void ReachingDefinitionsAnalysis::runIterative(MapsT& maps)
+{
     std::vector<RDNode *> to_process = getNodes(root);
     std::vector<RDNode *> changed;
 
@@ -37,12 +262,18 @@ void ReachingDefinitionsAnalysis::run()
     do {
         unsigned last_processed_num = to_process.size();
         changed.clear();
+        ++statistics.iterations;
 
         for (RDNode *cur : to_process) {
-            if (processNode(cur))
+            ++statistics.processedNodes;
+            if (processNode(maps, cur)) {
                 changed.push_back(cur);
+                statistics.updateMaxSizes(maps[cur]);
+            }
         }
 
+        statistics.changedNodes += changed.size();
+
         if (!changed.empty()) {
             to_process.clear();
             to_process = getNodes(nullptr /* starting node */,
@@ -56,6 +287,164 @@ void ReachingDefinitionsAnalysis::run()
     } while (!changed.empty());
 }
 
+template <typename MapsT>
+void ReachingDefinitionsAnalysis::buildBlocks(MapsT& maps,
+                                              const std::vector<RDNode *>& nodes)
+{
+    std::unordered_map<RDNode *, RDBBlock *> blockOf;
+    blockOf.reserve(nodes.size());
+
+    for (RDNode *n : nodes) {
+        RDBBlock *block = nullptr;
+        // the node continues the block of its predecessor if there
+        // is no branching between them. The predecessor precedes
+        // the node in the reverse postorder, so its block exists.
+        if (n != root && n->predecessors.size() == 1) {
+            RDNode *pred = n->predecessors[0];
+            if (pred != n && pred->successors.size() == 1) {
+                auto it = blockOf.find(pred);
+                if (it != blockOf.end())
+                    block = it->second;
+            }
+        }
+
+        if (!block) {
+            blocks.emplace_back(new RDBBlockResolver<MapsT>(&options));
+            block = blocks.back().get();
+        }
+
+        assert(block->nodes.empty() || block->getLastNode()->successors[0] == n);
+        block->nodes.push_back(n);
+        blockOf[n] = block;
+    }
+
+    for (auto& block : blocks) {
+        // the definitions generated by the block
+        auto gen = maps[block->getFirstNode()];
+        block->kills = block->getFirstNode()->overwrites;
+
+        for (size_t i = 1; i < block->nodes.size(); ++i) {
+            RDNode *cur = block->nodes[i];
+            // only the definitions of the node are copied
+            auto tmp = maps[cur];
+            rd::mergeMaps(tmp, gen, &cur->overwrites, options);
+            gen = std::move(tmp);
+
+            block->kills.insert(cur->overwrites.begin(), cur->overwrites.end());
+            // the reaching definitions of this node
+            // are computed on demand
+            block->nodes[i - 1]->resolver = block.get();
+        }
+
+        maps[block->getLastNode()] = std::move(gen);
+    }
+}
+
+template <typename MapsT>
+void ReachingDefinitionsAnalysis::runBlocks(MapsT& maps)
+{
+    std::vector<RDNode *> nodes = getNodesRPO();
+    buildBlocks(maps, nodes);
+
+    // the blocks are created in the reverse postorder
+    // of their first nodes
+    std::unordered_map<RDNode *, unsigned> order;
+    order.reserve(blocks.size());
+    for (unsigned i = 0; i < blocks.size(); ++i)
+        order[blocks[i]->getFirstNode()] = i;
+
+    std::vector<std::vector<RDNode *>> changedPreds(blocks.size());
+    std::vector<bool> processed(blocks.size(), false);
+
+    std::vector<bool> queued(blocks.size(), true);
+    std::priority_queue<unsigned, std::vector<unsigned>,
+                        std::greater<unsigned>> worklist;
+    for (unsigned i = 0; i < blocks.size(); ++i)
+        worklist.push(i);
+
+    unsigned last = 0;
+    while (!worklist.empty()) {
+        unsigned idx = worklist.top();
+        worklist.pop();
+        queued[idx] = false;
+
+        if (idx <= last)
+            ++statistics.iterations;
+        last = idx;
+
+        RDBBlock *block = blocks[idx].get();
+        RDNode *cur = block->getLastNode();
+        ++statistics.processedNodes;
+
+        bool changed = false;
+        auto mergeBlock = [&](RDNode *pred) {
+            ++statistics.merges;
+            return rd::mergeMaps(maps[cur], maps[pred],
+                                 &block->kills, options);
+        };
+
+        if (!processed[idx]) {
+            processed[idx] = true;
+            for (RDNode *pred : block->getFirstNode()->predecessors)
+                changed |= mergeBlock(pred);
+        } else {
+            for (RDNode *pred : changedPreds[idx])
+                changed |= mergeBlock(pred);
+        }
+        changedPreds[idx].clear();
+
+        if (!changed)
+            continue;
+
+        ++statistics.changedNodes;
+        // an unchanged map was already accounted for
+        statistics.updateMaxSizes(maps[cur]);
+
+        for (RDNode *succ : cur->successors) {
+            // the successors of the last node are first nodes of blocks
+            assert(order.count(succ) > 0 && "Successor not in RPO");
+            unsigned sidx = order[succ];
+            if (!processed[sidx])
+                continue;
+
+            auto& preds = changedPreds[sidx];
+            if (std::find(preds.begin(), preds.end(), cur) == preds.end())
+                preds.push_back(cur);
+
+            if (!queued[sidx]) {
+                queued[sidx] = true;
+                worklist.push(sidx);
+            }
+        }
+    }
+}
+
+template <typename MapsT>
+void ReachingDefinitionsAnalysis::runDense()
+{
+    MapsT maps;
+
+    if (options.blocks)
+        runBlocks(maps);
+    else if (options.worklist)
+        runWorklist(maps);
+    else
+        runIterative(maps);
+
+    maps.store();
+}
+
+void ReachingDefinitionsAnalysis::run()
+{
+    assert(root && "Do not have root");
+
+    // choose the maps once, the analysis is instantiated for each of them
+    if (options.intervalMaps)
+        runDense<SideRDMaps<IntervalRDMap>>();
+    else
+        runDense<NodeRDMaps>();
+}
+
 } // namespace rd
 } // namespace analysis
 } // namespace dg
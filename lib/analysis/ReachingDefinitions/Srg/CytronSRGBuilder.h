@@ -44,7 +44,7 @@ private:
         oldLHS[assignment].push_back(var);
 
         if (!stacks[var.target].empty()) {
-            srg[stacks[var.target].top()].push_back(std::make_pair(var, assignment));
+            srg.addEdge(stacks[var.target].top(), var, assignment);
         }
 
         stacks[var.target].push(assignment);
@@ -53,7 +53,7 @@ private:
     void addUse(NodeT *use, const VarT& var)
     {
         if (!stacks[var.target].empty())
-            srg[stacks[var.target].top()].push_back(std::make_pair(var, use));
+            srg.addEdge(stacks[var.target].top(), var, use);
     }
 
     void search(BlockT *X)
@@ -124,6 +124,7 @@ public:
 
         // now recursively construct the SparseRDGraph
         constructSrg(root->getBBlock());
+        srg.compact();
 
         return std::make_pair(std::move(srg), std::move(phi_nodes));
     }
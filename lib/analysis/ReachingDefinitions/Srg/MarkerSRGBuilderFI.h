@@ -36,7 +36,7 @@ class MarkerSRGBuilderFI : public SparseRDGraphBuilder
     void addPhiOperands(const DefSite& var, NodeT *phi, BlockT *block);
 
     void insertSrgEdge(NodeT *from, NodeT *to, const DefSite& var) {
-        srg[from].push_back(std::make_pair(var, to));
+        srg.addEdge(from, var, to);
     }
 
     void performLvn(BlockT *block) {
@@ -93,6 +93,7 @@ public:
             performGvn(BB);
         }
 
+        srg.compact();
         return std::make_pair<SparseRDGraph, std::vector<std::unique_ptr<NodeT>>>(std::move(srg), std::move(phi_nodes));
     }
 
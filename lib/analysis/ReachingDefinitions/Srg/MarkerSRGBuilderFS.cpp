@@ -84,15 +84,14 @@ MarkerSRGBuilderFS::NodeT *MarkerSRGBuilderFS::addPhiOperands(const DefSite& var
 }
 
 MarkerSRGBuilderFS::NodeT* MarkerSRGBuilderFS::tryRemoveTrivialPhi(NodeT *phi) {
-    auto operands = srg.find(phi);
     // is @phi undef?
-    if (operands == srg.end()) {
+    if (!srg.contains(phi)) {
         return phi;
     }
 
     NodeT *same = nullptr;
     // is phi node non-trivial?
-    for (auto& edge : operands->second) {
+    for (auto& edge : srg.edges(phi)) {
          NodeT* dest = edge.second;
         if (dest == same || dest == phi) {
             continue;
@@ -109,13 +108,13 @@ MarkerSRGBuilderFS::NodeT* MarkerSRGBuilderFS::tryRemoveTrivialPhi(NodeT *phi) {
 
     replacePhi(phi, same);
 
-    auto users_it = reverse_srg.find(phi);
-    if (users_it == reverse_srg.end()) {
+    auto users_range = srg.reverseEdges(phi);
+    if (users_range.empty()) {
         // no users...
         return phi;
     }
 
-    auto users = users_it->second;
+    std::vector<SRGEdge> users(users_range.begin(), users_range.end());
     for (auto& edge : users) {
         NodeT* user = edge.second;
         if (user != phi && user->getType() == RDNodeType::PHI) {
@@ -128,24 +127,27 @@ MarkerSRGBuilderFS::NodeT* MarkerSRGBuilderFS::tryRemoveTrivialPhi(NodeT *phi) {
 
 void MarkerSRGBuilderFS::replacePhi(NodeT *phi, NodeT *replacement) {
     // the purpose of this method is to reroute definitions to uses
-    auto uses_it = reverse_srg.find(phi);
+    auto uses_range = srg.reverseEdges(phi);
 
-    if (uses_it == reverse_srg.end() || uses_it->second.size() == 0) {
+    if (uses_range.empty()) {
         // there is nothing to transplant
         return;
     }
 
-    auto defs_it = srg.find(phi);
-    if (defs_it != srg.end()) {
-        auto& defs = defs_it->second;
-        for (auto& def_edge : defs) {
-            DefSite& var = def_edge.first;
-            NodeT *dest = def_edge.second;
-            removeSrgEdge(phi, dest, var);
-        }
+    // the edges are removed while we iterate, so iterate over copies
+    auto defs_range = srg.edges(phi);
+    std::vector<SRGEdge> defs(defs_range.begin(), defs_range.end());
+
+    for (auto& def_edge : defs) {
+        DefSite& var = def_edge.first;
+        NodeT *dest = def_edge.second;
+        removeSrgEdge(phi, dest, var);
     }
 
-    auto uses = uses_it->second;
+    // take the uses only now, removing the definitions may have
+    // removed some of them (if the phi is on a cycle)
+    uses_range = srg.reverseEdges(phi);
+    std::vector<SRGEdge> uses(uses_range.begin(), uses_range.end());
 
     for (auto& use_edge : uses) {
         DefSite var = use_edge.first;
@@ -29,10 +29,9 @@ class MarkerSRGBuilderFS : public SparseRDGraphBuilder
     // for each variable { for each block { for each offset in variable { remember definition } } }
     using DefMapT = std::unordered_map<NodeT *, std::unordered_map<BlockT *, detail::IntervalMap<NodeT *>>>;
 
-    /* the resulting graph - stored in class for convenience, moved away on return */
-    SparseRDGraph srg;
-    /* reverse srg is remembered for convenience, it never leaves this class */
-    SparseRDGraph reverse_srg;
+    /* the resulting graph - stored in class for convenience, moved away on return.
+     * The reversed edges are kept for convenience, they are dropped on return */
+    SparseRDGraph srg{true /* keep reversed edges */, true /* removable */};
 
     /* phi nodes added during the process */
     std::vector<std::unique_ptr<NodeT>> phi_nodes;
@@ -105,22 +104,11 @@ class MarkerSRGBuilderFS : public SparseRDGraphBuilder
      * @to is a use
      */
     void insertSrgEdge(NodeT *from, NodeT *to, const DefSite& var) {
-        srg[to].push_back(std::make_pair(var, from));
-        reverse_srg[from].push_back(std::make_pair(var, to));
+        srg.addEdge(to, var, from);
     }
 
     void removeSrgEdge(NodeT *from, NodeT *to, const DefSite& var) {
-        auto& to_vec = srg[to];
-        auto it = std::find(to_vec.begin(), to_vec.end(), std::make_pair(var, from));
-        if (it != to_vec.end()) {
-            to_vec.erase(it);
-        }
-
-        auto& from_vec = reverse_srg[from];
-        auto reverse_it = std::find(from_vec.begin(), from_vec.end(), std::make_pair(var, to));
-        if (reverse_it != from_vec.end()) {
-            from_vec.erase(reverse_it);
-        }
+        srg.removeEdge(to, var, from);
     }
 
     void performLvn(BlockT *block) {
@@ -184,6 +172,7 @@ public:
             performGvn(BB);
         }
 
+        srg.compact();
         return std::make_pair<SparseRDGraph, std::vector<std::unique_ptr<NodeT>>>(std::move(srg), std::move(phi_nodes));
     }
 
@@ -3,62 +3,178 @@
 #include "analysis/ReachingDefinitions/Srg/MarkerSRGBuilderFS.h"
 #include "analysis/ReachingDefinitions/Srg/SparseRDGraphBuilder.h"
 
-#include <unordered_set>
+#include <algorithm>
 
 namespace dg {
 namespace analysis {
 namespace rd {
 
 using SrgBuilder = dg::analysis::rd::srg::MarkerSRGBuilderFS;
-using SparseRDGraph = dg::analysis::rd::srg::SparseRDGraph;
-
-template< typename T >
-static void bfs(RDNode *from, SparseRDGraph& srg, T&& visitor) {
-    std::unordered_set<RDNode *> visited;
-    std::queue<RDNode *> q;
-    q.push(from);
-    visited.insert(from);
-
-    while (!q.empty()) {
-        RDNode *n = q.front();
-        q.pop();
-        auto edges_it = srg.find(n);
-        if (edges_it != srg.end()) {
-            auto& edges = edges_it->second;
-            for (auto& edge : edges) {
-                RDNode *src = edge.second;
-                if (visited.insert(src).second) {
-                    visitor(edge.first, edge.second);
-                    q.push(src);
+
+const unsigned SemisparseRda::NO_COMPONENT;
+
+// Tarjan's algorithm on the SRG with the edges reversed (from the nodes
+// to the definitions), so the components are finished in the order
+// in which their edges can be computed. The nodes are identified
+// by their IDs in the SRG, the index 0 means not visited.
+void SemisparseRda::resolveComponents(unsigned from)
+{
+    std::vector<unsigned> scc_stack;
+    // the node and the next edge to visit
+    std::vector<std::pair<unsigned, SrgT::edge_iterator>> stack;
+
+    auto visit = [&](unsigned n) {
+        tarjan_index[n] = tarjan_next_index;
+        tarjan_lowlink[n] = tarjan_next_index;
+        ++tarjan_next_index;
+        scc_stack.push_back(n);
+        tarjan_on_stack[n] = true;
+        stack.emplace_back(n, srg.edges(n).begin());
+    };
+
+    visit(from);
+    while (!stack.empty()) {
+        unsigned cur = stack.back().first;
+        auto& it = stack.back().second;
+
+        if (it != srg.edges(cur).end()) {
+            unsigned src = srg.getId(it->second);
+            ++it;
+            if (component[src] != NO_COMPONENT)
+                continue;
+
+            if (tarjan_index[src] == 0) {
+                visit(src);
+            } else if (tarjan_on_stack[src]) {
+                tarjan_lowlink[cur] = std::min(tarjan_lowlink[cur],
+                                               tarjan_index[src]);
+            }
+            continue;
+        }
+
+        stack.pop_back();
+        if (!stack.empty()) {
+            unsigned parent = stack.back().first;
+            tarjan_lowlink[parent] = std::min(tarjan_lowlink[parent],
+                                              tarjan_lowlink[cur]);
+        }
+
+        if (tarjan_lowlink[cur] != tarjan_index[cur])
+            continue;
+
+        // 'cur' is the root of a component, pop the component
+        unsigned comp = reaching.size();
+        unsigned refs = 0;
+        auto first = std::find(scc_stack.rbegin(), scc_stack.rend(), cur).base() - 1;
+        for (auto I = first; I != scc_stack.end(); ++I) {
+            component[*I] = comp;
+            tarjan_on_stack[*I] = false;
+            refs += node_references[*I];
+        }
+        references.push_back(refs);
+
+        // the edges of the component and the edges
+        // reaching the components that it depends on
+        std::vector<SrgEdgeT> result;
+        std::vector<unsigned> read;
+        for (auto I = first; I != scc_stack.end(); ++I) {
+            for (const SrgEdgeT& edge : srg.edges(*I)) {
+                result.push_back(edge);
+                unsigned src_comp = component[srg.getId(edge.second)];
+                read.push_back(src_comp);
+                if (src_comp != comp) {
+                    const auto& src_edges = reaching[src_comp];
+                    result.insert(result.end(), src_edges.begin(), src_edges.end());
                 }
             }
         }
-        visited.insert(n);
+
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        result.shrink_to_fit();
+        reaching.push_back(std::move(result));
+
+        // the edges of the components were copied, release them
+        // (this may release also the new component if nothing
+        // needs its edges anymore)
+        for (unsigned src_comp : read)
+            release(src_comp);
+        if (references[comp] == 0)
+            release(comp);
+
+        scc_stack.erase(first, scc_stack.end());
+    }
+}
+
+void SemisparseRda::release(unsigned comp)
+{
+    if (references[comp] > 0 && --references[comp] > 0)
+        return;
+
+    std::vector<SrgEdgeT>().swap(reaching[comp]);
+}
+
+const std::vector<SemisparseRda::SrgEdgeT>&
+SemisparseRda::getReachingEdges(RDNode *n)
+{
+    static const std::vector<SrgEdgeT> no_edges;
+    if (!srg.contains(n))
+        return no_edges;
+
+    unsigned id = srg.getId(n);
+    if (component[id] == NO_COMPONENT) {
+        resolveComponents(id);
+        assert(component[id] != NO_COMPONENT);
+    }
+
+    return reaching[component[id]];
+}
+
+void SemisparseRda::resolve(RDNode *n)
+{
+    for (const SrgEdgeT& edge : getReachingEdges(n)) {
+        RDNode *def = edge.second;
+        if (def != n && def->getType() != RDNodeType::PHI) {
+            DefSite var = edge.first;
+            merge_maps(def, n, var);
+        }
     }
+
+    if (srg.contains(n))
+        release(component[srg.getId(n)]);
+    n->resolver = nullptr;
 }
 
 void SemisparseRda::run()
 {
     SrgBuilder srg_builder;
-    SparseRDGraph srg;
-
-    std::unordered_set<RDNode *> to_process;
     std::tie(srg, phi_nodes) = srg_builder.build(root);
 
-    for (auto& pair : srg) {
-        RDNode *dest = pair.first;
+    component.assign(srg.size(), NO_COMPONENT);
+    tarjan_index.assign(srg.size(), 0);
+    tarjan_lowlink.assign(srg.size(), 0);
+    tarjan_on_stack.assign(srg.size(), false);
+
+    node_references.assign(srg.size(), 0);
+    std::vector<RDNode *> to_resolve;
+    for (RDNode *dest : srg.getNodes()) {
+        for (const SrgEdgeT& edge : srg.edges(srg.getId(dest)))
+            ++node_references[srg.getId(edge.second)];
+
         if (dest->getUses().size() > 0 && dest->getType() != RDNodeType::PHI) {
-            bfs(dest, srg, [&](DefSite& ds, RDNode *n){
-                if (n->getType() != RDNodeType::PHI) {
-                    merge_maps(n, dest, ds);
-                }
-            });
+            dest->resolver = this;
+            ++node_references[srg.getId(dest)];
+            to_resolve.push_back(dest);
         }
     }
+
+    if (options.onDemand)
+        return;
+
+    for (RDNode *dest : to_resolve)
+        resolve(dest);
 }
 
 } // namespace rd
 } // namespace analysis
 } // namespace dg
-
-
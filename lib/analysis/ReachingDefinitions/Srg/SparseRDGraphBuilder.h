@@ -8,6 +8,7 @@
 
 #include "dg/BBlock.h"
 #include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
+#include "dg/analysis/ReachingDefinitions/SparseRDGraph.h"
 
 #include "analysis/ReachingDefinitions/Srg/PhiPlacement.h"
 
@@ -30,10 +31,7 @@ public:
     // just for convenience
     template <typename _Tp> using StackT = std::stack<_Tp, std::vector<_Tp>>;
 
-    using SRGEdge = std::pair<VarT, NodeT*>;
-    // neighbour lists representation of Sparse Graph
-    //                                       ALLOCA             pair(Variable, Def/Use)
-    using SparseRDGraph = std::unordered_map<NodeT *, std::vector<SRGEdge>>;
+    using SRGEdge = SparseRDGraph::EdgeT;
 
     virtual ~SparseRDGraphBuilder() = default;
 
@@ -46,8 +44,6 @@ public:
 
 };
 
-using SparseRDGraph = SparseRDGraphBuilder::SparseRDGraph;
-
 }
 }
 }
@@ -61,6 +61,7 @@ private:
     LLVMPointerAnalysis *PTA;
     LLVMReachingDefinitions *RD;
     const std::set<LLVMNode *> *criteria;
+    const LLVMDependenceGraph *dg;
     std::string module_comment{};
 
     void printValue(const llvm::Value *val,
@@ -148,8 +149,8 @@ private:
                 os << "  ; RD: no mapping\n";
             } else {
                 auto& defs = rd->getReachingDefinitions();
-                for (auto& it : defs) {
-                    for (auto& nd : it.second) {
+                for (const auto& it : defs) {
+                    for (analysis::rd::RDNode *nd : it.second) {
                         printDefSite(it.first, os, "RD: ");
                         os << " @ ";
                         if (nd->isUnknown())
@@ -249,12 +250,16 @@ private:
     }
 
 public:
-    LLVMDGAssemblyAnnotationWriter(AnnotationOptsT o = ANNOTATE_SLICE,
+    // 'dg' is the graph whose nodes are annotated
+    // (the graphs of all the functions are searched for the nodes)
+    LLVMDGAssemblyAnnotationWriter(const LLVMDependenceGraph *dg,
+                                   AnnotationOptsT o = ANNOTATE_SLICE,
                                    LLVMPointerAnalysis *pta = nullptr,
                                    LLVMReachingDefinitions *rd = nullptr,
                                    const std::set<LLVMNode *>* criteria = nullptr)
-        : opts(o), PTA(pta), RD(rd), criteria(criteria)
+        : opts(o), PTA(pta), RD(rd), criteria(criteria), dg(dg)
     {
+        assert(dg && "Need the dependence graph");
         assert(!(opts & ANNOTATE_PTR) || PTA);
         assert(!(opts & ANNOTATE_RD) || RD);
     }
@@ -286,7 +291,7 @@ public:
             return;
 
         LLVMNode *node = nullptr;
-        for (auto& it : getConstructedFunctions()) {
+        for (auto& it : dg->getConstructedFunctions()) {
             LLVMDependenceGraph *sub = it.second;
             node = sub->getNode(const_cast<llvm::Instruction *>(I));
             if (node)
@@ -305,7 +310,7 @@ public:
         if (opts == 0)
             return;
 
-        for (auto& it : getConstructedFunctions()) {
+        for (auto& it : dg->getConstructedFunctions()) {
             LLVMDependenceGraph *sub = it.second;
             auto& cb = sub->getBlocks();
             auto I = cb.find(const_cast<llvm::BasicBlock *>(B));
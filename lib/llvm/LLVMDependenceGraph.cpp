@@ -6,6 +6,8 @@
  #error "Need CFG enabled for building LLVM Dependence Graph"
 #endif
 
+#include <algorithm>
+#include <mutex>
 #include <utility>
 #include <unordered_map>
 #include <set>
@@ -43,6 +45,7 @@
 #include "dg/llvm/LLVMDependenceGraph.h"
 #include "dg/llvm/LLVMNode.h"
 #include "dg/llvm/analysis/PointsTo/PointerAnalysis.h"
+#include "dg/ADT/ParallelFor.h"
 
 #include "llvm/LLVMDGVerifier.h"
 #include "llvm/analysis/ControlExpression.h"
@@ -57,13 +60,15 @@ namespace dg {
 //  -- LLVMDependenceGraph
 /// ------------------------------------------------------------------
 
-// map of all constructed functions
-std::map<llvm::Value *, LLVMDependenceGraph *> constructedFunctions;
+// creating new llvm values is not thread-safe (they are created
+// in the shared context), so guard it when building in parallel
+static std::mutex llvmValuesMutex;
 
-const std::map<llvm::Value *,
-               LLVMDependenceGraph *>& getConstructedFunctions()
+const LLVMConstructedFunctions::MapT&
+LLVMDependenceGraph::getConstructedFunctions() const
 {
-    return constructedFunctions;
+    assert(constructedFunctions && "The graph was not built");
+    return constructedFunctions->getMap();
 }
 
 LLVMDependenceGraph::~LLVMDependenceGraph()
@@ -147,12 +152,102 @@ bool LLVMDependenceGraph::build(llvm::Module *m, llvm::Function *entry)
     // add global nodes. These will be shared across subgraphs
     addGlobals(m, this);
 
+    constructedFunctions = std::make_shared<LLVMConstructedFunctions>();
+
+    if (threads > 1) {
+        buildParallel(entryFunction);
+        return true;
+    }
+
     // build recursively DG from entry point
     build(entryFunction);
 
     return true;
 };
 
+LLVMDependenceGraph *
+LLVMDependenceGraph::createSubgraph()
+{
+    LLVMDependenceGraph *subgraph = new LLVMDependenceGraph();
+    // set global nodes to this one, so that
+    // we'll share them
+    subgraph->setGlobalNodes(getGlobalNodes());
+    subgraph->constructedFunctions = constructedFunctions;
+    subgraph->module = module;
+    subgraph->PTA = PTA;
+    // make subgraphs gather the call-sites too
+    subgraph->gatherCallsites(gather_callsites, gatheredCallsites);
+
+    // the new subgraph has refcount = 1,
+    // later in the code we call addSubgraph, which
+    // increases the refcount to 2, but we need this
+    // subgraph to has refcount 1, so unref it
+    subgraph->unref(false /* deleteOnZero */);
+
+    return subgraph;
+}
+
+void LLVMDependenceGraph::buildParallel(llvm::Function *entry)
+{
+    using namespace llvm;
+
+    // find the functions reachable from the entry,
+    // the callees go before the callers (post-order)
+    std::vector<Function *> functions;
+    std::set<Function *> visited;
+    std::vector<std::pair<Function *, std::vector<Function *>>> stack;
+
+    auto visit = [&](Function *F) {
+        visited.insert(F);
+
+        std::vector<Function *> callees;
+        for (BasicBlock& B : *F) {
+            for (Instruction& I : B) {
+                if (isa<CallInst>(&I))
+                    getCalledFunctions(&I, callees);
+            }
+        }
+
+        // we take the callees from the back
+        std::reverse(callees.begin(), callees.end());
+        stack.emplace_back(F, std::move(callees));
+    };
+
+    visit(entry);
+    while (!stack.empty()) {
+        auto& callees = stack.back().second;
+        if (callees.empty()) {
+            functions.push_back(stack.back().first);
+            stack.pop_back();
+            continue;
+        }
+
+        Function *callee = callees.back();
+        callees.pop_back();
+        if (visited.count(callee) == 0)
+            visit(callee);
+    }
+
+    // create the graphs, the entry nodes and the formal parameters.
+    // This touches the shared global nodes, so do it sequentially
+    std::vector<LLVMDependenceGraph *> graphs;
+    graphs.reserve(functions.size());
+    for (Function *F : functions) {
+        LLVMDependenceGraph *graph = F == entry ? this : createSubgraph();
+        graph->buildEntry(F);
+        graphs.push_back(graph);
+    }
+
+    // the nodes, blocks and CFG edges of the functions are independent
+    ADT::parallelFor(functions.size(), threads,
+                     [&](size_t i) { graphs[i]->buildBlocks(functions[i], false); });
+
+    // link the call-sites with the subgraphs
+    // and add the formal parameters
+    for (LLVMDependenceGraph *graph : graphs)
+        graph->linkInstructions();
+}
+
 LLVMDependenceGraph *
 LLVMDependenceGraph::buildSubgraph(LLVMNode *node)
 {
@@ -252,18 +347,9 @@ LLVMDependenceGraph::buildSubgraph(LLVMNode *node, llvm::Function *callFunc)
 
     // if we don't have this subgraph constructed, construct it
     // else just add call edge
-    LLVMDependenceGraph *&subgraph = constructedFunctions[callFunc];
+    LLVMDependenceGraph *subgraph = constructedFunctions->get(callFunc);
     if (!subgraph) {
-        // since we have reference the the pointer in
-        // constructedFunctions, we can assing to it
-        subgraph = new LLVMDependenceGraph();
-        // set global nodes to this one, so that
-        // we'll share them
-        subgraph->setGlobalNodes(getGlobalNodes());
-        subgraph->module = module;
-        subgraph->PTA = PTA;
-        // make subgraphs gather the call-sites too
-        subgraph->gatherCallsites(gather_callsites, gatheredCallsites);
+        subgraph = createSubgraph();
 
         // make the real work
 #ifndef NDEBUG
@@ -277,12 +363,6 @@ LLVMDependenceGraph::buildSubgraph(LLVMNode *node, llvm::Function *callFunc)
         // point, we can change it
         assert(ret && "Building subgraph failed");
 #endif
-
-        // we built the subgraph, so it has refcount = 1,
-        // later in the code we call addSubgraph, which
-        // increases the refcount to 2, but we need this
-        // subgraph to has refcount 1, so unref it
-        subgraph->unref(false /* deleteOnZero */);
     }
 
     BB = node->getBBlock();
@@ -367,50 +447,64 @@ static bool isMemAllocationFunc(const llvm::Function *func)
     return false;
 }
 
+void LLVMDependenceGraph::getCalledFunctions(llvm::Value *call,
+                                             std::vector<llvm::Function *>& functions) const
+{
+    using namespace llvm;
+
+    CallInst *CInst = cast<CallInst>(call);
+    Value *strippedValue = CInst->getCalledValue()->stripPointerCasts();
+    Function *func = dyn_cast<Function>(strippedValue);
+    // if func is nullptr, then this is indirect call
+    // via function pointer. If we have the points-to information,
+    // take the functions that the pointer points to
+    if (!func && !CInst->isInlineAsm() && PTA) {
+        using namespace analysis::pta;
+        PSNode *op = PTA->getPointsTo(strippedValue);
+        if (op) {
+            for (const Pointer& ptr : op->pointsTo) {
+                if (!ptr.isValid() || ptr.isInvalidated())
+                    continue;
+
+                // vararg may introduce imprecision here, so we
+                // must check that it is really pointer to a function
+                if (!isa<Function>(ptr.target->getUserData<Value>()))
+                    continue;
+
+                Function *F = ptr.target->getUserData<Function>();
+                if (F->size() == 0 || !llvmutils::callIsCompatible(F, CInst))
+                    // incompatible prototypes or the function
+                    // is only declaration
+                    continue;
+
+                functions.push_back(F);
+            }
+        } else
+            llvmutils::printerr("Had no PTA node", strippedValue);
+    }
+
+    if (is_func_defined(func))
+        functions.push_back(func);
+}
+
 void LLVMDependenceGraph::handleInstruction(llvm::Value *val,
                                             LLVMNode *node)
 {
     using namespace llvm;
 
     if (CallInst *CInst = dyn_cast<CallInst>(val)) {
-        Value *strippedValue = CInst->getCalledValue()->stripPointerCasts();
-        Function *func = dyn_cast<Function>(strippedValue);
-        // if func is nullptr, then this is indirect call
-        // via function pointer. If we have the points-to information,
-        // create the subgraph
-        if (!func && !CInst->isInlineAsm() && PTA) {
-            using namespace analysis::pta;
-            PSNode *op = PTA->getPointsTo(strippedValue);
-            if (op) {
-                for (const Pointer& ptr : op->pointsTo) {
-                    if (!ptr.isValid() || ptr.isInvalidated())
-                        continue;
-
-                    // vararg may introduce imprecision here, so we
-                    // must check that it is really pointer to a function
-                    if (!isa<Function>(ptr.target->getUserData<Value>()))
-                        continue;
-
-                    Function *F = ptr.target->getUserData<Function>();
-                    if (F->size() == 0 || !llvmutils::callIsCompatible(F, CInst))
-                        // incompatible prototypes or the function
-                        // is only declaration
-                        continue;
-
-                    LLVMDependenceGraph *subg = buildSubgraph(node, F);
-                    node->addSubgraph(subg);
-                }
-            } else
-                llvmutils::printerr("Had no PTA node", strippedValue);
-        }
+        Function *func
+            = dyn_cast<Function>(CInst->getCalledValue()->stripPointerCasts());
 
         if (func && gather_callsites &&
             func->getName().equals(gather_callsites)) {
             gatheredCallsites->insert(node);
         }
 
-        if (is_func_defined(func)) {
-            LLVMDependenceGraph *subg = buildSubgraph(node, func);
+        std::vector<Function *> functions;
+        getCalledFunctions(CInst, functions);
+        for (Function *F : functions) {
+            LLVMDependenceGraph *subg = buildSubgraph(node, F);
             node->addSubgraph(subg);
         }
 
@@ -442,7 +536,8 @@ void LLVMDependenceGraph::handleInstruction(llvm::Value *val,
     }
 }
 
-LLVMBBlock *LLVMDependenceGraph::build(llvm::BasicBlock& llvmBB)
+LLVMBBlock *LLVMDependenceGraph::build(llvm::BasicBlock& llvmBB,
+                                       bool handleInstructions)
 {
     using namespace llvm;
 
@@ -463,7 +558,8 @@ LLVMBBlock *LLVMDependenceGraph::build(llvm::BasicBlock& llvmBB)
         BB->append(node);
 
         // take instruction specific actions
-        handleInstruction(val, node);
+        if (handleInstructions)
+            handleInstruction(val, node);
     }
 
     // did we created at least one node?
@@ -484,8 +580,11 @@ LLVMBBlock *LLVMDependenceGraph::build(llvm::BasicBlock& llvmBB)
         LLVMNode *ext = getExit();
         if (!ext) {
             // we need new llvm value, so that the nodes won't collide
-            ReturnInst *phonyRet
-                = ReturnInst::Create(termval->getContext());
+            ReturnInst *phonyRet;
+            {
+                std::lock_guard<std::mutex> lock(llvmValuesMutex);
+                phonyRet = ReturnInst::Create(termval->getContext());
+            }
             if (!phonyRet) {
                 errs() << "ERR: Failed creating phony return value "
                        << "for exit node\n";
@@ -522,8 +621,11 @@ LLVMBBlock *LLVMDependenceGraph::build(llvm::BasicBlock& llvmBB)
 
 static LLVMBBlock *createSingleExitBB(LLVMDependenceGraph *graph)
 {
-    llvm::UnreachableInst *ui
-        = new llvm::UnreachableInst(graph->getModule()->getContext());
+    llvm::UnreachableInst *ui;
+    {
+        std::lock_guard<std::mutex> lock(llvmValuesMutex);
+        ui = new llvm::UnreachableInst(graph->getModule()->getContext());
+    }
     LLVMNode *exit = new LLVMNode(ui, true);
     graph->addNode(exit);
     graph->setExit(exit);
@@ -598,7 +700,19 @@ bool LLVMDependenceGraph::build(llvm::Function *func)
     if (func->size() == 0)
         return false;
 
-    constructedFunctions.insert(make_pair(func, this));
+    // we are the root graph built without a module
+    if (!constructedFunctions)
+        constructedFunctions = std::make_shared<LLVMConstructedFunctions>();
+
+    buildEntry(func);
+    buildBlocks(func);
+
+    return true;
+}
+
+void LLVMDependenceGraph::buildEntry(llvm::Function *func)
+{
+    constructedFunctions->add(func, this);
 
     // create entry node
     LLVMNode *entry = new LLVMNode(func);
@@ -609,11 +723,17 @@ bool LLVMDependenceGraph::build(llvm::Function *func)
 
     // add formal parameters to this graph
     addFormalParameters();
+}
+
+void LLVMDependenceGraph::buildBlocks(llvm::Function *func,
+                                      bool handleInstructions)
+{
+    using namespace llvm;
 
     // iterate over basic blocks
     BBlocksMapT& blocks = getBlocks();
     for (llvm::BasicBlock& llvmBB : *func) {
-        LLVMBBlock *BB = build(llvmBB);
+        LLVMBBlock *BB = build(llvmBB, handleInstructions);
         blocks[&llvmBB] = BB;
 
         // first basic block is the entry BB
@@ -665,9 +785,19 @@ bool LLVMDependenceGraph::build(llvm::Function *func)
     addControlDepsToPHIs(this);
 
     // add CFG edge from entry point to the first instruction
-    entry->addControlDependence(getEntryBB()->getFirstNode());
+    getEntry()->addControlDependence(getEntryBB()->getFirstNode());
+}
 
-    return true;
+void LLVMDependenceGraph::linkInstructions()
+{
+    llvm::Function *func = llvm::cast<llvm::Function>(getEntry()->getValue());
+    for (llvm::BasicBlock& llvmBB : *func) {
+        for (llvm::Instruction& Inst : llvmBB) {
+            LLVMNode *node = getNode(&Inst);
+            assert(node && "Do not have a node for an instruction");
+            handleInstruction(&Inst, node);
+        }
+    }
 }
 
 bool LLVMDependenceGraph::build(llvm::Module *m,
@@ -824,7 +954,7 @@ bool LLVMDependenceGraph::getCallSites(const char *name, std::set<LLVMNode *> *c
 bool LLVMDependenceGraph::getCallSites(const char *names[],
                                        std::set<LLVMNode *> *callsites)
 {
-    for (auto& F : constructedFunctions) {
+    for (auto& F : getConstructedFunctions()) {
         for (auto& I : F.second->getBlocks()) {
             LLVMBBlock *BB = I.second;
             for (LLVMNode *n : BB->getNodes()) {
@@ -842,7 +972,7 @@ bool LLVMDependenceGraph::getCallSites(const char *names[],
 bool LLVMDependenceGraph::getCallSites(const std::vector<std::string>& names,
                                        std::set<LLVMNode *> *callsites)
 {
-    for (const auto& F : constructedFunctions) {
+    for (const auto& F : getConstructedFunctions()) {
         for (const auto& I : F.second->getBlocks()) {
             LLVMBBlock *BB = I.second;
             for (LLVMNode *n : BB->getNodes()) {
@@ -857,42 +987,85 @@ bool LLVMDependenceGraph::getCallSites(const std::vector<std::string>& names,
     return callsites->size() != 0;
 }
 
-void LLVMDependenceGraph::computeControlExpression(bool addCDs)
+ControlExpression LLVMDependenceGraph::computeFunctionControlExpression(bool addCDs)
 {
     LLVMCFABuilder builder;
 
-    for (auto& F : getConstructedFunctions()) {
-        llvm::Function *func = llvm::cast<llvm::Function>(F.first);
-        LLVMCFA cfa = builder.build(*func);
-
-        CE = cfa.compute();
-
-        if (addCDs) {
-            // compute the control scope
-            CE.computeSets();
-            auto& our_blocks = F.second->getBlocks();
-
-            for (llvm::BasicBlock& B : *func) {
-                LLVMBBlock *B1 = our_blocks[&B];
-
-                // if this block is a predicate block,
-                // we compute the control deps for it
-                // XXX: for now we compute the control
-                // scope, which is enough for slicing,
-                // but may add some extra (transitive)
-                // edges
-                if (B.getTerminator()->getNumSuccessors() > 1) {
-                    auto CS = CE.getControlScope(&B);
-                    for (auto cs : CS) {
-                        assert(cs->isa(CENodeType::LABEL));
-                        auto lab = static_cast<CELabel<llvm::BasicBlock *> *>(cs);
-                        LLVMBBlock *B2 = our_blocks[lab->getLabel()];
-                        B1->addControlDependence(B2);
-                    }
+    llvm::Function *func = llvm::cast<llvm::Function>(getEntry()->getValue());
+    LLVMCFA cfa = builder.build(*func);
+
+    ControlExpression ce = cfa.compute();
+
+    if (addCDs) {
+        // compute the control scope
+        ce.computeSets();
+        auto& our_blocks = getBlocks();
+
+        for (llvm::BasicBlock& B : *func) {
+            LLVMBBlock *B1 = our_blocks[&B];
+
+            // if this block is a predicate block,
+            // we compute the control deps for it
+            // XXX: for now we compute the control
+            // scope, which is enough for slicing,
+            // but may add some extra (transitive)
+            // edges
+            if (B.getTerminator()->getNumSuccessors() > 1) {
+                auto CS = ce.getControlScope(&B);
+                for (auto cs : CS) {
+                    assert(cs->isa(CENodeType::LABEL));
+                    auto lab = static_cast<CELabel<llvm::BasicBlock *> *>(cs);
+                    LLVMBBlock *B2 = our_blocks[lab->getLabel()];
+                    B1->addControlDependence(B2);
                 }
             }
         }
     }
+
+    return ce;
+}
+
+void LLVMDependenceGraph::computeControlExpression(bool addCDs)
+{
+    // the functions are independent, process them in parallel
+    std::vector<LLVMDependenceGraph *> graphs;
+    for (auto& F : getConstructedFunctions())
+        graphs.push_back(F.second);
+
+    std::vector<ControlExpression> expressions(graphs.size());
+    ADT::parallelFor(graphs.size(), threads, [&](size_t i) {
+        expressions[i] = graphs[i]->computeFunctionControlExpression(addCDs);
+    });
+
+    // keep the expression of the last function like
+    // the sequential computation did
+    if (!expressions.empty())
+        CE = std::move(expressions.back());
+}
+
+void LLVMDependenceGraph::computeControlDependenciesOnDemand(CD_ALG alg_type)
+{
+    for (auto& F : getConstructedFunctions()) {
+        F.second->cdAlgorithm = alg_type;
+        F.second->cdOnDemand = true;
+    }
+}
+
+void LLVMDependenceGraph::ensureControlDependencies()
+{
+    if (!cdOnDemand)
+        return;
+
+    std::call_once(cdComputed, [this]() {
+        if (cdAlgorithm == CD_ALG::CLASSIC)
+            computeFunctionPostDominators(true);
+        else if (cdAlgorithm == CD_ALG::CONTROL_EXPRESSION)
+            // the expression is not kept in CE
+            // when computed on demand
+            computeFunctionControlExpression(true);
+        else
+            abort();
+    });
 }
 
 // the original algorithm from Ferrante & Ottenstein
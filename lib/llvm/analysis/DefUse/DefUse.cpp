@@ -463,4 +463,15 @@ bool LLVMDefUseAnalysis::runOnNode(LLVMNode *node, LLVMNode *)
     return false;
 }
 
+void LLVMDefUseAnalysis::computeDataDependencies(LLVMNode *node)
+{
+    // run() processes only the nodes in basic blocks,
+    // the edges of parameters are added when building the graph
+    if (!node->getBBlock())
+        return;
+
+    if (processed.insert(node).second)
+        runOnNode(node, nullptr);
+}
+
 } // namespace dg
@@ -915,6 +915,82 @@ bool LLVMPointerSubgraphBuilder::validateSubgraph(bool no_connectivity) const
     }
 }
 
+std::set<PSNode *> LLVMPointerSubgraphBuilder::getPreservedNodes() const
+{
+    std::set<PSNode *> preserved;
+    preserved.insert(PS.getRoot());
+
+    for (const auto& it : subgraphs_map) {
+        const llvm::Function *F = it.first;
+        const Subgraph& subg = it.second;
+
+        // we connect new calls to these nodes
+        preserved.insert(subg.root);
+        if (subg.ret)
+            preserved.insert(subg.ret);
+        if (subg.vararg)
+            preserved.insert(subg.vararg);
+
+        // the arguments get new operands on calls via function pointers
+        for (auto A = F->arg_begin(), E = F->arg_end(); A != E; ++A) {
+            auto nit = nodes_map.find(&*A);
+            if (nit != nodes_map.end())
+                preserved.insert(nit->second.second);
+        }
+    }
+
+    return preserved;
+}
+
+unsigned LLVMPointerSubgraphBuilder::optimizeSubgraph(bool flow_insensitive)
+{
+    PointerSubgraphOptimizer optimizer(&PS, getPreservedNodes());
+    optimizer.setFlowInsensitive(flow_insensitive);
+
+    unsigned removed = optimizer.run();
+    if (removed == 0)
+        return 0;
+
+    // the nodes that are still in the graph. The removed nodes
+    // are already deleted, so we use them only as keys here
+    std::set<PSNode *> live{NULLPTR, UNKNOWN_MEMORY, INVALIDATED};
+    for (const auto& nd : PS.getNodes()) {
+        if (nd)
+            live.insert(nd.get());
+    }
+
+    const auto& replaced = optimizer.getMapping();
+    auto getLiveNode = [&](PSNode *nd) -> PSNode * {
+        if (live.count(nd) > 0)
+            return nd;
+        // nullptr for the nodes that were removed without a replacement
+        PSNode *rep = replaced.get(nd);
+        return (rep && live.count(rep) > 0) ? rep : nullptr;
+    };
+
+    for (auto it = nodes_map.begin(); it != nodes_map.end();) {
+        PSNode *last = getLiveNode(it->second.second);
+        if (!last) {
+            it = nodes_map.erase(it);
+            continue;
+        }
+
+        PSNode *first = getLiveNode(it->second.first);
+        it->second = PSNodesSeq(first ? first : last, last);
+        ++it;
+    }
+
+    PointsToMapping<const llvm::Value *> newMapping;
+    newMapping.reserve(mapping.size());
+    for (const auto& it : mapping) {
+        if (PSNode *nd = getLiveNode(it.second))
+            newMapping.add(it.first, nd);
+    }
+
+    mapping = std::move(newMapping);
+    return removed;
+}
+
 std::vector<PSNode *>
 LLVMPointerSubgraphBuilder::getFunctionNodes(const llvm::Function *F) const
 {
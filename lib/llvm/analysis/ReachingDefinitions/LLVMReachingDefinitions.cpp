@@ -17,7 +17,7 @@ void LLVMReachingDefinitions::initializeSparseRDA() {
     builder = new LLVMRDBuilderSemisparse(m, pta, _options);
     root = builder->build();
 
-    RDA = std::unique_ptr<ReachingDefinitionsAnalysis>(new SemisparseRda(root));
+    RDA = std::unique_ptr<ReachingDefinitionsAnalysis>(new SemisparseRda(root, _options));
 }
 
 void LLVMReachingDefinitions::initializeDenseRDA() {
@@ -25,7 +25,7 @@ void LLVMReachingDefinitions::initializeDenseRDA() {
     root = builder->build();
 
     RDA = std::unique_ptr<ReachingDefinitionsAnalysis>(
-                    new ReachingDefinitionsAnalysis(root));
+                    new ReachingDefinitionsAnalysis(root, _options));
 }
 
 RDNode *LLVMReachingDefinitions::getNode(const llvm::Value *val) {
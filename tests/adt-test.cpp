@@ -6,6 +6,8 @@
 
 #include "dg/ADT/Queue.h"
 #include "dg/ADT/Bitvector.h"
+#include "dg/ADT/ParallelFor.h"
+#include "dg/ADT/SmallSortedSet.h"
 #include "dg/analysis/ReachingDefinitions/RDMap.h"
 
 using namespace dg::ADT;
@@ -150,6 +152,84 @@ public:
     }
 };
 
+class TestParallelFor : public Test
+{
+public:
+    TestParallelFor() : Test("parallel for test")
+    {}
+
+    void test()
+    {
+        for (unsigned threads : {1, 2, 4, 16}) {
+            std::vector<int> visited(1000, 0);
+            parallelFor(visited.size(), threads,
+                        [&visited](size_t i) { ++visited[i]; });
+
+            bool once = true;
+            for (int v : visited)
+                once &= v == 1;
+            check(once, "Every item must be processed exactly once");
+        }
+
+        int calls = 0;
+        parallelFor(0, 4, [&calls](size_t) { ++calls; });
+        check(calls == 0, "Processed an item of an empty range");
+    }
+};
+
+class TestSmallSortedSet : public Test
+{
+public:
+    TestSmallSortedSet() : Test("small sorted set test")
+    {}
+
+    void test()
+    {
+        using SetT = dg::ADT::SmallSortedSet<int, 4>;
+        SetT S;
+
+        check(S.empty(), "empty set not empty");
+        check(S.insert(5).second, "returned false with new element");
+        check(S.insert(1).second, "returned false with new element");
+        check(S.insert(3).second, "returned false with new element");
+        check(!S.insert(3).second, "double inserted element");
+        check(S.size() == 3, "BUG in size");
+        check(S.isInline(), "few elements are not inline");
+
+        // spill to the heap
+        for (int i = 10; i > 5; --i)
+            S.insert(i);
+        check(S.size() == 8, "BUG in size");
+        check(!S.isInline(), "many elements are inline");
+
+        bool sorted = true;
+        for (auto it = S.begin(); it + 1 < S.end(); ++it)
+            sorted &= *it < *(it + 1);
+        check(sorted, "elements are not sorted");
+
+        check(S.count(1) && S.count(7) && !S.count(2) && !S.count(11),
+              "BUG in count");
+        check(S.erase(7) == 1 && S.erase(7) == 0, "BUG in erase");
+        check(!S.count(7) && S.size() == 7, "erased element is still there");
+
+        SetT S2(S);
+        check(S == S2, "copied sets differ");
+
+        SetT S3;
+        S3.insert(3);
+        S3.insert(8);
+        S3.insert(42);
+        S3.swap(S2);
+        check(S2.size() == 3 && S3 == S, "BUG in swap");
+
+        S3.intersect(S2);
+        check(S3.size() == 2 && S3.count(3) && S3.count(8), "BUG in intersect");
+
+        S.clear();
+        check(S.empty() && S.isInline(), "cleared set not empty");
+    }
+};
+
 }; // namespace tests
 }; // namespace dg
 
@@ -162,6 +242,8 @@ int main()
     Runner.add(new TestFIFO());
     Runner.add(new TestPrioritySet());
     Runner.add(new TestIntervalsHandling());
+    Runner.add(new TestParallelFor());
+    Runner.add(new TestSmallSortedSet());
 
     return Runner();
 }
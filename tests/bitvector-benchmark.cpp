@@ -0,0 +1,139 @@
+#include <vector>
+#include <string>
+#include <random>
+
+#include "dg/ADT/Bitvector.h"
+#include "../tools/TimeMeasure.h"
+
+using dg::ADT::SparseBitvector;
+
+std::default_random_engine generator;
+
+// the way how merge was done before,
+// we keep it here for the comparison
+static bool mergeBitByBit(SparseBitvector& lhs, const SparseBitvector& rhs) {
+    bool changed = false;
+    for (size_t i : rhs) {
+        changed |= (lhs.set(i) == false);
+    }
+
+    return changed;
+}
+
+static SparseBitvector randomBitvector(size_t elems, uint64_t max) {
+    std::uniform_int_distribution<uint64_t> distribution(0, max);
+    SparseBitvector B;
+    for (size_t i = 0; i < elems; ++i)
+        B.set(distribution(generator));
+
+    return B;
+}
+
+#define run(func, msg) do { \
+    std::cout << "Running " << msg << "\n"; \
+    dg::debug::TimeMeasure tm; \
+    tm.start(); \
+    func(); \
+    tm.stop(); \
+    tm.report(" -- " msg " took"); \
+    } while(0);
+
+static std::vector<SparseBitvector> dense, sparse;
+static size_t result = 0;
+
+static void createVectors() {
+    for (int i = 0; i < 1000; ++i) {
+        dense.push_back(randomBitvector(1000, 10000));
+        sparse.push_back(randomBitvector(100, ~static_cast<uint64_t>(0)));
+    }
+}
+
+static void mergeDenseWords() {
+    for (int n = 0; n < 10; ++n) {
+        SparseBitvector B;
+        for (auto& V : dense)
+            result += B.merge(V);
+    }
+}
+
+static void mergeDenseBits() {
+    for (int n = 0; n < 10; ++n) {
+        SparseBitvector B;
+        for (auto& V : dense)
+            result += mergeBitByBit(B, V);
+    }
+}
+
+static void mergeSparseWords() {
+    for (int n = 0; n < 10; ++n) {
+        SparseBitvector B;
+        for (auto& V : sparse)
+            result += B.merge(V);
+    }
+}
+
+static void mergeSparseBits() {
+    for (int n = 0; n < 10; ++n) {
+        SparseBitvector B;
+        for (auto& V : sparse)
+            result += mergeBitByBit(B, V);
+    }
+}
+
+// merging already merged vectors, that is
+// what happens in the fixpoint most of the time
+static void mergeUnchanged() {
+    SparseBitvector B;
+    for (auto& V : dense)
+        B.merge(V);
+
+    for (int n = 0; n < 10; ++n) {
+        for (auto& V : dense)
+            result += B.merge(V);
+    }
+}
+
+static void mergeUnchangedBits() {
+    SparseBitvector B;
+    for (auto& V : dense)
+        B.merge(V);
+
+    for (int n = 0; n < 10; ++n) {
+        for (auto& V : dense)
+            result += mergeBitByBit(B, V);
+    }
+}
+
+static void setOperations() {
+    for (size_t i = 1; i < dense.size(); ++i) {
+        auto I = dense[i - 1];
+        result += I.intersect(dense[i]);
+        auto D = dense[i - 1];
+        result += D.subtract(dense[i]);
+        result += I.isSubsetOf(dense[i]);
+    }
+}
+
+static void countElements() {
+    for (int n = 0; n < 100; ++n) {
+        for (auto& V : dense)
+            result += V.size();
+    }
+}
+
+int main()
+{
+    run(createVectors, "Creating random bitvectors");
+    run(mergeDenseWords, "Merging dense bitvectors (word-wise)");
+    run(mergeDenseBits, "Merging dense bitvectors (bit-by-bit)");
+    run(mergeSparseWords, "Merging sparse bitvectors (word-wise)");
+    run(mergeSparseBits, "Merging sparse bitvectors (bit-by-bit)");
+    run(mergeUnchanged, "Merging without a change (word-wise)");
+    run(mergeUnchangedBits, "Merging without a change (bit-by-bit)");
+    run(setOperations, "Intersection, difference and subset");
+    run(countElements, "Computing the size");
+
+    // use the result so that the compiler
+    // does not optimize the code away
+    std::cout << "Result: " << result << "\n";
+}
@@ -2,10 +2,14 @@
 #include "catch.hpp"
 
 #include <random>
+#include <set>
 
 #include "dg/ADT/Bitvector.h"
+#include "dg/ADT/DenseBitvector.h"
 
 using dg::ADT::SparseBitvector;
+using dg::ADT::FlatSparseBitvector;
+using dg::ADT::DenseBitvector;
 
 TEST_CASE("Querying empty set", "SparseBitvector") {
     SparseBitvector B;
@@ -205,3 +209,278 @@ TEST_CASE("Merge random bitvectors (union)", "SparseBitvector") {
 //    B2.merge(B1);
 //    REQUIRE(B1 == B2);
 }
+
+TEST_CASE("Merge reports changes", "SparseBitvector") {
+    SparseBitvector B1;
+    SparseBitvector B2;
+
+    B1.set(1);
+    B1.set(1000);
+    B2.set(1);
+
+    REQUIRE(B1.merge(B2) == false);
+    REQUIRE(B1.size() == 2);
+
+    B2.set(2);
+    B2.set(100000);
+    REQUIRE(B1.merge(B2) == true);
+    REQUIRE(B1.size() == 4);
+    REQUIRE(B1.get(1));
+    REQUIRE(B1.get(2));
+    REQUIRE(B1.get(1000));
+    REQUIRE(B1.get(100000));
+
+    REQUIRE(B1.merge(B2) == false);
+
+    SparseBitvector E;
+    REQUIRE(B1.merge(E) == false);
+    REQUIRE(E.merge(B1) == true);
+    REQUIRE(E == B1);
+}
+
+TEST_CASE("Intersect bitvectors", "SparseBitvector") {
+    SparseBitvector B1;
+    SparseBitvector B2;
+
+    B1.set(0);
+    B1.set(5);
+    B1.set(64);
+    B1.set(1000);
+    B2.set(5);
+    B2.set(65);
+    B2.set(1000);
+    B2.set(5000);
+
+    REQUIRE(B1.intersect(B2) == true);
+    REQUIRE(B1.size() == 2);
+    REQUIRE(B1.get(5));
+    REQUIRE(B1.get(1000));
+    REQUIRE(!B1.get(0));
+    REQUIRE(!B1.get(64));
+    REQUIRE(!B1.get(65));
+    REQUIRE(!B1.get(5000));
+
+    REQUIRE(B1.intersect(B2) == false);
+
+    SparseBitvector E;
+    REQUIRE(B1.intersect(E) == true);
+    REQUIRE(B1.empty());
+}
+
+TEST_CASE("Subtract bitvectors", "SparseBitvector") {
+    SparseBitvector B1;
+    SparseBitvector B2;
+
+    B1.set(0);
+    B1.set(5);
+    B1.set(64);
+    B1.set(1000);
+    B2.set(5);
+    B2.set(64);
+    B2.set(5000);
+
+    REQUIRE(B1.subtract(B2) == true);
+    REQUIRE(B1.size() == 2);
+    REQUIRE(B1.get(0));
+    REQUIRE(B1.get(1000));
+    REQUIRE(B1.subtract(B2) == false);
+
+    REQUIRE(B1.subtract(B1) == true);
+    REQUIRE(B1.empty());
+    REQUIRE(B1.begin() == B1.end());
+}
+
+TEST_CASE("Subset of bitvectors", "SparseBitvector") {
+    SparseBitvector B1;
+    SparseBitvector B2;
+
+    REQUIRE(B1.isSubsetOf(B2));
+
+    B1.set(10);
+    REQUIRE(!B1.isSubsetOf(B2));
+    REQUIRE(B2.isSubsetOf(B1));
+
+    B2.set(10);
+    B2.set(11);
+    B2.set(100000);
+    REQUIRE(B1.isSubsetOf(B2));
+    REQUIRE(!B2.isSubsetOf(B1));
+
+    B1.set(100001);
+    REQUIRE(!B1.isSubsetOf(B2));
+}
+
+TEST_CASE("Random set operations", "SparseBitvector") {
+    SparseBitvector B1;
+    SparseBitvector B2;
+    std::set<uint64_t> S1, S2;
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution(0, 10000);
+
+    for (int i = 0; i < 1000; ++i) {
+        auto x = distribution(generator);
+        auto y = distribution(generator);
+        B1.set(x);
+        B2.set(y);
+        S1.insert(x);
+        S2.insert(y);
+    }
+
+    REQUIRE(B1.size() == S1.size());
+    REQUIRE(B2.size() == S2.size());
+
+    auto U = B1;
+    U.merge(B2);
+    auto I = B1;
+    I.intersect(B2);
+    auto D = B1;
+    D.subtract(B2);
+
+    for (uint64_t x = 0; x <= 10000; ++x) {
+        bool in1 = S1.count(x) > 0;
+        bool in2 = S2.count(x) > 0;
+        REQUIRE(U.get(x) == (in1 || in2));
+        REQUIRE(I.get(x) == (in1 && in2));
+        REQUIRE(D.get(x) == (in1 && !in2));
+    }
+
+    REQUIRE(I.isSubsetOf(B1));
+    REQUIRE(I.isSubsetOf(B2));
+    REQUIRE(B1.isSubsetOf(U));
+    REQUIRE(B2.isSubsetOf(U));
+    REQUIRE(D.isSubsetOf(B1));
+}
+
+TEST_CASE("Flat bitvector", "FlatSparseBitvector") {
+    SparseBitvector B;
+    FlatSparseBitvector F1, F2;
+    std::set<uint64_t> S;
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution(0, 100000);
+
+    for (int i = 0; i < 1000; ++i) {
+        auto x = distribution(generator);
+        REQUIRE(F1.set(x) == B.set(x));
+        S.insert(x);
+        if (i % 3 == 0)
+            F2.set(x + 1);
+    }
+
+    REQUIRE(F1.size() == S.size());
+    for (auto x : S)
+        REQUIRE(F1.get(x));
+
+    auto it = S.begin();
+    for (auto x : F1) {
+        REQUIRE(x == *it);
+        ++it;
+    }
+    REQUIRE(it == S.end());
+
+    auto U = F1;
+    REQUIRE(U.merge(F2));
+    REQUIRE(F1.isSubsetOf(U));
+    REQUIRE(F2.isSubsetOf(U));
+    REQUIRE(!U.merge(F1));
+
+    auto D = U;
+    D.subtract(F1);
+    REQUIRE(D.isSubsetOf(F2));
+    auto I = U;
+    I.intersect(F1);
+    REQUIRE(I == F1);
+
+    for (auto x : S)
+        F1.unset(x);
+    REQUIRE(F1.empty());
+}
+
+TEST_CASE("Dense bitvector", "DenseBitvector") {
+    SparseBitvector B;
+    DenseBitvector D1, D2;
+    std::set<uint64_t> S;
+
+    REQUIRE(D1.begin() == D1.end());
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution(0, 10000);
+
+    for (int i = 0; i < 1000; ++i) {
+        auto x = distribution(generator);
+        REQUIRE(D1.set(x) == B.set(x));
+        S.insert(x);
+        if (i % 3 == 0)
+            D2.set(x + 1);
+    }
+
+    REQUIRE(D1.size() == S.size());
+    for (auto x : S)
+        REQUIRE(D1.get(x));
+
+    auto it = S.begin();
+    for (auto x : D1) {
+        REQUIRE(x == *it);
+        ++it;
+    }
+    REQUIRE(it == S.end());
+
+    auto U = D1;
+    REQUIRE(U.merge(D2));
+    REQUIRE(D1.isSubsetOf(U));
+    REQUIRE(D2.isSubsetOf(U));
+    REQUIRE(!U.merge(D1));
+
+    auto I = D1;
+    I.intersect(D2);
+    REQUIRE(I.size() == D1.intersectionSize(D2));
+    REQUIRE(D1.intersects(D2) == !I.empty());
+
+    auto D = U;
+    D.subtract(D1);
+    REQUIRE(D.isSubsetOf(D2));
+    REQUIRE(!D.intersects(D1));
+    REQUIRE(D.size() + D1.size() == U.size());
+
+    auto I2 = U;
+    I2.intersect(D1);
+    REQUIRE(I2 == D1);
+
+    for (auto x : S)
+        D1.unset(x);
+    REQUIRE(D1.empty());
+    REQUIRE(D1 == DenseBitvector());
+}
+
+TEST_CASE("Ranges", "SparseBitvector") {
+    SparseBitvector B;
+    B.set(3);
+    B.set(64);
+    B.set(130);
+    B.set(200);
+    B.set(1000000);
+
+    REQUIRE(B.first() == 3);
+    REQUIRE(B.last() == 1000000);
+    REQUIRE(B.hasAnyInRange(0, 4));
+    REQUIRE(!B.hasAnyInRange(0, 3));
+    REQUIRE(!B.hasAnyInRange(4, 64));
+    REQUIRE(B.hasAnyInRange(4, 65));
+    REQUIRE(!B.hasAnyInRange(201, 1000000));
+    REQUIRE(B.hasAnyInRange(201, 1000001));
+
+    REQUIRE(B.unsetRange(60, 150));
+    REQUIRE(!B.unsetRange(60, 150));
+    REQUIRE(B.size() == 3);
+    REQUIRE(B.get(3));
+    REQUIRE(!B.get(64));
+    REQUIRE(!B.get(130));
+    REQUIRE(B.get(200));
+
+    REQUIRE(B.unsetRange(0, 1000000));
+    REQUIRE(B.first() == 1000000);
+    REQUIRE(B.last() == 1000000);
+    REQUIRE(B.unsetRange(0, ~static_cast<size_t>(0)));
+    REQUIRE(B.empty());
+}
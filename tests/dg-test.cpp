@@ -1,6 +1,9 @@
 #include <cassert>
 #include <cstdarg>
 #include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
 
 #include "test-runner.h"
 #include "test-dg.h"
@@ -676,6 +679,242 @@ public:
     }
 };
 
+class TestSlicingDDOnDemand : public Test
+{
+    // n3 uses n2 and n2 uses n1,
+    // the edges are added only when asked for
+    struct Provider : public analysis::DataDependenceProvider<TestNode>
+    {
+        TestNode *n1, *n2, *n3;
+        std::set<TestNode *> queried;
+
+        void computeDataDependencies(TestNode *n) override
+        {
+            if (!queried.insert(n).second)
+                return;
+
+            if (n == n3)
+                n2->addDataDependence(n3);
+            else if (n == n2)
+                n1->addDataDependence(n2);
+        }
+    };
+
+public:
+    TestSlicingDDOnDemand() : Test("Slicing with on-demand data dependencies test")
+    {}
+
+    void test()
+    {
+        TestDG d;
+
+        TestNode *entry = new TestNode(0);
+        TestNode *n1 = new TestNode(1);
+        TestNode *n2 = new TestNode(2);
+        TestNode *n3 = new TestNode(3);
+        TestNode *n4 = new TestNode(4);
+        d.addNode(entry);
+        d.addNode(n1);
+        d.addNode(n2);
+        d.addNode(n3);
+        d.addNode(n4);
+        d.setEntry(entry);
+        entry->addControlDependence(n4);
+
+        Provider provider;
+        provider.n1 = n1;
+        provider.n2 = n2;
+        provider.n3 = n3;
+
+        analysis::Slicer<TestNode> slicer;
+        slicer.setDataDependenceProvider(&provider);
+        uint32_t sid = slicer.mark(n3);
+
+        check(n1->getSlice() == sid, "n1 is not in the slice");
+        check(n2->getSlice() == sid, "n2 is not in the slice");
+        check(n3->getSlice() == sid, "n3 is not in the slice");
+        check(n4->getSlice() != sid, "n4 is in the slice");
+        check(provider.queried.count(n4) == 0, "Queried n4 that is not in the slice");
+        check(n2->getRevDataDependenciesNum() == 1, "n2 should depend on n1");
+        check(n4->getRevDataDependenciesNum() == 0, "n4 should not have dependencies");
+    }
+};
+
+class TestSliceMembership : public Test
+{
+public:
+    TestSliceMembership() : Test("Slice membership test")
+    {}
+
+    void test()
+    {
+        TestDG d;
+
+        TestNode *entry = new TestNode(0);
+        TestNode *n1 = new TestNode(1);
+        TestNode *n2 = new TestNode(2);
+        TestNode *n3 = new TestNode(3);
+        TestNode *n4 = new TestNode(4);
+        d.addNode(n1);
+        d.addNode(n2);
+        d.addNode(n3);
+        d.addNode(n4);
+        d.setEntry(entry);
+
+        // n3 depends on n1 and n2, n4 depends on n2
+        n1->addDataDependence(n3);
+        n2->addDataDependence(n3);
+        n2->addDataDependence(n4);
+
+        analysis::SliceMembership<TestNode> slices;
+        analysis::Slicer<TestNode> slicer;
+        slicer.setSliceMembership(&slices);
+
+        uint32_t s3 = slicer.mark(n3);
+        uint32_t s4 = slicer.mark(n4);
+
+        // the entry of the graph is in both the slices
+        check(slices.size(s3) == 4, "Slice of n3 should have 4 nodes");
+        check(slices.size(s4) == 3, "Slice of n4 should have 3 nodes");
+        check(slices.contains(s3, n1), "n1 is not in the slice of n3");
+        check(!slices.contains(s4, n1), "n1 is in the slice of n4");
+        // the marking overwrote the slice_id of n2,
+        // but the slice of n3 still contains it
+        check(n2->getSlice() == s4, "n2 is not marked with the last slice");
+        check(slices.contains(s3, n2), "n2 is not in the slice of n3");
+
+        check(slices.overlap(s3, s4), "The slices should overlap");
+        check(slices.overlapSize(s3, s4) == 2, "The slices should share n2 and entry");
+        check(slices.getUnion(s3, s4).size() == 5, "Wrong union of slices");
+        check(slices.getDifference(s4, s3).size() == 1, "Wrong difference");
+
+        auto sizes = slices.sizes({s3, s4});
+        check(sizes[0] == 4 && sizes[1] == 3, "Wrong sizes of slices");
+        auto overlaps = slices.overlapSizes({s3, s4});
+        check(overlaps[0][1] == 2 && overlaps[1][0] == 2, "Wrong overlaps");
+
+        // slice w.r.t. the union of the slices without marking again
+        uint32_t su = 100;
+        slices.setSlice(su, slices.getUnion(s3, s4));
+        slicer.slice(&d, su);
+        check(d.size() == 4, "Slicing w.r.t. the union removed a node");
+
+        // n2 is stamped with s4, but it is kept in the slice of n3
+        slicer.slice(&d, s3);
+        check(d.size() == 3, "Slice of n3 should have 3 nodes in the graph");
+        check(d.getNode(2) == n2, "n2 was sliced away");
+        check(d.getNode(4) == nullptr, "n4 was not sliced away");
+    }
+};
+
+class TestParallelSlicing : public Test
+{
+public:
+    TestParallelSlicing() : Test("Parallel slicing test")
+    {}
+
+    void test()
+    {
+        TestDG d;
+
+        // random graph where every node depends on few nodes
+        // with lower key, so that the slices have large levels
+        std::default_random_engine generator;
+        RandomGraph rg;
+        rg.dataDeps = 3;
+        rg.controlEvery = 7;
+        std::vector<TestNode *> nodes = rg.create(d, 5000, generator);
+        TestNode *entry = d.getEntry();
+
+        uint32_t seq = 1;
+        for (size_t start : {nodes.size() - 1, nodes.size() / 2, size_t(10)}) {
+            analysis::SliceMembership<TestNode> slices;
+
+            analysis::Slicer<TestNode> slicer;
+            slicer.setSliceMembership(&slices);
+            slicer.mark(nodes[start], seq);
+
+            uint32_t par = seq + 1;
+            analysis::Slicer<TestNode> pslicer;
+            pslicer.setSliceMembership(&slices);
+            pslicer.setThreads(4);
+            pslicer.mark(nodes[start], par);
+
+            check(slices.size(seq) > 1, "The slice is empty");
+            check(slices.getSlice(seq) == slices.getSlice(par),
+                  "Parallel slice differs from the sequential one");
+            check(entry->getSlice() == par, "The entry is not in the slice");
+            for (TestNode *n : nodes)
+                check((n->getSlice() == par) == slices.contains(seq, n),
+                      "Node %d is marked wrongly", n->getKey());
+
+            seq += 2;
+        }
+    }
+};
+
+class TestFrozenEdges : public Test
+{
+public:
+    TestFrozenEdges() : Test("Frozen edges test")
+    {}
+
+    void test()
+    {
+        TestDG d;
+
+        std::default_random_engine generator;
+        RandomGraph rg;
+        rg.useDeps = 1;
+        rg.controlEvery = 5;
+        std::vector<TestNode *> nodes = rg.create(d, 1000, generator);
+
+        // a node that is not in the graph, but is reachable by an edge
+        std::unique_ptr<TestNode> paramNode(new TestNode(-1));
+        TestNode *param = paramNode.get();
+        param->addDataDependence(nodes[10]);
+
+        analysis::SliceMembership<TestNode> slices;
+        analysis::Slicer<TestNode> slicer;
+        slicer.setSliceMembership(&slices);
+        uint32_t seq = slicer.mark(nodes.back(), 1);
+
+        FrozenEdges<TestNode> frozen;
+        frozen.addGraph(&d);
+        frozen.freeze();
+
+        check(frozen.size() == nodes.size() + 2, "Wrong number of frozen nodes");
+        check(frozen.contains(param), "Reachable node was not frozen");
+        for (TestNode *n : nodes) {
+            check(frozen.edges(n, FrozenEdges<TestNode>::REV_DATA).size()
+                  == n->getRevDataDependenciesNum(), "Wrong number of rev. DD");
+            check(frozen.edges(n, FrozenEdges<TestNode>::USE).size()
+                  == n->getUseDependenciesNum(), "Wrong number of uses");
+            check(frozen.edges(n, FrozenEdges<TestNode>::CONTROL).size()
+                  == n->getControlDependenciesNum(), "Wrong number of CDs");
+        }
+
+        TestNode outside(1001);
+        check(!frozen.contains(&outside), "Unfrozen node is in frozen edges");
+        check(frozen.edges(&outside, FrozenEdges<TestNode>::REV_DATA).empty(),
+              "Unfrozen node has frozen edges");
+        check(frozen.edges(frozen.size(), FrozenEdges<TestNode>::USE).empty(),
+              "Out-of-range ID has frozen edges");
+
+        frozen.releaseNodeEdges();
+        check(nodes[10]->getRevDataDependenciesNum() == 0, "Edges were not released");
+
+        analysis::Slicer<TestNode> fslicer;
+        fslicer.setSliceMembership(&slices);
+        fslicer.setFrozenEdges(&frozen);
+        uint32_t fro = fslicer.mark(nodes.back(), 2);
+
+        check(slices.size(seq) > 1, "The slice is empty");
+        check(slices.getSlice(seq) == slices.getSlice(fro),
+              "Slice on frozen edges differs from the original one");
+    }
+};
+
 }; // namespace tests
 }; // namespace dg
 
@@ -689,6 +928,10 @@ int main(void)
     Runner.add(new TestAdd());
     Runner.add(new TestRemove());
     Runner.add(new TestSlicingCFG());
+    Runner.add(new TestSlicingDDOnDemand());
+    Runner.add(new TestSliceMembership());
+    Runner.add(new TestParallelSlicing());
+    Runner.add(new TestFrozenEdges());
 
     return Runner();
 }
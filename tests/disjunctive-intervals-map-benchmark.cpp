@@ -0,0 +1,116 @@
+#include <vector>
+#include <string>
+#include <random>
+#include <iostream>
+
+#include "dg/analysis/ReachingDefinitions/DisjunctiveIntervalMap.h"
+#include "dg/analysis/ReachingDefinitions/FlatDisjunctiveIntervalMap.h"
+#include "../tools/TimeMeasure.h"
+
+using namespace dg::analysis::rd;
+
+using MapT = DisjunctiveIntervalMap<int, uint64_t>;
+using FlatMapT = FlatDisjunctiveIntervalMap<int, uint64_t>;
+
+// the queries and updates of a map of a structure
+// with fields (intervals of size 1 to 8)
+struct Interval {
+    uint64_t start;
+    uint64_t end;
+};
+
+static std::vector<Interval> randomIntervals(std::mt19937& gen,
+                                             size_t num, uint64_t max) {
+    std::uniform_int_distribution<uint64_t> pos(0, max);
+    std::uniform_int_distribution<uint64_t> len(0, 7);
+    std::vector<Interval> ret;
+    ret.reserve(num);
+    for (size_t i = 0; i < num; ++i) {
+        uint64_t s = pos(gen);
+        ret.push_back(Interval{s, s + len(gen)});
+    }
+    return ret;
+}
+
+static size_t result = 0;
+
+template <typename M>
+static void fill(M& map, const std::vector<Interval>& intervals, int val) {
+    for (const auto& I : intervals)
+        map.add(I.start, I.end, val++ % 16);
+}
+
+template <typename M>
+static void runQueries(size_t fields, int times) {
+    std::mt19937 gen(fields);
+    M map;
+    fill(map, randomIntervals(gen, fields, 8 * fields), 0);
+    auto queries = randomIntervals(gen, 1000, 8 * fields);
+
+    while (--times > 0) {
+        for (const auto& I : queries) {
+            result += map.overlaps(I.start, I.end);
+            result += map.overlapsFull(I.start, I.end);
+        }
+    }
+}
+
+template <typename M>
+static void runUpdates(size_t fields, int times) {
+    std::mt19937 gen(fields);
+    auto intervals = randomIntervals(gen, fields, 8 * fields);
+
+    while (--times > 0) {
+        M map;
+        fill(map, intervals, times);
+        result += map.size();
+    }
+}
+
+template <typename M>
+static void runMerges(size_t fields, int times) {
+    std::mt19937 gen(fields);
+    std::vector<M> maps(10);
+    for (auto& map : maps)
+        fill(map, randomIntervals(gen, fields, 8 * fields), 0);
+
+    while (--times > 0) {
+        M map;
+        for (const auto& rhs : maps)
+            map.merge(rhs);
+        result += map.size();
+    }
+}
+
+template <typename Func>
+static void measure(Func func, const std::string& msg) {
+    dg::debug::TimeMeasure tm;
+    tm.start();
+    func();
+    tm.stop();
+    tm.report(msg + " took");
+}
+
+static void test(size_t fields) {
+    std::string sz = "[" + std::to_string(fields) + " fields] ";
+    int times = 2000000 / (fields + 10);
+
+    measure([&]{ runQueries<MapT>(fields, times / 100); }, sz + "queries -- DisjunctiveIntervalMap");
+    measure([&]{ runQueries<FlatMapT>(fields, times / 100); }, sz + "queries -- FlatDisjunctiveIntervalMap");
+    measure([&]{ runUpdates<MapT>(fields, times); }, sz + "updates -- DisjunctiveIntervalMap");
+    measure([&]{ runUpdates<FlatMapT>(fields, times); }, sz + "updates -- FlatDisjunctiveIntervalMap");
+    measure([&]{ runMerges<MapT>(fields, times / 10); }, sz + "merges -- DisjunctiveIntervalMap");
+    measure([&]{ runMerges<FlatMapT>(fields, times / 10); }, sz + "merges -- FlatDisjunctiveIntervalMap");
+}
+
+int main()
+{
+    test(4);
+    test(16);
+    test(64);
+    test(256);
+    test(1024);
+
+    // use the result so that the computation is not optimized away
+    std::cout << "Result: " << result << std::endl;
+}
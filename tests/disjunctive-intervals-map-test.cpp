@@ -9,6 +9,7 @@
 
 #include "dg/analysis/Offset.h"
 #include "dg/analysis/ReachingDefinitions/DisjunctiveIntervalMap.h"
+#include "dg/analysis/ReachingDefinitions/FlatDisjunctiveIntervalMap.h"
 
 using namespace dg::analysis::rd;
 using dg::analysis::Offset;
@@ -453,3 +454,265 @@ TEST_CASE("Split2", "DisjunctiveIntervalMap") {
         std::make_tuple(4,4, 5)
     }));
 }
+
+TEST_CASE("Merge", "DisjunctiveIntervalMap") {
+    DisjunctiveIntervalMap<int, int> M;
+    DisjunctiveIntervalMap<int, int> M2;
+
+    M.add(0,4, 1);
+    M.add(8,9, 1);
+    M2.add(2,6, 2);
+    M2.add(10,12, 2);
+
+    REQUIRE(M.merge(M2));
+    REQUIRE_THAT(M, HasStructure({
+        std::make_tuple(0,1, 1),
+        std::make_tuple(2,4, 1),
+        std::make_tuple(5,6, 2),
+        std::make_tuple(8,9, 1),
+        std::make_tuple(10,12, 2)
+    }));
+
+    // the values were merged to the overlap
+    const auto& CM = M;
+    auto it = CM.le(2,4);
+    REQUIRE(it != CM.end());
+    REQUIRE(it->second.size() == 2);
+
+    // nothing new
+    REQUIRE(!M.merge(M2));
+}
+
+TEST_CASE("MergeFiltered", "DisjunctiveIntervalMap") {
+    DisjunctiveIntervalMap<int, int> M;
+    DisjunctiveIntervalMap<int, int> M2;
+
+    M.add(0,4, 1);
+    M2.add(2,6, 2);
+    M2.add(10,12, 2);
+
+    REQUIRE(M.merge(M2, [](const DisjunctiveIntervalMap<int, int>::IntervalT& I) {
+        return I.start >= 10;
+    }));
+    REQUIRE_THAT(M, HasStructure({
+        std::make_tuple(0,4, 1),
+        std::make_tuple(10,12, 2)
+    }));
+}
+
+TEST_CASE("MergeIncluded", "DisjunctiveIntervalMap") {
+    DisjunctiveIntervalMap<int, int> M;
+    DisjunctiveIntervalMap<int, int> M2;
+
+    M.add(0,10, 1);
+    M.add(0,10, 2);
+    M2.add(2,4, 1);
+    M2.add(6,8, 2);
+
+    REQUIRE(M.includes(M2));
+    REQUIRE(!M2.includes(M));
+
+    // the intervals are not split when nothing is added
+    REQUIRE(!M.merge(M2));
+    REQUIRE(M.size() == 1);
+
+    // a gap is not included
+    M2.add(11,12, 1);
+    REQUIRE(!M.includes(M2));
+    REQUIRE(M.includesWithout(M2, {DisjunctiveIntervalMap<int, int>::IntervalT(11, 12)}));
+    REQUIRE(M.merge(M2));
+    REQUIRE_THAT(M, HasStructure({
+        std::make_tuple(0,10, 1),
+        std::make_tuple(11,12, 1)
+    }));
+}
+
+TEST_CASE("MergeWithout", "DisjunctiveIntervalMap") {
+    DisjunctiveIntervalMap<int, int> M;
+    DisjunctiveIntervalMap<int, int> M2;
+
+    M2.add(0,10, 1);
+    M2.add(20,30, 2);
+
+    // only the bytes that are not overwritten are merged
+    using IntervalT = DisjunctiveIntervalMap<int, int>::IntervalT;
+    std::vector<IntervalT> without{IntervalT(2, 4), IntervalT(3, 6),
+                                   IntervalT(18, 22), IntervalT(30, 40)};
+    REQUIRE(M.mergeWithout(M2, without));
+    REQUIRE_THAT(M, HasStructure({
+        std::make_tuple(0,1, 1),
+        std::make_tuple(7,10, 1),
+        std::make_tuple(23,29, 2)
+    }));
+
+    REQUIRE(M.includesWithout(M2, without));
+    REQUIRE(!M.includes(M2));
+    REQUIRE(!M.mergeWithout(M2, without));
+}
+
+TEST_CASE("MergeRandom", "DisjunctiveIntervalMap") {
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> dist(0, 100);
+
+    for (int n = 0; n < 100; ++n) {
+        DisjunctiveIntervalMap<int, int> M;
+        DisjunctiveIntervalMap<int, int> M2;
+        DisjunctiveIntervalMap<int, int> Expected;
+
+        for (int i = 0; i < 5; ++i) {
+            int a = dist(gen), b = dist(gen);
+            M.add(std::min(a, b), std::max(a, b), i);
+            Expected.add(std::min(a, b), std::max(a, b), i);
+            a = dist(gen), b = dist(gen);
+            M2.add(std::min(a, b), std::max(a, b), 10 + i);
+        }
+
+        bool included = M.includes(M2);
+        REQUIRE(M.merge(M2) == !included);
+        REQUIRE(M.includes(M2));
+        for (const auto& it : M2) {
+            for (int val : it.second)
+                Expected.add(it.first.start, it.first.end, val);
+        }
+
+        // the same values for every byte
+        const auto& CM = M;
+        const auto& CExpected = Expected;
+        for (int i = 0; i <= 100; ++i) {
+            auto it = CM.le(i, i);
+            auto eit = CExpected.le(i, i);
+            REQUIRE((it == CM.end()) == (eit == CExpected.end()));
+            if (it != CM.end())
+                REQUIRE(it->second == eit->second);
+        }
+    }
+}
+
+TEST_CASE("Split inside", "DisjunctiveIntervalMap") {
+    DisjunctiveIntervalMap<int, int> M;
+
+    M.add(0, 10, 0);
+    M.add(20, 30, 1);
+    // the added interval lies inside [0, 10]
+    M.add(4, 6, 2);
+
+    REQUIRE_THAT(M, HasStructure({
+        std::make_tuple(0,3, 0),
+        std::make_tuple(4,6, 0),
+        std::make_tuple(7,10, 0),
+        std::make_tuple(20,30, 1)
+    }));
+
+    const auto& CM = M;
+    auto it = CM.le(7, 7);
+    REQUIRE(it != CM.end());
+    REQUIRE(it->second.size() == 1);
+}
+
+TEST_CASE("Overlaps spanning interval", "DisjunctiveIntervalMap") {
+    DisjunctiveIntervalMap<int, int> M;
+
+    M.add(0, 10, 0);
+    M.add(50, 60, 1);
+    // [5, 6] lies inside [0, 10], the next interval starts after it
+    REQUIRE(M.overlaps(5, 6));
+    REQUIRE(!M.overlaps(11, 49));
+}
+
+// the maps have the same intervals with the same values
+static bool sameMaps(const DisjunctiveIntervalMap<int, int>& M,
+                     const FlatDisjunctiveIntervalMap<int, int>& F) {
+    if (M.size() != F.size())
+        return false;
+
+    auto fit = F.begin();
+    for (const auto& pair : M) {
+        auto fpair = *fit;
+        if (pair.first != fpair.first)
+            return false;
+        if (pair.second.size() != fpair.second.size() ||
+            !std::equal(pair.second.begin(), pair.second.end(),
+                        fpair.second.begin()))
+            return false;
+        ++fit;
+    }
+
+    return true;
+}
+
+TEST_CASE("Flat add", "FlatDisjunctiveIntervalMap") {
+    FlatDisjunctiveIntervalMap<int, int> F;
+    REQUIRE(F.empty());
+    REQUIRE(!F.overlaps(0, 10));
+
+    REQUIRE(F.add(0, 10, 0));
+    REQUIRE(F.add(20, 30, 1));
+    REQUIRE(!F.add(20, 30, 1));
+    REQUIRE(F.add(4, 24, 2));
+    REQUIRE(F.size() == 5);
+
+    REQUIRE(F.interval(0) == FlatDisjunctiveIntervalMap<int, int>::IntervalT(0, 3));
+    REQUIRE(F.interval(1) == FlatDisjunctiveIntervalMap<int, int>::IntervalT(4, 10));
+    REQUIRE(F.interval(2) == FlatDisjunctiveIntervalMap<int, int>::IntervalT(11, 19));
+    REQUIRE(F.interval(3) == FlatDisjunctiveIntervalMap<int, int>::IntervalT(20, 24));
+    REQUIRE(F.interval(4) == FlatDisjunctiveIntervalMap<int, int>::IntervalT(25, 30));
+    REQUIRE(F.values(1).size() == 2);
+    REQUIRE(F.values(1).count(0) == 1);
+    REQUIRE(F.values(1).count(2) == 1);
+    REQUIRE(F.values(2).size() == 1);
+
+    REQUIRE(F.overlapsFull(0, 30));
+    REQUIRE(F.overlapsFull(5, 25));
+    REQUIRE(!F.overlapsFull(0, 31));
+
+    REQUIRE(F.update(2, 22, 3));
+    REQUIRE(!F.update(2, 22, 3));
+    auto it = F.le(15, 15);
+    REQUIRE(it != F.end());
+    REQUIRE((*it).second.size() == 1);
+    REQUIRE((*it).second.count(3) == 1);
+}
+
+TEST_CASE("Flat random", "FlatDisjunctiveIntervalMap") {
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> dist(0, 100);
+
+    for (int n = 0; n < 200; ++n) {
+        DisjunctiveIntervalMap<int, int> M, M2;
+        FlatDisjunctiveIntervalMap<int, int> F, F2;
+
+        for (int i = 0; i < 10; ++i) {
+            int a = dist(gen), b = dist(gen);
+            bool update = dist(gen) < 30;
+            REQUIRE(M.add(std::min(a, b), std::max(a, b), i)
+                    == F.add(std::min(a, b), std::max(a, b), i));
+            if (update) {
+                a = dist(gen), b = dist(gen);
+                REQUIRE(M.update(std::min(a, b), std::max(a, b), 20 + i)
+                        == F.update(std::min(a, b), std::max(a, b), 20 + i));
+            }
+            REQUIRE(sameMaps(M, F));
+
+            a = dist(gen), b = dist(gen);
+            M2.add(std::min(a, b), std::max(a, b), 10 + i);
+            F2.add(std::min(a, b), std::max(a, b), 10 + i);
+        }
+
+        for (int i = 0; i < 20; ++i) {
+            int a = dist(gen), b = dist(gen);
+            REQUIRE(M.overlaps(std::min(a, b), std::max(a, b))
+                    == F.overlaps(std::min(a, b), std::max(a, b)));
+            REQUIRE(M.overlapsFull(std::min(a, b), std::max(a, b))
+                    == F.overlapsFull(std::min(a, b), std::max(a, b)));
+        }
+
+        // merge only the intervals that start in the first half
+        auto keep = [](const DisjunctiveIntervalMap<int, int>::IntervalT& I) {
+            return I.start <= 50;
+        };
+        REQUIRE(M.merge(M2, keep) == F.merge(F2, keep));
+        REQUIRE(sameMaps(M, F));
+        REQUIRE(M.merge(M2) == F.merge(F2));
+        REQUIRE(sameMaps(M, F));
+    }
+}
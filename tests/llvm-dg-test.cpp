@@ -2,7 +2,15 @@
 #include <cstdarg>
 #include <cstdio>
 
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/SourceMgr.h>
+
 #include "dg/llvm/LLVMDependenceGraph.h"
+#include "dg/llvm/LLVMDependenceGraphBuilder.h"
+#include "dg/llvm/LLVMSlicer.h"
+#include "dg/analysis/SliceMembership.h"
 #include "dg/analysis/DFS.h"
 #include "test-runner.h"
 
@@ -55,6 +63,69 @@ struct TestRefcount : public Test
     }
 };
 
+struct TestSliceMembership : public Test
+{
+    TestSliceMembership() : Test("slicing w.r.t. an union of slices") {}
+
+    static unsigned storesNum(llvm::Function *F)
+    {
+        unsigned num = 0;
+        for (llvm::BasicBlock& B : *F) {
+            for (llvm::Instruction& I : B) {
+                if (llvm::isa<llvm::StoreInst>(I))
+                    ++num;
+            }
+        }
+        return num;
+    }
+
+    void test()
+    {
+        llvm::LLVMContext context;
+        llvm::SMDiagnostic SMD;
+        std::unique_ptr<llvm::Module> M = llvm::parseAssemblyString(
+            "define i32 @main() {\n"
+            "  %a = alloca i32\n"
+            "  %b = alloca i32\n"
+            "  store i32 1, i32* %a\n"
+            "  store i32 2, i32* %b\n"
+            "  %x = load i32, i32* %a\n"
+            "  %y = load i32, i32* %b\n"
+            "  ret i32 0\n"
+            "}\n", SMD, context);
+        check(M != nullptr, "Failed parsing the module");
+        if (!M)
+            return;
+
+        llvm::Function *F = M->getFunction("main");
+        llvm::Instruction *x = nullptr, *y = nullptr;
+        for (llvm::Instruction& I : F->getEntryBlock()) {
+            if (I.getName() == "x")
+                x = &I;
+            else if (I.getName() == "y")
+                y = &I;
+        }
+
+        llvmdg::LLVMDependenceGraphBuilder builder(M.get());
+        std::unique_ptr<LLVMDependenceGraph> dg = builder.build();
+
+        analysis::SliceMembership<LLVMNode> slices;
+        LLVMSlicer slicer;
+        slicer.setSliceMembership(&slices);
+        uint32_t sx = slicer.mark(dg->getNode(x));
+        uint32_t sy = slicer.mark(dg->getNode(y));
+        check(slices.getDifference(sx, sy).size() > 0,
+              "The slices should differ");
+
+        // the store to %a is stamped only with sx,
+        // the union must keep it anyway
+        uint32_t su = sy + 1;
+        slices.setSlice(su, slices.getUnion(sx, sy));
+        slicer.slice(dg.get(), nullptr, su);
+        check(storesNum(F) == 2, "The union of slices lost a store");
+    }
+};
+
 }
 }
 
@@ -65,6 +136,7 @@ int main(void)
     TestRunner Runner;
 
     Runner.add(new TestRefcount());
+    Runner.add(new TestSliceMembership());
 
     return Runner();
 }
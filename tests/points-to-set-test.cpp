@@ -10,6 +10,10 @@ using dg::analysis::pta::PSNodeType;
 using dg::analysis::pta::Pointer;
 using dg::analysis::pta::PointerSubgraph;
 using dg::analysis::pta::PointsToSet;
+using dg::analysis::pta::SmallPointsToSet;
+using dg::analysis::pta::SharedPointsToSet;
+using dg::analysis::pta::BitvectorPointsToSet;
+using dg::analysis::Offset;
 
 TEST_CASE("Querying empty set", "PointsToSet") {
     PointsToSet B;
@@ -82,3 +86,381 @@ TEST_CASE("Merge points-to sets", "PointsToSet") {
     REQUIRE(S1.size() == 2);
 }
 
+TEST_CASE("Remove elements", "PointsToSet") {
+    PointsToSet S;
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+
+    REQUIRE(S.add({A, 0}));
+    REQUIRE(S.add({A, 4}));
+    REQUIRE(S.add({B, 0}));
+
+    REQUIRE(S.remove({A, 4}));
+    REQUIRE(!S.remove({A, 4}));
+    REQUIRE(S.pointsToTarget(A));
+    REQUIRE(S.remove({A, 0}));
+    // the target is gone with its last offset
+    REQUIRE(!S.pointsToTarget(A));
+    REQUIRE(S.isSingleton());
+    REQUIRE(S.size() == 1);
+    REQUIRE(*(S.begin()) == Pointer(B, 0));
+}
+
+TEST_CASE("Small set: add and query", "SmallPointsToSet") {
+    SmallPointsToSet S;
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+
+    REQUIRE(S.empty());
+    REQUIRE(S.begin() == S.end());
+    REQUIRE(S.add(Pointer(A, 8)) == true);
+    REQUIRE(S.add(Pointer(A, 0)) == true);
+    REQUIRE(S.add(Pointer(A, 8)) == false);
+    REQUIRE(S.isSingleton());
+    REQUIRE(S.add(Pointer(B, 0)) == true);
+    REQUIRE(!S.isSingleton());
+    REQUIRE(S.isSmall());
+    REQUIRE(S.size() == 3);
+    REQUIRE(S.has({A, 0}));
+    REQUIRE(S.has({A, 8}));
+    REQUIRE(S.has({B, 0}));
+    REQUIRE(!S.has({B, 8}));
+    REQUIRE(S.pointsToTarget(A));
+    REQUIRE(S.mayPointTo({B, 0}));
+
+    size_t n = 0;
+    for (const auto& ptr : S) {
+        REQUIRE(S.has(ptr));
+        ++n;
+    }
+    REQUIRE(n == 3);
+}
+
+TEST_CASE("Small set: unknown offset", "SmallPointsToSet") {
+    SmallPointsToSet S;
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+
+    REQUIRE(S.add(Pointer(A, 0)) == true);
+    REQUIRE(S.add(Pointer(A, 4)) == true);
+    REQUIRE(S.add(Pointer(B, 4)) == true);
+    REQUIRE(S.add(Pointer(A, Offset::UNKNOWN)) == true);
+    REQUIRE(S.size() == 2);
+    REQUIRE(S.has({A, Offset::UNKNOWN}));
+    REQUIRE(!S.has({A, 0}));
+    REQUIRE(S.add(Pointer(A, 8)) == false);
+    REQUIRE(S.add(Pointer(A, Offset::UNKNOWN)) == false);
+    REQUIRE(S.mayPointTo({A, 16}));
+
+    REQUIRE(S.removeAny(A));
+    REQUIRE(S.size() == 1);
+    REQUIRE(S.remove({B, 4}));
+    REQUIRE(S.empty());
+}
+
+TEST_CASE("Small set: lifting", "SmallPointsToSet") {
+    SmallPointsToSet S;
+    PointsToSet R;
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+
+    for (unsigned i = 0; i < 100; ++i) {
+        REQUIRE(S.add(Pointer(i % 2 ? A : B, i)) == R.add(Pointer(i % 2 ? A : B, i)));
+        REQUIRE(S.size() == R.size());
+    }
+
+    REQUIRE(!S.isSmall());
+    for (const auto& ptr : R)
+        REQUIRE(S.has(ptr));
+    for (const auto& ptr : S)
+        REQUIRE(R.has(ptr));
+
+    REQUIRE(S.add(Pointer(A, Offset::UNKNOWN)));
+    REQUIRE(S.size() == 51);
+
+    SmallPointsToSet C(S);
+    REQUIRE(C.size() == 51);
+    REQUIRE(C.has({A, Offset::UNKNOWN}));
+}
+
+TEST_CASE("Small set: merge", "SmallPointsToSet") {
+    SmallPointsToSet S1;
+    SmallPointsToSet S2;
+    SmallPointsToSet S3;
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+
+    REQUIRE(S1.add({A, 0}));
+    REQUIRE(S2.add({B, 0}));
+
+    REQUIRE(S1.merge(S2));
+    REQUIRE(!S1.merge(S2));
+    REQUIRE(S1.has({A, 0}));
+    REQUIRE(S1.has({B, 0}));
+    REQUIRE(S1.size() == 2);
+
+    for (unsigned i = 0; i < 10; ++i)
+        S3.add({A, i});
+    REQUIRE(!S3.isSmall());
+
+    REQUIRE(S1.merge(S3));
+    REQUIRE(!S1.isSmall());
+    REQUIRE(S1.size() == 11);
+    REQUIRE(!S1.merge(S3));
+    REQUIRE(S3.merge(S1));
+    REQUIRE(S3.size() == 11);
+}
+
+TEST_CASE("Shared set: equal sets are stored once", "SharedPointsToSet") {
+    SharedPointsToSet S1;
+    SharedPointsToSet S2;
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+
+    REQUIRE(S1.empty());
+    REQUIRE(S1 == S2);
+    REQUIRE(S1.add({A, 0}));
+    REQUIRE(!S1.add({A, 0}));
+    REQUIRE(S1.add({B, 4}));
+    REQUIRE(S1 != S2);
+
+    // add in different order
+    REQUIRE(S2.add({B, 4}));
+    REQUIRE(S2.add({A, 0}));
+    REQUIRE(S1 == S2);
+    REQUIRE(S1.getID() == S2.getID());
+    REQUIRE(S1.size() == 2);
+    REQUIRE(S2.has({A, 0}));
+    REQUIRE(S2.has({B, 4}));
+
+    REQUIRE(S1.add({A, Offset::UNKNOWN}));
+    REQUIRE(!S1.add({A, 8}));
+    REQUIRE(S1.size() == 2);
+    REQUIRE(S1 != S2);
+    REQUIRE(S2.size() == 2);
+    REQUIRE(S2.has({A, 0}));
+}
+
+TEST_CASE("Shared set: merge", "SharedPointsToSet") {
+    SharedPointsToSet S1;
+    SharedPointsToSet S2;
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+
+    REQUIRE(S1.add({A, 0}));
+    REQUIRE(S2.add({B, 0}));
+
+    SharedPointsToSet S3(S1);
+    REQUIRE(S1.merge(S2));
+    REQUIRE(!S1.merge(S2));
+    REQUIRE(S1.size() == 2);
+    REQUIRE(S3.size() == 1);
+
+    // the result of the same merge is taken from the cache
+    REQUIRE(S3.merge(S2));
+    REQUIRE(S3 == S1);
+    REQUIRE(S2.merge(S3));
+    REQUIRE(S2 == S1);
+}
+
+TEST_CASE("Shared set: copy, move and remove", "SharedPointsToSet") {
+    SharedPointsToSet S;
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+    auto& table = SharedPointsToSet::getTable();
+    table.clearCaches();
+    size_t sets = table.size();
+
+    REQUIRE(S.add({A, 0}));
+    REQUIRE(S.add({A, 4}));
+    REQUIRE(S.add({B, 0}));
+
+    SharedPointsToSet C(S);
+    SharedPointsToSet M(std::move(C));
+    REQUIRE(C.empty());
+    REQUIRE(M == S);
+
+    REQUIRE(S.remove({A, 4}));
+    REQUIRE(!S.remove({A, 4}));
+    REQUIRE(S.size() == 2);
+    REQUIRE(M.size() == 3);
+    REQUIRE(S.removeAny(A));
+    REQUIRE(S.size() == 1);
+    REQUIRE(S.has({B, 0}));
+
+    size_t n = 0;
+    for (const auto& ptr : M) {
+        REQUIRE(M.has(ptr));
+        ++n;
+    }
+    REQUIRE(n == 3);
+
+    REQUIRE(S.remove({B, 0}));
+    REQUIRE(S.empty());
+
+    M = S;
+    REQUIRE(M.empty());
+    // everything is freed, the caches do not hold the sets
+    REQUIRE(table.size() == sets);
+}
+
+TEST_CASE("Shared set: cached operations", "SharedPointsToSet") {
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+    auto& table = SharedPointsToSet::getTable();
+    table.clearCaches();
+    size_t sets = table.size();
+
+    // the intermediate sets are not kept alive
+    SharedPointsToSet S;
+    for (unsigned i = 0; i < 16; ++i)
+        REQUIRE(S.add({A, i}));
+    REQUIRE(S.size() == 16);
+    REQUIRE(table.size() == sets + 1);
+
+    // the freed sets are not taken from the cache
+    SharedPointsToSet S2;
+    REQUIRE(S2.add({A, 0}));
+    REQUIRE(S2.add({A, 1}));
+    REQUIRE(S2.size() == 2);
+    REQUIRE(S2.has({A, 1}));
+
+    SharedPointsToSet S3;
+    REQUIRE(S3.add({B, 0}));
+    REQUIRE(S3.merge(S2));
+    REQUIRE(S3.size() == 3);
+    S3 = SharedPointsToSet();
+    REQUIRE(S2.add({B, 0}));
+    REQUIRE(S2.size() == 3);
+
+    SharedPointsToSet S4;
+    REQUIRE(S4.add({B, 0}));
+    S2 = SharedPointsToSet();
+    REQUIRE(S2.add({A, 8}));
+    REQUIRE(S4.merge(S2));
+    REQUIRE(S4.size() == 2);
+    REQUIRE(S4.has({A, 8}));
+    REQUIRE(S4.has({B, 0}));
+}
+
+TEST_CASE("Bitvector set: add and query", "BitvectorPointsToSet") {
+    BitvectorPointsToSet S;
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+
+    REQUIRE(S.empty());
+    REQUIRE(!S.isSingleton());
+    REQUIRE(!S.pointsToTarget(A));
+    REQUIRE(!S.has({A, 0}));
+    REQUIRE(S.add(Pointer(A, 8)) == true);
+    REQUIRE(S.add(Pointer(A, 0)) == true);
+    REQUIRE(S.add(Pointer(A, 8)) == false);
+    REQUIRE(S.add(Pointer(A, 22332435235)) == true);
+    REQUIRE(S.isSingleton());
+    REQUIRE(S.mustPointTo({A, 8}));
+    REQUIRE(S.add(Pointer(B, 0)) == true);
+    REQUIRE(!S.isSingleton());
+    REQUIRE(S.size() == 4);
+    REQUIRE(S.has({A, 22332435235}));
+    REQUIRE(!S.has({B, 8}));
+    REQUIRE(S.pointsToTarget(A));
+    REQUIRE(S.pointsToTarget(B));
+
+    // the pointers to one target are iterated together
+    size_t n = 0;
+    size_t switches = 0;
+    PSNode *last = nullptr;
+    for (const auto& ptr : S) {
+        REQUIRE(S.has(ptr));
+        if (ptr.target != last)
+            ++switches;
+        last = ptr.target;
+        ++n;
+    }
+    REQUIRE(n == 4);
+    REQUIRE(switches == 2);
+
+    REQUIRE(S.removeAny(A));
+    REQUIRE(!S.removeAny(A));
+    REQUIRE(!S.pointsToTarget(A));
+    REQUIRE(S.isSingleton());
+    REQUIRE(S.remove({B, 0}));
+    REQUIRE(!S.remove({B, 0}));
+    REQUIRE(S.empty());
+}
+
+TEST_CASE("Bitvector set: unknown offset", "BitvectorPointsToSet") {
+    BitvectorPointsToSet S;
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+
+    REQUIRE(S.add(Pointer(A, 0)) == true);
+    REQUIRE(S.add(Pointer(A, 4)) == true);
+    REQUIRE(S.add(Pointer(B, 4)) == true);
+    REQUIRE(S.add(Pointer(A, Offset::UNKNOWN)) == true);
+    REQUIRE(S.size() == 2);
+    REQUIRE(S.has({A, Offset::UNKNOWN}));
+    REQUIRE(!S.has({A, 0}));
+    REQUIRE(S.has({B, 4}));
+    REQUIRE(S.add(Pointer(A, 8)) == false);
+    REQUIRE(S.add(Pointer(A, Offset::UNKNOWN)) == false);
+    REQUIRE(S.mayPointTo({A, 16}));
+    REQUIRE(!S.mayPointTo({B, 16}));
+}
+
+TEST_CASE("Bitvector set: merge", "BitvectorPointsToSet") {
+    BitvectorPointsToSet S1;
+    BitvectorPointsToSet S2;
+    PointsToSet R;
+    PointerSubgraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+
+    for (unsigned i = 0; i < 100; ++i) {
+        REQUIRE(S1.add(Pointer(i % 2 ? A : B, i)) == R.add(Pointer(i % 2 ? A : B, i)));
+        REQUIRE(S1.size() == R.size());
+    }
+
+    REQUIRE(S2.add({B, 1000}));
+    REQUIRE(S2.merge(S1));
+    REQUIRE(!S2.merge(S1));
+    REQUIRE(S2.size() == 101);
+    for (const auto& ptr : R)
+        REQUIRE(S2.has(ptr));
+    REQUIRE(S1.merge(S2));
+    REQUIRE(S1 == S2);
+}
+
+#if defined(POINTS_TO_SET_BITVECTOR)
+TEST_CASE("Bitvector set: destroyed targets", "BitvectorPointsToSet") {
+    using dg::analysis::pta::PointerIdsTable;
+    PointerIdsTable& table = PointerIdsTable::get();
+    size_t targets = table.targetsNum();
+
+    for (int i = 0; i < 10; ++i) {
+        PointerSubgraph PS;
+        PSNode* A = PS.create(PSNodeType::ALLOC);
+        PSNode* B = PS.create(PSNodeType::ALLOC);
+        BitvectorPointsToSet S;
+        REQUIRE(S.add(Pointer(B, 0)));
+        REQUIRE(S.add(Pointer(A, 0)));
+        REQUIRE(table.targetsNum() == targets + 2);
+        for (const auto& ptr : S)
+            REQUIRE((ptr.target == A || ptr.target == B));
+    }
+
+    // the IDs of the destroyed nodes were released
+    REQUIRE(table.targetsNum() == targets);
+}
+#endif
@@ -9,6 +9,9 @@
 #include "dg/analysis/PointsTo/PointerSubgraph.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFI.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFS.h"
+#include "dg/analysis/PointsTo/PointerAnalysisSFS.h"
+#include "dg/analysis/PointsTo/PointerSubgraphOptimizations.h"
+#include "dg/analysis/PointsTo/PointerSubgraphValidator.h"
 
 namespace dg {
 namespace tests {
@@ -19,8 +22,12 @@ using analysis::Offset;
 template <typename PTStoT>
 class PointsToTest : public Test
 {
+    analysis::PointerAnalysisOptions options;
+
 public:
-    PointsToTest(const char *n) : Test(n) {}
+    PointsToTest(const char *n, bool worklist = true) : Test(n) {
+        options.setWorklist(worklist);
+    }
 
     void store_load()
     {
@@ -37,7 +44,7 @@ public:
         S->addSuccessor(L);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L->doesPointsTo(A), "L do not points to A");
@@ -80,7 +87,7 @@ public:
         L2->addSuccessor(L3);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L1->doesPointsTo(A), "not L1->A");
@@ -110,7 +117,7 @@ public:
         S2->addSuccessor(L2);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L1->doesPointsTo(A), "L1 do not points to A");
@@ -141,7 +148,7 @@ public:
         S2->addSuccessor(L2);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L1->doesPointsTo(A, 4), "L1 do not points to A[4]");
@@ -177,7 +184,7 @@ public:
         S2->addSuccessor(L2);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L1->doesPointsTo(A, 4), "L1 do not points to A[4]");
@@ -206,7 +213,7 @@ public:
         GEP2->addSuccessor(L);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(GEP1->doesPointsTo(A, 4), "not GEP1 -> A + 4");
@@ -236,7 +243,7 @@ public:
         GEP3->addSuccessor(L);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(GEP1->doesPointsTo(A, 4), "not GEP1 -> A + 4");
@@ -276,7 +283,7 @@ public:
         L1->addSuccessor(L2);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L1->doesPointsTo(A), "not L1->A");
@@ -317,7 +324,7 @@ public:
         L1->addSuccessor(L2);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L1->doesPointsTo(A), "not L1->A");
@@ -364,7 +371,7 @@ public:
         L1->addSuccessor(L2);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L1->doesPointsTo(A), "not L1->A");
@@ -386,7 +393,7 @@ public:
         S->addSuccessor(L);
 
         PS.setRoot(B);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L->doesPointsTo(NULLPTR), "L do not points to NULL");
@@ -411,7 +418,7 @@ public:
         GEP->addSuccessor(L);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L->doesPointsTo(A), "L do not points to A");
@@ -429,7 +436,7 @@ public:
         B->addSuccessor(L);
 
         PS.setRoot(B);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L->doesPointsTo(NULLPTR), "L do not points to nullptr");
@@ -455,7 +462,7 @@ public:
         GEP2->addSuccessor(L);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         // B points to A + 0 at unknown offset,
@@ -483,7 +490,7 @@ public:
         GEP2->addSuccessor(L);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         // B points to A + 0 at offset 4,
@@ -511,7 +518,7 @@ public:
         GEP2->addSuccessor(L);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L->doesPointsTo(A), "L do not points to A");
@@ -566,7 +573,7 @@ public:
         L1->addSuccessor(L2);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L1->doesPointsTo(A, 3), "L do not points to A + 3");
@@ -622,7 +629,7 @@ public:
         L1->addSuccessor(L2);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L1->doesPointsTo(A, 3), "L1 do not points to A + 3");
@@ -678,7 +685,7 @@ public:
         L1->addSuccessor(L2);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L2->doesPointsTo(A, 12), "L2 do not points to A + 12");
@@ -726,7 +733,7 @@ public:
         L1->addSuccessor(L2);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L1->doesPointsTo(NULLPTR), "L1 does not point to NULL");
@@ -770,7 +777,7 @@ public:
         G4->addSuccessor(L2);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L1->doesPointsTo(A, 3), "L2 do not points to A + 3");
@@ -811,7 +818,7 @@ public:
         CPY->addSuccessor(L1);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L1->doesPointsTo(A, 3), "L2 do not points to A + 3");
@@ -853,7 +860,7 @@ public:
         L2->addSuccessor(L3);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L1->doesPointsTo(NULLPTR), "L1 does not point to NULL");
@@ -901,7 +908,7 @@ public:
         L2->addSuccessor(L3);
 
         PS.setRoot(A);
-        PTStoT PA(&PS);
+        PTStoT PA(&PS, options);
         PA.run();
 
         check(L1->doesPointsTo(A, 3), "L1 does not point A + 3");
@@ -909,6 +916,455 @@ public:
         check(L3->doesPointsTo(NULLPTR), "L3 does not point to NULL");
     }
 
+    // *B = A; *D = C; loop { *D = *B; *B = *D; }
+    static void build_loop(PointerSubgraph& PS)
+    {
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *C = PS.create(PSNodeType::ALLOC);
+        PSNode *D = PS.create(PSNodeType::ALLOC);
+        PSNode *S1 = PS.create(PSNodeType::STORE, A, B);
+        PSNode *S2 = PS.create(PSNodeType::STORE, C, D);
+        PSNode *L1 = PS.create(PSNodeType::LOAD, B);
+        PSNode *S3 = PS.create(PSNodeType::STORE, L1, D);
+        PSNode *L2 = PS.create(PSNodeType::LOAD, D);
+        PSNode *S4 = PS.create(PSNodeType::STORE, L2, B);
+        PSNode *L3 = PS.create(PSNodeType::LOAD, B);
+
+        A->addSuccessor(B);
+        B->addSuccessor(C);
+        C->addSuccessor(D);
+        D->addSuccessor(S1);
+        S1->addSuccessor(S2);
+        S2->addSuccessor(L1);
+        L1->addSuccessor(S3);
+        S3->addSuccessor(L2);
+        L2->addSuccessor(S4);
+        S4->addSuccessor(L1);
+        S4->addSuccessor(L3);
+
+        PS.setRoot(A);
+    }
+
+    void worklist_vs_iterative()
+    {
+        using namespace analysis;
+
+        PointerSubgraph PS1, PS2;
+        build_loop(PS1);
+        build_loop(PS2);
+
+        analysis::PointerAnalysisOptions opts = options;
+        PTStoT PA1(&PS1, opts.setWorklist(true));
+        PA1.run();
+        PTStoT PA2(&PS2, opts.setWorklist(false));
+        PA2.run();
+
+        const auto& nodes1 = PS1.getNodes();
+        const auto& nodes2 = PS2.getNodes();
+        for (size_t i = 1; i < nodes1.size(); ++i) {
+            const auto& pt1 = nodes1[i]->pointsTo;
+            const auto& pt2 = nodes2[i]->pointsTo;
+            check(pt1.size() == pt2.size(), "Different points-to sets of %u",
+                  static_cast<unsigned>(i));
+            for (const auto& ptr : pt1) {
+                PSNode *target = nodes2[ptr.target->getID()].get();
+                check(nodes2[i]->doesPointsTo(target, ptr.offset),
+                      "Different points-to sets of %u", static_cast<unsigned>(i));
+            }
+        }
+
+        PSNode *L3 = nodes1.back().get();
+        check(L3->doesPointsTo(nodes1[1].get()), "L3 do not points to A");
+
+        check(PA1.getStatistics().processedNodes > 0, "No statistics");
+        check(PA1.getStatistics().processedNodes <= PA2.getStatistics().processedNodes,
+              "Worklist processed more nodes than iterations");
+        check(PA2.getStatistics().getProcessed(PSNodeType::STORE) > 0, "No statistics");
+    }
+
+    // the pointers get to the nodes gradually, so the nodes
+    // process them in several steps (if the analysis propagates
+    // only the differences)
+    void delta_propagation()
+    {
+        using namespace analysis;
+
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *C = PS.create(PSNodeType::ALLOC);
+        PSNode *P = PS.create(PSNodeType::ALLOC);
+        PSNode *S1 = PS.create(PSNodeType::STORE, A, P);
+        PSNode *L1 = PS.create(PSNodeType::LOAD, P);
+        PSNode *CAST = PS.create(PSNodeType::CAST, L1);
+        PSNode *GEP = PS.create(PSNodeType::GEP, CAST, 0);
+        PSNode *S2 = PS.create(PSNodeType::STORE, GEP, C);
+        PSNode *S3 = PS.create(PSNodeType::STORE, B, P);
+        PSNode *L2 = PS.create(PSNodeType::LOAD, C);
+
+        A->addSuccessor(B);
+        B->addSuccessor(C);
+        C->addSuccessor(P);
+        P->addSuccessor(S1);
+        S1->addSuccessor(L1);
+        L1->addSuccessor(CAST);
+        CAST->addSuccessor(GEP);
+        GEP->addSuccessor(S2);
+        S2->addSuccessor(S3);
+        S3->addSuccessor(L1);
+        S3->addSuccessor(L2);
+
+        PS.setRoot(A);
+
+        PTStoT PA(&PS, options);
+        PA.run();
+
+        check(L1->doesPointsTo(A), "L1 do not points to A");
+        check(L1->doesPointsTo(B), "L1 do not points to B");
+        check(CAST->doesPointsTo(B), "CAST do not points to B");
+        // the GEP is in a loop, so it may have the offset unknown
+        check(GEP->pointsTo.pointsToTarget(A), "GEP do not points to A");
+        check(GEP->pointsTo.pointsToTarget(B), "GEP do not points to B");
+        check(L2->pointsTo.pointsToTarget(A), "L2 do not points to A");
+        check(L2->pointsTo.pointsToTarget(B), "L2 do not points to B");
+
+        // the differences are not recorded after the analysis
+        for (PSNode *n : {P, L1, CAST, GEP, C})
+            check(!n->recordsAddedPointers(), "Node records added pointers");
+    }
+
+    // a cycle of copy nodes P1 -> C1 -> G -> C2 -> P2 -> P1
+    // (the flow-insensitive analysis collapses it)
+    void collapse_cycles()
+    {
+        using namespace analysis;
+
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *P1 = PS.create(PSNodeType::PHI, A, nullptr);
+        PSNode *C1 = PS.create(PSNodeType::CAST, P1);
+        PSNode *G = PS.create(PSNodeType::GEP, C1, 0);
+        PSNode *C2 = PS.create(PSNodeType::CAST, G);
+        PSNode *P2 = PS.create(PSNodeType::PHI, C2, B, nullptr);
+        PSNode *S = PS.create(PSNodeType::STORE, G, B);
+        PSNode *L = PS.create(PSNodeType::LOAD, B);
+        PSNode *C3 = PS.create(PSNodeType::CAST, C2);
+        P1->addOperand(P2);
+
+        A->addSuccessor(B);
+        B->addSuccessor(P1);
+        P1->addSuccessor(C1);
+        C1->addSuccessor(G);
+        G->addSuccessor(C2);
+        C2->addSuccessor(P2);
+        P2->addSuccessor(P1);
+        P2->addSuccessor(S);
+        S->addSuccessor(L);
+        L->addSuccessor(C3);
+
+        PS.setRoot(A);
+
+        // do not let the GEP get unknown offset
+        analysis::PointerAnalysisOptions opts = options;
+        opts.setPreprocessGeps(false);
+        PTStoT PA(&PS, opts.setCollapseCycles(true));
+        PA.run();
+
+        auto replaced = PA.getReplacedNodes();
+        for (PSNode *n : {P1, C1, G, C2, P2, L, C3}) {
+            PSNode *rep = replaced.get(n);
+            if (!rep)
+                rep = n;
+
+            check(rep->doesPointsTo(A), "%u do not points to A", n->getID());
+            check(rep->doesPointsTo(B), "%u do not points to B", n->getID());
+        }
+
+        if (std::is_same<PTStoT, PointerAnalysisFI>::value && options.worklist) {
+            check(replaced.size() == 4, "The cycle was not collapsed");
+            check(C3->getOperand(0) == replaced.get(C2), "C3 uses collapsed node");
+        } else {
+            check(replaced.size() == 0, "Collapsed nodes in analysis without collapsing");
+        }
+    }
+
+    // a cycle of copy nodes P -> C1 -> C2 -> P without any operand
+    // from outside, the pointers are only in the initial points-to
+    // set of C1. The representative of the collapsed cycle is C1,
+    // it must not stay a CAST without operands.
+    void collapse_closed_cycle()
+    {
+        using namespace analysis;
+
+        // collapsing cycles is done only by the flow-insensitive analysis
+        if (!std::is_same<PTStoT, PointerAnalysisFI>::value)
+            return;
+
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *P = PS.create(PSNodeType::PHI, nullptr);
+        PSNode *C1 = PS.create(PSNodeType::CAST, P);
+        PSNode *C2 = PS.create(PSNodeType::CAST, C1);
+        P->addOperand(C2);
+        C1->addPointsTo(A, 0);
+
+        A->addSuccessor(P);
+        P->addSuccessor(C1);
+        C1->addSuccessor(C2);
+        C2->addSuccessor(P);
+
+        PS.setRoot(A);
+        analysis::PointerAnalysisOptions opts = options;
+        PTStoT PA(&PS, opts.setCollapseCycles(true));
+        PA.run();
+
+        auto replaced = PA.getReplacedNodes();
+        for (PSNode *n : {P, C1, C2}) {
+            PSNode *rep = replaced.get(n);
+            if (!rep)
+                rep = n;
+
+            check(rep->doesPointsTo(A), "%u do not points to A", n->getID());
+        }
+
+        if (options.worklist) {
+            check(replaced.size() == 2, "The cycle was not collapsed");
+            check(replaced.get(P)->getType() == PSNodeType::PHI,
+                  "The representative is not a PHI");
+        }
+    }
+
+    void strong_update()
+    {
+        using namespace analysis;
+
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *C = PS.create(PSNodeType::ALLOC);
+        PSNode *D = PS.create(PSNodeType::ALLOC);
+        PSNode *S1 = PS.create(PSNodeType::STORE, A, B);
+        PSNode *S2 = PS.create(PSNodeType::STORE, A, D);
+        PSNode *L1 = PS.create(PSNodeType::LOAD, B);
+        PSNode *S3 = PS.create(PSNodeType::STORE, C, B);
+        PSNode *N = PS.create(PSNodeType::NOOP);
+        PSNode *L2 = PS.create(PSNodeType::LOAD, B);
+        PSNode *L3 = PS.create(PSNodeType::LOAD, D);
+
+        A->addSuccessor(B);
+        B->addSuccessor(C);
+        C->addSuccessor(D);
+        D->addSuccessor(S1);
+        S1->addSuccessor(S2);
+        S2->addSuccessor(L1);
+        L1->addSuccessor(S3);
+        S3->addSuccessor(N);
+        N->addSuccessor(L2);
+        L2->addSuccessor(L3);
+
+        PS.setRoot(A);
+        PTStoT PA(&PS, options);
+        PA.run();
+
+        check(L1->doesPointsTo(A), "L1 do not points to A");
+        check(L2->doesPointsTo(C), "L2 do not points to C");
+        check(L3->doesPointsTo(A), "L3 do not points to A");
+
+        if (!std::is_same<PTStoT, PointerAnalysisFI>::value) {
+            check(!L1->doesPointsTo(C), "L1 points to C");
+            check(!L2->doesPointsTo(A), "Store to B was not strong update");
+            check(!L3->doesPointsTo(C), "L3 points to C");
+        }
+    }
+
+    // the value stored by S gets to S only in the second
+    // iteration of the loop, then only the load of B is affected
+    void sparse_memory_dependencies()
+    {
+        using namespace analysis;
+
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *H = PS.create(PSNodeType::NOOP);
+        PSNode *G = PS.create(PSNodeType::CAST, A);
+        PSNode *S = PS.create(PSNodeType::STORE, G, B);
+        PSNode *N1 = PS.create(PSNodeType::NOOP);
+        PSNode *N2 = PS.create(PSNodeType::NOOP);
+        PSNode *N3 = PS.create(PSNodeType::NOOP);
+        PSNode *L = PS.create(PSNodeType::LOAD, B);
+
+        A->addSuccessor(B);
+        B->addSuccessor(H);
+        H->addSuccessor(S);
+        S->addSuccessor(N1);
+        N1->addSuccessor(N2);
+        N2->addSuccessor(N3);
+        N3->addSuccessor(L);
+        L->addSuccessor(G);
+        G->addSuccessor(H);
+
+        PS.setRoot(A);
+        PTStoT PA(&PS, options);
+        PA.run();
+
+        check(L->doesPointsTo(A), "L do not points to A");
+
+        // the store is propagated along the def-use chains,
+        // the no-ops are not processed again (even when
+        // the options ask for the iterative solver)
+        if (std::is_same<PTStoT, PointerAnalysisSFS>::value) {
+            size_t noops = PA.getStatistics().getProcessed(PSNodeType::NOOP);
+            check(noops == 4, "Processed %u no-ops",
+                  static_cast<unsigned>(noops));
+        }
+    }
+
+    void shared_memory_objects()
+    {
+        using namespace analysis;
+
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *C = PS.create(PSNodeType::ALLOC);
+        PSNode *S1 = PS.create(PSNodeType::STORE, A, B);
+        PSNode *N1 = PS.create(PSNodeType::NOOP);
+        PSNode *S2 = PS.create(PSNodeType::STORE, A, C);
+        PSNode *J = PS.create(PSNodeType::NOOP);
+        PSNode *L1 = PS.create(PSNodeType::LOAD, B);
+        PSNode *L2 = PS.create(PSNodeType::LOAD, C);
+
+        A->addSuccessor(B);
+        B->addSuccessor(C);
+        C->addSuccessor(S1);
+        S1->addSuccessor(N1);
+        S1->addSuccessor(S2);
+        N1->addSuccessor(J);
+        S2->addSuccessor(J);
+        J->addSuccessor(L1);
+        L1->addSuccessor(L2);
+
+        PS.setRoot(A);
+        PTStoT PA(&PS, options);
+        PA.run();
+
+        check(L1->doesPointsTo(A), "L1 do not points to A");
+        check(L2->doesPointsTo(A), "L2 do not points to A");
+
+        if (std::is_same<PointerAnalysisFS, PTStoT>::value) {
+            using MemoryMapT = PointerAnalysisFS::MemoryMapT;
+            MemoryMapT *mm1 = S1->getData<MemoryMapT>();
+            MemoryMapT *mm2 = S2->getData<MemoryMapT>();
+            MemoryMapT *mmj = J->getData<MemoryMapT>();
+
+            // the objects that did not change are shared
+            check((*mm1)[B] == (*mm2)[B], "Memory object of B is copied in S2");
+            check((*mm1)[B] == (*mmj)[B], "Memory object of B is copied in J");
+            check((*mm2)[C] == (*mmj)[C], "Memory object of C is copied in J");
+        }
+    }
+
+    void optimize_subgraph()
+    {
+        using namespace analysis;
+
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        A->setSize(8);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *N = PS.create(PSNodeType::NOOP);
+        PSNode *G1 = PS.create(PSNodeType::GEP, A, 4);
+        PSNode *G2 = PS.create(PSNodeType::GEP, A, 4);
+        PSNode *P = PS.create(PSNodeType::PHI, G2, G2, nullptr);
+        PSNode *S = PS.create(PSNodeType::STORE, P, B);
+        PSNode *L1 = PS.create(PSNodeType::LOAD, B);
+        PSNode *L2 = PS.create(PSNodeType::LOAD, B);
+        PSNode *C = PS.create(PSNodeType::CAST, L2);
+        PSNode *S2 = PS.create(PSNodeType::STORE, C, A);
+
+        A->addSuccessor(B);
+        B->addSuccessor(N);
+        N->addSuccessor(G1);
+        G1->addSuccessor(G2);
+        G2->addSuccessor(P);
+        P->addSuccessor(S);
+        S->addSuccessor(L1);
+        L1->addSuccessor(L2);
+        L2->addSuccessor(C);
+        C->addSuccessor(S2);
+
+        PS.setRoot(A);
+
+        bool fi = std::is_same<PTStoT, PointerAnalysisFI>::value;
+        PointerSubgraphOptimizer optimizer(&PS, {A});
+        optimizer.setFlowInsensitive(fi);
+        unsigned removed = optimizer.run();
+
+        // NOOP, G2, P and C (+ L2 in flow-insensitive analysis)
+        check(removed == (fi ? 5u : 4u), "Removed %u nodes", removed);
+        check(optimizer.getMapping().get(G2) == G1, "G2 not merged to G1");
+        check(optimizer.getMapping().get(P) == G1, "P not mapped to G1");
+        check(S->getOperand(0) == G1, "Store does not use G1");
+        if (fi)
+            check(optimizer.getMapping().get(C) == L1, "C not mapped to L1");
+
+        debug::PointerSubgraphValidator validator(&PS);
+        check(!validator.validate(), "Optimized graph is broken: %s",
+              validator.getErrors().c_str());
+
+        PTStoT PA(&PS, options);
+        PA.run();
+
+        check(L1->doesPointsTo(A, 4), "L1 do not points to A + 4");
+        PSNode *L = optimizer.getMapping().get(C);
+        check(L->doesPointsTo(A, 4), "C do not points to A + 4");
+    }
+
+    void optimize_subgraph_branches()
+    {
+        using namespace analysis;
+
+        // the casts are in different branches, so none of them
+        // dominates the other and they must not be merged.
+        // The casts in one branch are merged.
+        PointerSubgraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *C1 = PS.create(PSNodeType::CAST, A);
+        PSNode *C2 = PS.create(PSNodeType::CAST, A);
+        PSNode *C3 = PS.create(PSNodeType::CAST, A);
+        PSNode *S1 = PS.create(PSNodeType::STORE, C1, B);
+        PSNode *S2 = PS.create(PSNodeType::STORE, C3, B);
+        PSNode *L = PS.create(PSNodeType::LOAD, B);
+
+        A->addSuccessor(B);
+        B->addSuccessor(C1);
+        B->addSuccessor(C2);
+        C1->addSuccessor(S1);
+        C2->addSuccessor(C3);
+        C3->addSuccessor(S2);
+        S1->addSuccessor(L);
+        S2->addSuccessor(L);
+
+        PS.setRoot(A);
+
+        PSEquivalentValuesMerger merger(&PS);
+        unsigned merged = merger.run();
+
+        check(merged == 1u, "Merged %u nodes", merged);
+        check(merger.getMapping().get(C3) == C2, "C3 not merged to C2");
+        check(merger.getMapping().get(C2) == nullptr, "C2 was merged");
+        check(S2->getOperand(0) == C2, "Store does not use C2");
+
+        PTStoT PA(&PS, options);
+        PA.run();
+
+        check(L->doesPointsTo(A), "L do not points to A");
+    }
+
     void test()
     {
         store_load();
@@ -935,6 +1391,15 @@ public:
         memcpy_test6();
         memcpy_test7();
         memcpy_test8();
+        worklist_vs_iterative();
+        delta_propagation();
+        collapse_cycles();
+        collapse_closed_cycle();
+        strong_update();
+        shared_memory_objects();
+        sparse_memory_dependencies();
+        optimize_subgraph();
+        optimize_subgraph_branches();
     }
 };
 
@@ -956,6 +1421,42 @@ public:
           ("flow-sensitive points-to test") {}
 };
 
+class FlowInsensitiveIterativePointsToTest
+    : public PointsToTest<analysis::pta::PointerAnalysisFI>
+{
+public:
+    FlowInsensitiveIterativePointsToTest()
+        : PointsToTest<analysis::pta::PointerAnalysisFI>
+          ("flow-insensitive points-to test (iterative)", false) {}
+};
+
+class FlowSensitiveIterativePointsToTest
+    : public PointsToTest<analysis::pta::PointerAnalysisFS>
+{
+public:
+    FlowSensitiveIterativePointsToTest()
+        : PointsToTest<analysis::pta::PointerAnalysisFS>
+          ("flow-sensitive points-to test (iterative)", false) {}
+};
+
+class SparseFlowSensitivePointsToTest
+    : public PointsToTest<analysis::pta::PointerAnalysisSFS>
+{
+public:
+    SparseFlowSensitivePointsToTest()
+        : PointsToTest<analysis::pta::PointerAnalysisSFS>
+          ("sparse flow-sensitive points-to test") {}
+};
+
+class SparseFlowSensitiveIterativePointsToTest
+    : public PointsToTest<analysis::pta::PointerAnalysisSFS>
+{
+public:
+    SparseFlowSensitiveIterativePointsToTest()
+        : PointsToTest<analysis::pta::PointerAnalysisSFS>
+          ("sparse flow-sensitive points-to test (iterative options)", false) {}
+};
+
 class PSNodeTest : public Test
 {
 
@@ -995,6 +1496,10 @@ int main(void)
 
     Runner.add(new FlowInsensitivePointsToTest());
     Runner.add(new FlowSensitivePointsToTest());
+    Runner.add(new FlowInsensitiveIterativePointsToTest());
+    Runner.add(new FlowSensitiveIterativePointsToTest());
+    Runner.add(new SparseFlowSensitivePointsToTest());
+    Runner.add(new SparseFlowSensitiveIterativePointsToTest());
     Runner.add(new PSNodeTest());
 
     return Runner();
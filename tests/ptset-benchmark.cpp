@@ -1,6 +1,8 @@
 #include <vector>
 #include <string>
 #include <random>
+#include <fstream>
+#include <sstream>
 
 #include "dg/analysis/PointsTo/PointsToSet.h"
 #include "../tools/TimeMeasure.h"
@@ -19,12 +21,31 @@ std::uniform_int_distribution<uint64_t> distribution(0, ~static_cast<uint64_t>(0
     tm.stop(); \
     tm.report(" -- PointsToSet bitvector took"); \
     tm.start(); \
+    for (int i = 0; i < times; ++i) \
+        func<SmallPointsToSet>(); \
+    tm.stop(); \
+    tm.report(" -- PointsToSet small-vector took"); \
+    tm.start(); \
+    for (int i = 0; i < times; ++i) \
+        func<BitvectorPointsToSet>(); \
+    tm.stop(); \
+    tm.report(" -- PointsToSet single bitvector took"); \
+    tm.start(); \
     for (int i = 0; i < times; ++i) \
         func<SimplePointsToSet>(); \
     tm.stop(); \
     tm.report(" -- PointsToSet std::set took"); \
     } while(0);
 
+#define runOne(func, type, name) do { \
+    dg::debug::TimeMeasure tm; \
+    tm.start(); \
+    for (int i = 0; i < times; ++i) \
+        func<type>(); \
+    tm.stop(); \
+    tm.report(" -- PointsToSet " name " took"); \
+    } while(0);
+
 template <typename PTSetT>
 void test1() {
     PTSetT S;
@@ -82,12 +103,71 @@ void test5() {
 
     PTSetT S;
     for (int i = 0; i < 1000; ++i) {
-        S.add(reinterpret_cast<PSNode *>(i), i);
+        S.add(reinterpret_cast<PSNode *>(i + 1), i);
     }
 }
 
+template <typename PTSetT>
+void test6() {
+    PSNode * pointers[] {
+        reinterpret_cast<PSNode *>(0x1),
+        reinterpret_cast<PSNode *>(0x2),
+        reinterpret_cast<PSNode *>(0x3)
+    };
 
-int main()
+    // merge a lot of small sets, that is the most
+    // common operation in the pointer analysis
+    PTSetT S;
+    for (int i = 0; i < 100; ++i) {
+        PTSetT S2;
+        S2.add(pointers[i % 3], i % 2 ? 0 : 8);
+        S.merge(S2);
+    }
+}
+
+// points-to sets dumped by 'llvm-ps-dump -dump-ptsets FILE'.
+// Each line is one set of 'target:offset' pairs,
+// where the target is the ID of the PSNode.
+static std::vector<std::vector<std::pair<uint64_t, uint64_t>>> dumpedSets;
+
+static bool loadSets(const char *path) {
+    std::ifstream in(path);
+    if (!in.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        std::vector<std::pair<uint64_t, uint64_t>> set;
+        uint64_t target, offset;
+        char colon;
+        while (ss >> target >> colon >> offset)
+            set.emplace_back(target, offset);
+        dumpedSets.push_back(std::move(set));
+    }
+
+    return true;
+}
+
+template <typename PTSetT>
+void test7() {
+    std::vector<PTSetT> sets;
+    sets.reserve(dumpedSets.size());
+
+    for (auto& dumped : dumpedSets) {
+        sets.emplace_back();
+        for (auto& ptr : dumped)
+            sets.back().add(reinterpret_cast<PSNode *>(ptr.first + 1),
+                            ptr.second);
+    }
+
+    // merge neighbouring sets, similarly to what happens
+    // when the values flow through the graph
+    for (size_t i = 1; i < sets.size(); ++i)
+        sets[i].merge(sets[i - 1]);
+}
+
+int main(int argc, char *argv[])
 {
     int times;
     times = 100000;
@@ -104,4 +184,21 @@ int main()
 
     times = 10000;
     run(test5, "Adding 1000 different pointers");
+
+    times = 10000;
+    run(test6, "Merging 100 small sets");
+    // shared sets copy the set on every insertion,
+    // so it makes sense to run them only on merging
+    runOne(test6, SharedPointsToSet, "shared");
+
+    if (argc > 1) {
+        if (!loadSets(argv[1])) {
+            std::cerr << "Failed opening " << argv[1] << "\n";
+            return 1;
+        }
+
+        times = 10;
+        run(test7, "Building and merging dumped sets");
+        runOne(test7, SharedPointsToSet, "shared");
+    }
 }
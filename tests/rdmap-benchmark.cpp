@@ -1,5 +1,6 @@
 #include <vector>
 #include <string>
+#include <cstdlib>
 
 #include "dg/analysis/ReachingDefinitions/RDMap.h"
 #include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
@@ -7,6 +8,7 @@
 
 // create two random rd maps of the
 // size 'size' and merge them
+template <typename MapT>
 void run(int size, int times = 100000)
 {
     using namespace dg::analysis::rd;
@@ -14,11 +16,11 @@ void run(int size, int times = 100000)
     std::vector<RDNode> rdnodes(size, RDNode());
 
     while (--times > 0) {
-        RDMap A, B;
+        MapT A, B;
 
         // fill in the maps randomly
         for (int i = 0; i < size; ++i) {
-            const DefSite& ds = DefSite(&rdnodes[rand() % size], rand(), rand());
+            const DefSite& ds = DefSite(&rdnodes[rand() % size], rand(), rand() % RAND_MAX + 1);
             A.add(ds, &rdnodes[rand() % size]);
             for (int j = 0; j < size; ++j) {
                 A.update(ds, &rdnodes[rand() % size]);
@@ -26,7 +28,7 @@ void run(int size, int times = 100000)
         }
 
         for (int i = 0; i < size; ++i) {
-            const DefSite& ds = DefSite(&rdnodes[rand() % size], rand(), rand());
+            const DefSite& ds = DefSite(&rdnodes[rand() % size], rand(), rand() % RAND_MAX + 1);
             B.add(ds, &rdnodes[rand() % size]);
             for (int j = 0; j < size; ++j) {
                 B.update(ds, &rdnodes[rand() % size]);
@@ -39,19 +41,33 @@ void run(int size, int times = 100000)
 
 }
 
-void test(int size)
+template <typename MapT>
+void test(int size, const char *name)
 {
     dg::debug::TimeMeasure tm;
     std::string msg = "[200000 iter] Sets of size max ";
     msg += std::to_string(size);
     msg += " -- ";
+    msg += name;
+    msg += " took";
+
+    // use the same random maps for both implementations
+    srand(size);
 
     tm.start();
-    run(size, 200000);
+    run<MapT>(size, 200000);
     tm.stop();
     tm.report(msg.c_str());
 }
 
+void test(int size)
+{
+    using namespace dg::analysis::rd;
+
+    test<BasicRDMap>(size, "BasicRDMap");
+    test<IntervalRDMap>(size, "IntervalRDMap");
+}
+
 int main()
 {
     test(1);
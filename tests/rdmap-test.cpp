@@ -9,6 +9,7 @@
 
 #include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
 #include "dg/analysis/ReachingDefinitions/RDMap.h"
+#include "dg/analysis/ReachingDefinitions/SparseRDGraph.h"
 
 using namespace dg::analysis;
 using namespace dg::analysis::rd;
@@ -117,3 +118,205 @@ TEST_CASE("iterator", "DisjunctiveIntervalMap") {
 */
 
 
+
+TEST_CASE("IntervalRDMap singleton set", "IntervalRDMap") {
+    IntervalRDMap M;
+    REQUIRE(M.empty());
+
+    M.add(DefSite(&A, 0, 4), &B);
+    REQUIRE(!M.empty());
+    REQUIRE(M.size() == 1);
+
+    // check full and partial overlap
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 1; j < 10; ++j) {
+            std::set<RDNode *> rd;
+            M.get(&A, i, j, rd);
+            REQUIRE(rd.size() == 1);
+            REQUIRE(*(rd.begin()) == &B);
+        }
+    }
+
+    // no overlap
+    std::set<RDNode *> rd;
+    M.get(&A, 4, 4, rd);
+    REQUIRE(rd.empty());
+    M.get(&B, 0, 4, rd);
+    REQUIRE(rd.empty());
+
+    // unknown offset overlaps everything
+    M.get(&A, Offset::UNKNOWN, 1, rd);
+    REQUIRE(rd.size() == 1);
+}
+
+TEST_CASE("IntervalRDMap iterator", "IntervalRDMap") {
+    IntervalRDMap M;
+    REQUIRE(M.begin() == M.end());
+
+    M.add(DefSite(&A, 0, 4), &B);
+    M.add(DefSite(&A, 2, 4), &C);
+    M.add(DefSite(&B), &C);
+
+    std::vector<std::pair<DefSite, std::set<RDNode *>>> defs;
+    for (const auto& it : M)
+        defs.emplace_back(it.first, std::set<RDNode *>(it.second.begin(),
+                                                       it.second.end()));
+
+    REQUIRE(defs.size() == 4);
+    REQUIRE(M.size() == 4);
+
+    size_t found = 0;
+    for (const auto& d : defs) {
+        if (d.first.target == &A) {
+            REQUIRE(!d.first.offset.isUnknown());
+            if (*d.first.offset == 0) {
+                REQUIRE(*d.first.len == 2);
+                REQUIRE(d.second == std::set<RDNode *>{&B});
+            } else if (*d.first.offset == 2) {
+                REQUIRE(*d.first.len == 2);
+                REQUIRE(d.second == (std::set<RDNode *>{&B, &C}));
+            } else {
+                REQUIRE(*d.first.offset == 4);
+                REQUIRE(*d.first.len == 2);
+                REQUIRE(d.second == std::set<RDNode *>{&C});
+            }
+        } else {
+            REQUIRE(d.first.target == &B);
+            REQUIRE(d.first.offset.isUnknown());
+            REQUIRE(d.second == std::set<RDNode *>{&C});
+        }
+        ++found;
+    }
+    REQUIRE(found == 4);
+}
+
+TEST_CASE("IntervalRDMap merge", "IntervalRDMap") {
+    IntervalRDMap M1, M2;
+
+    M1.add(DefSite(&A, 0, 4), &B);
+    M2.add(DefSite(&A, 2, 4), &C);
+
+    REQUIRE(M1.merge(&M2));
+    REQUIRE(!M1.merge(&M2));
+
+    std::set<RDNode *> rd;
+    M1.get(&A, 2, 2, rd);
+    REQUIRE(rd == (std::set<RDNode *>{&B, &C}));
+
+    rd.clear();
+    M1.get(&A, 0, 2, rd);
+    REQUIRE(rd == std::set<RDNode *>{&B});
+
+    // the merged map does not change the original one
+    rd.clear();
+    M2.get(&A, 0, 2, rd);
+    REQUIRE(rd.empty());
+
+    // the definitions shared with M1 are copied on write
+    IntervalRDMap M3;
+    REQUIRE(M3.merge(&M2));
+    M3.update(DefSite(&A, 2, 4), &B);
+    rd.clear();
+    M2.get(&A, 2, 4, rd);
+    REQUIRE(rd == std::set<RDNode *>{&C});
+}
+
+TEST_CASE("IntervalRDMap strong update", "IntervalRDMap") {
+    IntervalRDMap M1, M2;
+
+    M2.add(DefSite(&A, 0, 8), &B);
+    M2.add(DefSite(&A, 2, 4), &C);
+
+    // the bytes 2-5 are overwritten
+    DefSiteSetT overwrites{DefSite(&A, 2, 4)};
+    REQUIRE(M1.merge(&M2, &overwrites));
+
+    std::set<RDNode *> rd;
+    M1.get(&A, 2, 4, rd);
+    REQUIRE(rd.empty());
+
+    M1.get(&A, 0, 2, rd);
+    REQUIRE(rd == std::set<RDNode *>{&B});
+
+    rd.clear();
+    M1.get(&A, 6, 2, rd);
+    REQUIRE(rd == std::set<RDNode *>{&B});
+
+    // only the overwritten bytes of a definition are removed
+    IntervalRDMap M3, M4;
+    M4.add(DefSite(&A, 0, 8), &B);
+    REQUIRE(M3.merge(&M4, &overwrites));
+    REQUIRE(!M3.merge(&M4, &overwrites));
+
+    rd.clear();
+    M3.get(&A, 2, 4, rd);
+    REQUIRE(rd.empty());
+
+    M3.get(&A, 0, 8, rd);
+    REQUIRE(rd == std::set<RDNode *>{&B});
+}
+
+static size_t numEdges(const srg::SparseRDGraph::edges_range& range) {
+    return std::distance(range.begin(), range.end());
+}
+
+TEST_CASE("SparseRDGraph edges", "SparseRDGraph") {
+    RDNode X, Y, Z;
+    srg::SparseRDGraph G(false, true /* removable */);
+
+    G.addEdge(&X, DefSite(&A, 0, 4), &Y);
+    G.addEdge(&X, DefSite(&B, 0, 4), &Z);
+    G.addEdge(&Y, DefSite(&A, 0, 4), &Z);
+
+    REQUIRE(G.size() == 3);
+    REQUIRE(G.contains(&X));
+    REQUIRE(G.contains(&Z));
+    REQUIRE(!G.contains(&C));
+    REQUIRE(G.getNode(G.getId(&Y)) == &Y);
+    REQUIRE(numEdges(G.edges(&X)) == 2);
+    REQUIRE(numEdges(G.edges(&Y)) == 1);
+    REQUIRE(G.edges(&Z).empty());
+    REQUIRE(G.edges(&C).empty());
+
+    REQUIRE(G.removeEdge(&X, DefSite(&A, 0, 4), &Y));
+    REQUIRE(!G.removeEdge(&X, DefSite(&A, 0, 4), &Y));
+    REQUIRE(!G.removeEdge(&X, DefSite(&A, 0, 4), &Z));
+    REQUIRE(numEdges(G.edges(&X)) == 1);
+    REQUIRE(G.edges(&X).begin()->second == &Z);
+
+    G.compact();
+    REQUIRE(G.size() == 3);
+    REQUIRE(numEdges(G.edges(&X)) == 1);
+    REQUIRE(G.edges(&X).begin()->second == &Z);
+    REQUIRE(numEdges(G.edges(&Y)) == 1);
+    REQUIRE(G.edges(&Z).empty());
+}
+
+TEST_CASE("SparseRDGraph reversed edges", "SparseRDGraph") {
+    RDNode X, Y, Z;
+    srg::SparseRDGraph G(true /* keep reversed edges */, true /* removable */);
+
+    G.addEdge(&X, DefSite(&A, 0, 4), &Z);
+    G.addEdge(&Y, DefSite(&A, 0, 4), &Z);
+
+    REQUIRE(numEdges(G.reverseEdges(&Z)) == 2);
+    REQUIRE(G.reverseEdges(&X).empty());
+
+    G.removeEdge(&X, DefSite(&A, 0, 4), &Z);
+    REQUIRE(numEdges(G.reverseEdges(&Z)) == 1);
+    REQUIRE(G.reverseEdges(&Z).begin()->second == &Y);
+
+    // the same edge twice is removed one by one
+    G.addEdge(&X, DefSite(&B, 0, 4), &Z);
+    G.addEdge(&X, DefSite(&B, 0, 4), &Z);
+    REQUIRE(numEdges(G.edges(&X)) == 2);
+    REQUIRE(numEdges(G.reverseEdges(&Z)) == 3);
+
+    REQUIRE(G.removeEdge(&X, DefSite(&B, 0, 4), &Z));
+    REQUIRE(numEdges(G.edges(&X)) == 1);
+    REQUIRE(numEdges(G.reverseEdges(&Z)) == 2);
+    REQUIRE(G.removeEdge(&X, DefSite(&B, 0, 4), &Z));
+    REQUIRE(!G.removeEdge(&X, DefSite(&B, 0, 4), &Z));
+    REQUIRE(G.edges(&X).empty());
+    REQUIRE(numEdges(G.reverseEdges(&Z)) == 1);
+}
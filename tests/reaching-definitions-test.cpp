@@ -8,6 +8,7 @@
 
 #include "dg/analysis/ReachingDefinitions/ReachingDefinitions.h"
 #include "dg/analysis/ReachingDefinitions/RDMap.h"
+#include "dg/analysis/ReachingDefinitions/SemisparseRda.h"
 
 namespace dg {
 namespace tests {
@@ -179,7 +180,7 @@ public:
         check(rd.size() == 0, "Should not have r.d.");
     }
 
-    void basic4()
+    void basic4(bool blocks, bool interval_maps = false)
     {
         RDNode AL1;
         RDNode AL2;
@@ -199,10 +200,23 @@ public:
         AL2.addSuccessor(&S1);
         S1.addSuccessor(&S2);
 
-        ReachingDefinitionsAnalysis RD(&AL1);
+        analysis::ReachingDefinitionsAnalysisOptions opts;
+        opts.setBlocks(blocks);
+        opts.setIntervalMaps(interval_maps);
+        ReachingDefinitionsAnalysis RD(&AL1, opts);
         RD.run();
 
         std::set<RDNode *> rd;
+        // the nodes form one block, S1 gets its definitions on demand
+        S1.getReachingDefinitions(&AL1, 2, 1, rd);
+        check(rd.size() == 1, "Should have had one r.d.");
+        check(*(rd.begin()) == &S1, "Should be S1");
+        // the preceding nodes got their definitions on the way
+        check(!AL1.resolver && !AL2.resolver, "Nodes before S1 not resolved");
+        rd.clear();
+        AL2.getReachingDefinitions(&AL1, 0, 4, rd);
+        check(rd.size() == 0, "Should not have r.d.");
+
         // bytes 0 and 1 should be defined on S1
         S2.getReachingDefinitions(&AL1, 0, 1, rd);
         check(rd.size() == 1, "Should have had one r.d.");
@@ -212,13 +226,25 @@ public:
         check(rd.size() == 1, "Should have had one r.d.");
         check(*(rd.begin()) == &S1, "Should be S1");
 
-        // bytes 2 and 3 should be defined on both S1 and S2
-        rd.clear();
-        S2.getReachingDefinitions(&AL1, 2, 1, rd);
-        check(rd.size() == 2, "Should have two r.d.");
-        rd.clear();
-        S2.getReachingDefinitions(&AL1, 3, 1, rd);
-        check(rd.size() == 2, "Should have two r.d.");
+        if (interval_maps) {
+            // the interval maps overwrite exactly the bytes 2 and 3
+            rd.clear();
+            S2.getReachingDefinitions(&AL1, 2, 1, rd);
+            check(rd.size() == 1, "Should have had one r.d.");
+            check(*(rd.begin()) == &S2, "Should be S2");
+            rd.clear();
+            S2.getReachingDefinitions(&AL1, 3, 1, rd);
+            check(rd.size() == 1, "Should have had one r.d.");
+            check(*(rd.begin()) == &S2, "Should be S2");
+        } else {
+            // bytes 2 and 3 should be defined on both S1 and S2
+            rd.clear();
+            S2.getReachingDefinitions(&AL1, 2, 1, rd);
+            check(rd.size() == 2, "Should have two r.d.");
+            rd.clear();
+            S2.getReachingDefinitions(&AL1, 3, 1, rd);
+            check(rd.size() == 2, "Should have two r.d.");
+        }
 
         rd.clear();
         S2.getReachingDefinitions(&AL1, 4, 1, rd);
@@ -237,12 +263,133 @@ public:
         //dumpMap(&S2);
     }
 
+    void loop(bool worklist, bool blocks = false)
+    {
+        RDNode AL;
+        RDNode S1;
+        RDNode H;
+        RDNode S2;
+        RDNode L;
+        RDNode E;
+
+        S1.addDef(&AL, 0, 4, true /* strong update */);
+        S2.addDef(&AL, 0, 4, true /* strong update */);
+        S2.addDef(&AL, 4, 4, true /* strong update */);
+
+        // AL -> S1 -> H -> S2 -> L -> H
+        //             |
+        //             E
+        AL.addSuccessor(&S1);
+        S1.addSuccessor(&H);
+        H.addSuccessor(&S2);
+        S2.addSuccessor(&L);
+        L.addSuccessor(&H);
+        H.addSuccessor(&E);
+
+        analysis::ReachingDefinitionsAnalysisOptions opts;
+        opts.setWorklist(worklist);
+        opts.setBlocks(blocks);
+        ReachingDefinitionsAnalysis RD(&AL, opts);
+        RD.run();
+
+        std::set<RDNode *> rd;
+        E.getReachingDefinitions(&AL, 0, 1, rd);
+        check(rd.size() == 2, "Should have two r.d.");
+        rd.clear();
+        E.getReachingDefinitions(&AL, 4, 1, rd);
+        check(rd.size() == 1, "Should have had one r.d.");
+        check(*(rd.begin()) == &S2, "Should be S2");
+        rd.clear();
+        // S2 overwrites the definition from S1
+        L.getReachingDefinitions(&AL, 0, 1, rd);
+        check(rd.size() == 1, "Should have had one r.d.");
+        check(*(rd.begin()) == &S2, "Should be S2");
+        rd.clear();
+        S2.getReachingDefinitions(&AL, 0, 1, rd);
+        check(rd.size() == 1, "Should have had one r.d.");
+        rd.clear();
+        // the definitions from S1 and S2 reach H
+        H.getReachingDefinitions(&AL, 0, 1, rd);
+        check(rd.size() == 2, "Should have two r.d.");
+
+        const auto& stats = RD.getStatistics();
+        check(stats.maxMapSize > 0, "Should have non-empty maps");
+        if (blocks) {
+            // blocks AL-S1, H, S2-L and E
+            check(stats.processedNodes >= 4, "Every block should be processed");
+            check(stats.processedNodes <= 6, "Processed too many blocks");
+            return;
+        }
+
+        check(stats.processedNodes >= 6, "Every node should be processed");
+        if (worklist) {
+            // only the loop is processed for the second time
+            check(stats.processedNodes <= 9, "Processed too many nodes");
+        }
+    }
+
+    void semisparse(bool on_demand)
+    {
+        RDNode AL(RDNodeType::ALLOC);
+        RDNode S1(RDNodeType::STORE);
+        RDNode L1(RDNodeType::LOAD);
+        RDNode S2(RDNodeType::STORE);
+        RDNode L2(RDNodeType::LOAD);
+
+        AL.setSize(8);
+        S1.addDef(&AL, 0, 4, true /* strong update */);
+        S2.addDef(&AL, 0, 4, true /* strong update */);
+        L1.addUse(&AL, 0, 4);
+        L2.addUse(&AL, 0, 4);
+
+        // B1: AL, S1 -> B2: L1, S2 -> B2
+        //                    |
+        //                    B3: L2
+        BBlock<RDNode> B1(&AL), B2(&L1), B3(&L2);
+        B1.append(&S1);
+        B2.append(&S2);
+        B1.addSuccessor(&B2);
+        B2.addSuccessor(&B2);
+        B2.addSuccessor(&B3);
+
+        analysis::ReachingDefinitionsAnalysisOptions opts;
+        opts.setOnDemand(on_demand);
+        SemisparseRda RD(&AL, opts);
+        RD.run();
+
+        std::set<RDNode *> rd;
+        // query L2 first too, its edges are then resolved (and released)
+        // before L1 is queried
+        if (on_demand) {
+            L2.getReachingDefinitions(&AL, 0, 4, rd);
+            rd.clear();
+        }
+
+        // the definition from S1 and from the previous iteration
+        L1.getReachingDefinitions(&AL, 0, 4, rd);
+        check(rd.size() == 2, "Should have two r.d.");
+        check(rd.count(&S1) == 1 && rd.count(&S2) == 1, "Should be S1 and S2");
+
+        rd.clear();
+        L2.getReachingDefinitions(&AL, 0, 4, rd);
+        check(rd.size() == 1, "Should have had one r.d.");
+        check(*(rd.begin()) == &S2, "Should be S2");
+    }
+
     void test()
     {
         basic1();
         basic2();
         basic3();
-        basic4();
+        basic4(false /* blocks */);
+        basic4(true /* blocks */);
+        basic4(false, true /* interval maps */);
+        basic4(true, true /* interval maps */);
+        loop(true /* worklist */);
+        loop(false /* iterative */);
+        loop(true, true /* blocks */);
+        semisparse(false /* on demand */);
+        semisparse(true /* on demand */);
     }
 };
 
@@ -0,0 +1,72 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cstdlib>
+
+#include "test-dg.h"
+#include "dg/analysis/Slicing.h"
+#include "../tools/TimeMeasure.h"
+
+using namespace dg::tests;
+using dg::analysis::Slicer;
+using dg::analysis::SliceMembership;
+
+std::default_random_engine generator;
+
+#define run(func, msg) do { \
+    std::cout << "Running " << msg << "\n"; \
+    dg::debug::TimeMeasure tm; \
+    tm.start(); \
+    func(); \
+    tm.stop(); \
+    tm.report(" -- " msg " took"); \
+    } while(0);
+
+static const size_t NODES_NUM = 500000;
+
+static TestDG graph;
+static std::vector<TestNode *> nodes;
+static SliceMembership<TestNode> slices;
+static uint32_t slice_id = 0;
+
+// every node depends on few nodes with a bit lower key
+// and on one random node with lower key, so the slice
+// of the last node covers most of the graph
+static void createGraph() {
+    RandomGraph rg;
+    rg.nearDataDeps = 2;
+    rg.controlEvery = 5;
+    nodes = rg.create(graph, NODES_NUM - 1, generator);
+}
+
+static void markWith(unsigned threads) {
+    Slicer<TestNode> slicer;
+    slicer.setThreads(threads);
+    slicer.setSliceMembership(&slices);
+    slicer.mark(nodes.back(), ++slice_id);
+}
+
+static void markSequential() { markWith(1); }
+static void markParallel2() { markWith(2); }
+static void markParallel4() { markWith(4); }
+static void markParallel8() { markWith(8); }
+
+int main()
+{
+    run(createGraph, "Creating random graph");
+    run(markSequential, "Marking the slice (sequential)");
+    run(markParallel2, "Marking the slice (2 threads)");
+    run(markParallel4, "Marking the slice (4 threads)");
+    run(markParallel8, "Marking the slice (8 threads)");
+
+    // all the walks must mark the same nodes
+    for (uint32_t sl = 2; sl <= slice_id; ++sl) {
+        if (slices.getSlice(sl) != slices.getSlice(1)) {
+            std::cout << "The slice " << sl << " differs from the sequential one\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::cout << "Slice size: " << slices.size(1)
+              << " of " << nodes.size() << " nodes\n";
+}
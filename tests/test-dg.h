@@ -1,6 +1,9 @@
 #ifndef _TEST_DG_H_
 #define _TEST_DG_H_
 
+#include <random>
+#include <vector>
+
 #include "dg/DependenceGraph.h"
 
 namespace dg {
@@ -26,6 +29,56 @@ class TestDG : public DependenceGraph<TestNode>
 {
 };
 
+///
+// Random graph for slicing tests and benchmarks. The graph gets the entry
+// node with the key 0 and nodes with keys 1 ... num, every node
+// depends on randomly chosen nodes with lower keys (except the entry).
+struct RandomGraph
+{
+    // the number of data and use dependencies of every node
+    unsigned dataDeps{1};
+    unsigned useDeps{0};
+    // the number of data dependencies on the last 'window' nodes
+    unsigned nearDataDeps{0};
+    size_t window{1000};
+    // every 'controlEvery'-th node gets a control dependence (0 = none)
+    unsigned controlEvery{0};
+
+    // create the nodes in the graph, returns them without the entry
+    std::vector<TestNode *> create(TestDG& d, size_t num,
+                                   std::default_random_engine& generator) const
+    {
+        std::vector<TestNode *> nodes;
+        nodes.reserve(num);
+
+        TestNode *entry = new TestNode(0);
+        d.addNode(entry);
+        d.setEntry(entry);
+
+        for (size_t i = 1; i <= num; ++i) {
+            TestNode *n = new TestNode(static_cast<int>(i));
+            d.addNode(n);
+            if (!nodes.empty()) {
+                size_t near = nodes.size() > window ? nodes.size() - window : 0;
+                std::uniform_int_distribution<size_t> dist(0, nodes.size() - 1);
+                std::uniform_int_distribution<size_t> dist_near(near, nodes.size() - 1);
+
+                for (unsigned j = 0; j < dataDeps; ++j)
+                    nodes[dist(generator)]->addDataDependence(n);
+                for (unsigned j = 0; j < nearDataDeps; ++j)
+                    nodes[dist_near(generator)]->addDataDependence(n);
+                for (unsigned j = 0; j < useDeps; ++j)
+                    nodes[dist(generator)]->addUseDependence(n);
+                if (controlEvery > 0 && i % controlEvery == 0)
+                    nodes[dist(generator)]->addControlDependence(n);
+            }
+            nodes.push_back(n);
+        }
+
+        return nodes;
+    }
+};
+
 
 } // namespace tests
 } // namespace dg
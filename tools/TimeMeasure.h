@@ -39,11 +39,17 @@ public:
     {
         // compute the duration
         duration();
+        report(elapsed, prefix, out);
+    }
 
+    // report a duration measured elsewhere
+    static void report(const DurationT& d,
+                       const std::string& prefix="", std::ostream& out=std::cerr)
+    {
         out << prefix << " ";
 
-        const auto msec = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() % ms_in_sec;
-        const auto sec  = std::chrono::duration_cast<std::chrono::seconds>(elapsed).count();
+        const auto msec = std::chrono::duration_cast<std::chrono::milliseconds>(d).count() % ms_in_sec;
+        const auto sec  = std::chrono::duration_cast<std::chrono::seconds>(d).count();
         out << sec << " sec " << msec << " ms" << std::endl;
     }
 };
@@ -44,6 +44,7 @@
 #include "dg/analysis/PointsTo/PointerAnalysisFI.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFS.h"
 #include "dg/analysis/PointsTo/PointerAnalysisFSInv.h"
+#include "dg/analysis/PointsTo/PointerAnalysisSFS.h"
 #include "dg/analysis/PointsTo/Pointer.h"
 
 #include "TimeMeasure.h"
@@ -70,6 +71,7 @@ enum PTType {
     FLOW_SENSITIVE = 1,
     FLOW_INSENSITIVE,
     WITH_INVALIDATE,
+    SPARSE_FLOW_SENSITIVE,
 };
 
 static std::string
@@ -219,7 +221,7 @@ dumpMemoryObject(MemoryObject *mo, int ind, bool dot)
 }
 
 static void
-dumpMemoryMap(PointerAnalysisFS::MemoryMapT *mm, int ind, bool dot)
+dumpMemoryMap(const PointerAnalysisFS::MemoryMapT *mm, int ind, bool dot)
 {
     for (const auto& it : *mm) {
         // print the key
@@ -273,6 +275,22 @@ dumpPointerSubgraphData(PSNode *n, PTType type, bool dot = false)
 
         if (!dot)
             printf("    -----------\n");
+    } else if (type == SPARSE_FLOW_SENSITIVE) {
+        // the memory defined by the node
+        const PointerAnalysisFS::MemoryMapT *mm
+            = static_cast<PointerAnalysisSFS *>(PA.get())->getDefinedMemory(n);
+        if (!mm)
+            return;
+
+        if (dot)
+            printf("\\n------\\n    --- Defined memory ---\\n");
+        else
+            printf("    Defined memory:\n");
+
+        dumpMemoryMap(mm, 6, dot);
+
+        if (!dot)
+            printf("    ----------------\n");
     } else {
         PointerAnalysisFS::MemoryMapT *mm
             = n->getData<PointerAnalysisFS::MemoryMapT>();
@@ -502,6 +520,42 @@ dumpPointerSubgraph(LLVMPointerAnalysis *pta, PTType type, bool todot)
     }
 }
 
+// dump the points-to sets in the format that is
+// understood by tests/ptset-benchmark
+static bool
+dumpPointsToSets(LLVMPointerAnalysis *pta, const char *path)
+{
+    std::ofstream out(path);
+    if (!out.is_open())
+        return false;
+
+    const auto& nodes = pta->getNodes();
+    for (const auto& node : nodes) {
+        if (!node || node->pointsTo.empty())
+            continue;
+
+        for (const auto& ptr : node->pointsTo)
+            out << ptr.target->getID() << ":" << *ptr.offset << " ";
+        out << "\n";
+    }
+
+    return true;
+}
+
+static void
+dumpAnalysisStats(const PointerAnalysisStatistics& S)
+{
+    printf("Processed nodes: %lu\n", S.processedNodes);
+    printf("Processed nodes that changed: %lu\n", S.changedNodes);
+    printf("Iterations: %lu\n", S.iterations);
+    for (unsigned t = static_cast<unsigned>(PSNodeType::ALLOC);
+         t <= static_cast<unsigned>(PSNodeType::INVALIDATED); ++t) {
+        PSNodeType type = static_cast<PSNodeType>(t);
+        if (S.getProcessed(type) > 0)
+            printf("  %s: %lu\n", PSNodeTypeToCString(type), S.getProcessed(type));
+    }
+}
+
 static void
 dumpStats(LLVMPointerAnalysis *pta)
 {
@@ -647,6 +701,10 @@ int main(int argc, char *argv[])
     llvm::SMDiagnostic SMD;
     bool todot = false;
     bool stats = false;
+    bool worklist = false;
+    bool collapse_cycles = false;
+    bool optimize = false;
+    const char *dump_ptsets = nullptr;
     const char *module = nullptr;
     PTType type = FLOW_INSENSITIVE;
     uint64_t field_senitivity = Offset::UNKNOWN;
@@ -659,6 +717,14 @@ int main(int argc, char *argv[])
                 type = FLOW_SENSITIVE;
             else if (strcmp(argv[i+1], "inv") == 0)
                 type = WITH_INVALIDATE;
+            else if (strcmp(argv[i+1], "sfs") == 0)
+                type = SPARSE_FLOW_SENSITIVE;
+        } else if (strcmp(argv[i], "-pta-worklist") == 0) {
+            worklist = true;
+        } else if (strcmp(argv[i], "-pta-collapse-cycles") == 0) {
+            collapse_cycles = true;
+        } else if (strcmp(argv[i], "-pta-optimize") == 0) {
+            optimize = true;
         } else if (strcmp(argv[i], "-pta-field-sensitive") == 0) {
             field_senitivity = static_cast<uint64_t>(atoll(argv[i + 1]));
         } else if (strcmp(argv[i], "-dot") == 0) {
@@ -673,6 +739,8 @@ int main(int argc, char *argv[])
             names_with_funs = true;
         } else if (strcmp(argv[i], "-stats") == 0) {
             stats = true;
+        } else if (strcmp(argv[i], "-dump-ptsets") == 0) {
+            dump_ptsets = argv[i + 1];
         } else if (strcmp(argv[i], "-v") == 0) {
             verbose = true;
         } else if (strcmp(argv[i], "-vv") == 0) {
@@ -719,7 +787,14 @@ int main(int argc, char *argv[])
         }
     }
 
-    LLVMPointerAnalysis PTA(M, entry_func, field_senitivity);
+    LLVMPointerAnalysisOptions opts;
+    opts.setEntryFunction(entry_func);
+    opts.setFieldSensitivity(field_senitivity);
+    opts.setWorklist(worklist);
+    opts.setCollapseCycles(collapse_cycles);
+    opts.setOptimizeSubgraph(optimize);
+
+    LLVMPointerAnalysis PTA(M, opts);
 
     tm.start();
 
@@ -733,6 +808,10 @@ int main(int argc, char *argv[])
         PA = std::unique_ptr<PointerAnalysis>(
             PTA.createPTA<analysis::pta::PointerAnalysisFSInv>()
             );
+    } else if (type == SPARSE_FLOW_SENSITIVE) {
+        PA = std::unique_ptr<PointerAnalysis>(
+            PTA.createPTA<analysis::pta::PointerAnalysisSFS>()
+            );
     } else {
         PA = std::unique_ptr<PointerAnalysis>(
             PTA.createPTA<analysis::pta::PointerAnalysisFS>()
@@ -758,13 +837,23 @@ int main(int argc, char *argv[])
         }
     } else {
         PA->run();
+        PTA.composeReplacedNodes(PA.get());
     }
 
     tm.stop();
     tm.report("INFO: Points-to analysis [new] took");
 
+    if (dump_ptsets) {
+        if (!dumpPointsToSets(&PTA, dump_ptsets)) {
+            llvm::errs() << "Failed opening '" << dump_ptsets << "'\n";
+            return 1;
+        }
+        return 0;
+    }
+
     if (stats) {
         dumpStats(&PTA);
+        dumpAnalysisStats(PA->getStatistics());
         return 0;
     }
 
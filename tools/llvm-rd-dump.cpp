@@ -258,7 +258,7 @@ dumpRDdot(LLVMReachingDefinitions *RD, bool dump_rd)
                 DefSite var = pair.first;
                 if (colors.find(var.target) == colors.end())
                     colors[var.target] = rand();
-                for (auto& dest: pair.second) {
+                for (RDNode *dest: pair.second) {
                     printf("\tNODE%p -> NODE%p [color=\"#%X\" style=\"dotted\"]",
                            static_cast<void*>(node), static_cast<void*>(dest),
                            colors[var.target]);
@@ -286,6 +286,18 @@ dumpRD(LLVMReachingDefinitions *RD, bool todot, bool dump_rd)
     }
 }
 
+static void
+dumpStats(LLVMReachingDefinitions *RD)
+{
+    const auto& S = RD->getStatistics();
+    printf("Processed nodes: %lu\n", S.processedNodes);
+    printf("Processed nodes that changed: %lu\n", S.changedNodes);
+    printf("Merges of maps: %lu\n", S.merges);
+    printf("Iterations: %lu\n", S.iterations);
+    printf("Maximal map size: %lu\n", S.maxMapSize);
+    printf("Maximal number of definitions: %lu\n", S.maxDefinitionsSize);
+}
+
 int main(int argc, char *argv[])
 {
     llvm::Module *M;
@@ -293,6 +305,11 @@ int main(int argc, char *argv[])
     llvm::SMDiagnostic SMD;
     bool todot = false;
     bool dump_rd = false;
+    bool stats = false;
+    bool rd_worklist = false;
+    bool rd_interval_maps = false;
+    bool rd_blocks = false;
+    bool rd_on_demand = false;
     const char *module = nullptr;
     Offset::type field_senitivity = Offset::UNKNOWN;
     bool rd_strong_update_unknown = false;
@@ -327,6 +344,16 @@ int main(int argc, char *argv[])
             }
         } else if (strcmp(argv[i], "-rd-strong-update-unknown") == 0) {
             rd_strong_update_unknown = true;
+        } else if (strcmp(argv[i], "-rd-worklist") == 0) {
+            rd_worklist = true;
+        } else if (strcmp(argv[i], "-rd-interval-maps") == 0) {
+            rd_interval_maps = true;
+        } else if (strcmp(argv[i], "-rd-blocks") == 0) {
+            rd_blocks = true;
+        } else if (strcmp(argv[i], "-rd-on-demand") == 0) {
+            rd_on_demand = true;
+        } else if (strcmp(argv[i], "-stats") == 0) {
+            stats = true;
         } else if (strcmp(argv[i], "-dot") == 0) {
             todot = true;
         } else if (strcmp(argv[i], "-v") == 0) {
@@ -378,6 +405,10 @@ int main(int argc, char *argv[])
     opts.entryFunction = entryFunc;
     opts.strongUpdateUnknown = rd_strong_update_unknown;
     opts.maxSetSize = max_set_size;
+    opts.worklist = rd_worklist;
+    opts.intervalMaps = rd_interval_maps;
+    opts.blocks = rd_blocks;
+    opts.onDemand = rd_on_demand;
 
     LLVMReachingDefinitions RD(M, &PTA, opts);
     tm.start();
@@ -388,6 +419,11 @@ int main(int argc, char *argv[])
     tm.stop();
     tm.report("INFO: Reaching definitions analysis took");
 
+    if (stats) {
+        dumpStats(&RD);
+        return 0;
+    }
+
     dumpRD(&RD, todot, dump_rd);
 
     return 0;
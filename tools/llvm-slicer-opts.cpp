@@ -25,7 +25,7 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
     llvm::cl::opt<std::string> inputFile(llvm::cl::Positional, llvm::cl::Required,
         llvm::cl::desc("<input file>"), llvm::cl::init(""), llvm::cl::cat(SlicingOpts));
     
-    llvm::cl::opt<std::string> slicingCriteria("c", llvm::cl::Required,
+    llvm::cl::opt<std::string> slicingCriteria("c",
         llvm::cl::desc("Slice with respect to the call-sites of a given function\n"
                        "i. e.: '-c foo' or '-c __assert_fail'. Special value is a 'ret'\n"
                        "in which case the slice is taken with respect to the return value\n"
@@ -36,6 +36,16 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
                        "You can use comma-separated list of more slicing criteria,\n"
                        "e.g. -c foo,5:x,:glob\n"), llvm::cl::value_desc("crit"),
                        llvm::cl::init(""), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<std::string> batchFile("batch",
+        llvm::cl::desc("Slice w.r.t. more sets of slicing criteria. The file contains\n"
+                       "one set per line in the same format as the -c option\n"
+                       "(empty lines and lines starting with # are ignored).\n"
+                       "The dependence graph is built only once and the i-th set\n"
+                       "is saved to the file with suffix .i.bc (resp. .i.sliced).\n"
+                       "The sets are sliced in parallel using -threads processes.\n"),
+                       llvm::cl::value_desc("filename"),
+                       llvm::cl::init(""), llvm::cl::cat(SlicingOpts));
     
     llvm::cl::opt<bool> removeSlicingCriteria("remove-slicing-criteria",
         llvm::cl::desc("By default, slicer keeps also calls to the slicing criteria\n"
@@ -50,16 +60,77 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
                        llvm::cl::value_desc("N"), llvm::cl::init(dg::analysis::Offset::UNKNOWN),
                        llvm::cl::cat(SlicingOpts));
     
+    llvm::cl::opt<bool> ptaWorklist("pta-worklist",
+        llvm::cl::desc("Compute PTA using a worklist that re-processes only the nodes\n"
+                       "affected by a change instead of iterations that re-process\n"
+                       "all nodes reachable from the changed nodes.\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+    
+    llvm::cl::opt<bool> ptaCollapseCycles("pta-collapse-cycles",
+        llvm::cl::desc("Collapse cycles of copy nodes during flow-insensitive PTA\n"
+                       "(only with -pta-worklist).\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+    
+    llvm::cl::opt<bool> ptaOptimize("pta-optimize",
+        llvm::cl::desc("Optimize the pointer subgraph before running PTA\n"
+                       "(merge equivalent nodes, remove no-ops, etc.).\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+    
     llvm::cl::opt<bool> rdaStrongUpdateUnknown("rd-strong-update-unknown",
         llvm::cl::desc("Let reaching defintions analysis do strong updates on memory defined\n"
                        "with uknown offset in the case, that new definition overwrites\n"
                        "the whole memory. May be unsound for out-of-bound access\n"),
                        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
     
+    llvm::cl::opt<bool> rdaWorklist("rd-worklist",
+        llvm::cl::desc("Compute dense RDA using a worklist ordered by the reverse\n"
+                       "postorder instead of iterations that re-process all nodes\n"
+                       "reachable from the changed nodes.\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+    
+    llvm::cl::opt<bool> rdaIntervalMaps("rd-interval-maps",
+        llvm::cl::desc("Store the reaching definitions of dense RDA in per-target\n"
+                       "interval maps that are shared between the nodes.\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+    
+    llvm::cl::opt<bool> rdaBlocks("rd-blocks",
+        llvm::cl::desc("Keep the reaching definitions of dense RDA only at the ends\n"
+                       "of blocks and compute them for other nodes on demand.\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+    
+    llvm::cl::opt<bool> rdaOnDemand("rd-on-demand",
+        llvm::cl::desc("Resolve the reaching definitions of semi-sparse RDA only\n"
+                       "for the uses that are queried.\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+    
+    llvm::cl::opt<bool> cdOnDemand("cd-on-demand",
+        llvm::cl::desc("Compute the control dependencies of a function only\n"
+                       "when the slicing reaches the function.\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+    
+    llvm::cl::opt<bool> ddOnDemand("dd-on-demand",
+        llvm::cl::desc("Compute the data dependencies only for the nodes\n"
+                       "that the slicing reaches (ignored with -forward).\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+    
+    llvm::cl::opt<bool> freezeEdges("freeze-edges",
+        llvm::cl::desc("Copy the dependence edges into compact arrays and release\n"
+                       "the original containers before marking the slice.\n"
+                       "Saves memory, but can not be used with -forward,\n"
+                       "-cd-on-demand, -dd-on-demand, -annotate and -dump-dg.\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+    
     llvm::cl::opt<bool> undefinedArePure("undefined-are-pure",
         llvm::cl::desc("Assume that undefined functions have no side-effects\n"),
                        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
     
+    llvm::cl::opt<unsigned> threads("threads",
+        llvm::cl::desc("The number of threads used for building the dependence graph,\n"
+                       "computing the control dependencies and marking the slice.\n"
+                       "In the batch mode, it is also the number of sets sliced\n"
+                       "in parallel.\n"),
+                       llvm::cl::init(1), llvm::cl::cat(SlicingOpts));
+    
     llvm::cl::opt<std::string> entryFunction("entry",
         llvm::cl::desc("Entry function of the program\n"),
                        llvm::cl::init("main"), llvm::cl::cat(SlicingOpts));
@@ -73,7 +144,8 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
         llvm::cl::values(
             clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::fi, "fi", "Flow-insensitive PTA (default)"),
             clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::fs, "fs", "Flow-sensitive PTA"),
-            clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::inv, "inv", "PTA with invalidate nodes")
+            clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::inv, "inv", "PTA with invalidate nodes"),
+            clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::sfs, "sfs", "Sparse flow-sensitive PTA")
     #if LLVM_VERSION_MAJOR < 4
             , nullptr
     #endif
@@ -125,23 +197,36 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[]) {
     options.inputFile = inputFile;
     options.outputFile = outputFile;
     options.slicingCriteria = slicingCriteria;
+    options.batchFile = batchFile;
     options.removeSlicingCriteria = removeSlicingCriteria;
     options.forwardSlicing = forwardSlicing;
+    options.freezeEdges = freezeEdges;
 
     options.dgOptions.entryFunction = entryFunction;
     options.dgOptions.PTAOptions.entryFunction = entryFunction;
     options.dgOptions.PTAOptions.fieldSensitivity
                                     = dg::analysis::Offset(ptaFieldSensitivity);
     options.dgOptions.PTAOptions.analysisType = ptaType;
+    options.dgOptions.PTAOptions.worklist = ptaWorklist;
+    options.dgOptions.PTAOptions.collapseCycles = ptaCollapseCycles;
+    options.dgOptions.PTAOptions.optimizeSubgraph = ptaOptimize;
 
     options.dgOptions.RDAOptions.entryFunction = entryFunction;
     options.dgOptions.RDAOptions.strongUpdateUnknown = rdaStrongUpdateUnknown;
     options.dgOptions.RDAOptions.undefinedArePure = undefinedArePure;
+    options.dgOptions.RDAOptions.worklist = rdaWorklist;
+    options.dgOptions.RDAOptions.intervalMaps = rdaIntervalMaps;
+    options.dgOptions.RDAOptions.blocks = rdaBlocks;
+    options.dgOptions.RDAOptions.onDemand = rdaOnDemand;
     options.dgOptions.RDAOptions.analysisType = rdaType;
 
     // FIXME: add classes for CD and DEF-USE settings
     options.dgOptions.cdAlgorithm = cdAlgorithm;
+    options.dgOptions.cdOnDemand = cdOnDemand;
+    // forward slicing needs the edges to the users of the nodes
+    options.dgOptions.ddOnDemand = ddOnDemand && !forwardSlicing;
     options.dgOptions.DUUndefinedArePure = undefinedArePure;
+    options.dgOptions.threads = threads;
 
     return options;
 }
@@ -23,7 +23,14 @@ struct SlicerOptions {
     // do we perform forward slicing?
     bool forwardSlicing{false};
 
+    // freeze the dependence edges into compact arrays
+    // before marking the slice (saves memory)
+    bool freezeEdges{false};
+
     std::string slicingCriteria{};
+    // file with one set of slicing criteria per line,
+    // each set is sliced separately
+    std::string batchFile{};
     std::string inputFile{};
     std::string outputFile{};
 };
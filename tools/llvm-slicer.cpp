@@ -57,6 +57,9 @@
 #include <iostream>
 #include <fstream>
 
+#include <unistd.h>
+#include <sys/wait.h>
+
 #include "dg/llvm/LLVMDG2Dot.h"
 #include "llvm/LLVMDGAssemblyAnnotationWriter.h"
 
@@ -408,6 +411,9 @@ public:
         else if (options.dgOptions.PTAOptions.analysisType
                     == LLVMPointerAnalysisOptions::AnalysisType::inv)
             module_comment += "flow-sensitive with invalidate\n";
+        else if (options.dgOptions.PTAOptions.analysisType
+                    == LLVMPointerAnalysisOptions::AnalysisType::sfs)
+            module_comment += "sparse flow-sensitive\n";
 
         module_comment+= ";   * PTA field sensitivity: ";
         if (options.dgOptions.PTAOptions.fieldSensitivity == Offset::UNKNOWN)
@@ -419,7 +425,8 @@ public:
 
         errs() << "INFO: Saving IR with annotations to " << fl << "\n";
         auto annot
-            = new dg::debug::LLVMDGAssemblyAnnotationWriter(annotationOptions,
+            = new dg::debug::LLVMDGAssemblyAnnotationWriter(dg,
+                                                            annotationOptions,
                                                             dg->getPTA(),
                                                             dg->getRDA(),
                                                             criteria);
@@ -605,7 +612,7 @@ static void getLineCriteriaNodes(LLVMDependenceGraph& dg,
     assert(!parsedCrit.empty() && "Failed parsing criteria");
 
     // create the mapping from LLVM values to C variable names
-    for (auto& it : getConstructedFunctions()) {
+    for (auto& it : dg.getConstructedFunctions()) {
         for (auto& I : llvm::instructions(*llvm::cast<llvm::Function>(it.first))) {
             if (const llvm::DbgDeclareInst *DD = llvm::dyn_cast<llvm::DbgDeclareInst>(&I)) {
                 auto val = DD->getAddress();
@@ -626,7 +633,7 @@ static void getLineCriteriaNodes(LLVMDependenceGraph& dg,
     }
 
     // map line criteria to nodes
-    for (auto& it : getConstructedFunctions()) {
+    for (auto& it : dg.getConstructedFunctions()) {
         for (auto& I : llvm::instructions(*llvm::cast<llvm::Function>(it.first))) {
             if (instMatchesCrit(dg, I, parsedCrit)) {
                 LLVMNode *nd = dg.getNode(&I);
@@ -682,6 +689,133 @@ static std::set<LLVMNode *> getSlicingCriteriaNodes(LLVMDependenceGraph& dg,
     return nodes;
 }
 
+///
+// Read the sets of slicing criteria for the batch mode,
+// one set per line. Empty lines and comments are skipped.
+static bool readBatchFile(const std::string& file,
+                          std::vector<std::string>& batch)
+{
+    std::ifstream ifs(file);
+    if (!ifs.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(ifs, line)) {
+        // strip the white-space
+        auto b = line.find_first_not_of(" \t\r");
+        if (b == std::string::npos || line[b] == '#')
+            continue;
+        auto e = line.find_last_not_of(" \t\r");
+        batch.push_back(line.substr(b, e - b + 1));
+    }
+
+    return true;
+}
+
+static std::string getBatchOutputFile(const SlicerOptions& options, size_t i)
+{
+    std::string fl;
+    if (!options.outputFile.empty()) {
+        fl = options.outputFile;
+        replace_suffix(fl, "." + std::to_string(i) + ".bc");
+    } else {
+        fl = options.inputFile;
+        replace_suffix(fl, "." + std::to_string(i) + ".sliced");
+    }
+
+    return fl;
+}
+
+///
+// Slice the module w.r.t. every set of criteria from the batch.
+// The dependence graph (with the dependencies) is shared by all the slices,
+// every slice is marked with its own slice ID and materialized
+// in a forked process, so that the processes work on their own
+// (copy-on-write) copy of the module and the graph.
+static int sliceBatch(Slicer& slicer, llvm::Module *M,
+                      SlicerOptions& options,
+                      const std::vector<std::string>& batch)
+{
+    // compute the dependencies only once, before forking
+    slicer.computeDependencies();
+
+    // find the criteria before the edges are frozen
+    // (the 'ret' criterion follows the control dependencies)
+    std::vector<std::set<LLVMNode *>> criteria(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        criteria[i] = getSlicingCriteriaNodes(slicer.getDG(), batch[i]);
+        if (criteria[i].empty())
+            llvm::errs() << "Did not find slicing criteria: '"
+                         << batch[i] << "'\n";
+    }
+
+    if (options.freezeEdges)
+        slicer.freezeEdges();
+
+    unsigned max_procs = std::max(1u, options.dgOptions.threads);
+    unsigned running = 0;
+    bool failed = false;
+
+    auto waitForChild = [&]() {
+        int status;
+        if (wait(&status) < 0) {
+            failed = true;
+            return;
+        }
+
+        --running;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            failed = true;
+    };
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (running >= max_procs)
+            waitForChild();
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            llvm::errs() << "ERROR: Failed creating a process for slice "
+                         << i << "\n";
+            failed = true;
+            break;
+        }
+
+        if (pid > 0) {
+            ++running;
+            continue;
+        }
+
+        // the child process, the sets are already sliced
+        // in parallel, so mark the slice sequentially
+        options.outputFile = getBatchOutputFile(options, i);
+        options.dgOptions.threads = 1;
+        ModuleWriter writer(options, M);
+
+        if (criteria[i].empty()) {
+            if (!slicer.createEmptyMain())
+                _exit(1);
+        } else {
+            if (!slicer.mark(criteria[i], static_cast<uint32_t>(i + 1))) {
+                llvm::errs() << "Finding dependent nodes failed\n";
+                _exit(1);
+            }
+
+            if (!slicer.slice()) {
+                errs() << "ERROR: Slicing failed\n";
+                _exit(1);
+            }
+        }
+
+        llvm::errs().flush();
+        _exit(writer.cleanAndSaveModule(should_verify_module));
+    }
+
+    while (running > 0)
+        waitForChild();
+
+    return failed ? 1 : 0;
+}
+
 static AnnotationOptsT parseAnnotationOptions(const std::string& annot)
 {
     if (annot.empty())
@@ -748,10 +882,46 @@ int main(int argc, char *argv[])
 
     SlicerOptions options = parseSlicerOptions(argc, argv);
 
+    if (options.slicingCriteria.empty() == options.batchFile.empty()) {
+        llvm::errs() << "Exactly one of the options -c and -batch must be given\n";
+        return 1;
+    }
+
     // dump_dg_only implies dumg_dg
+    // (before the checks of the options that can not be used with dump_dg)
     if (dump_dg_only)
         dump_dg = true;
 
+    std::vector<std::string> batch;
+    if (!options.batchFile.empty()) {
+        if (!readBatchFile(options.batchFile, batch)) {
+            llvm::errs() << "Failed reading the batch file '"
+                         << options.batchFile << "'\n";
+            return 1;
+        }
+
+        if (batch.empty()) {
+            llvm::errs() << "No slicing criteria in the batch file '"
+                         << options.batchFile << "'\n";
+            return 1;
+        }
+
+        if (annotationOpts.getNumOccurrences() > 0 || dump_dg) {
+            llvm::errs() << "Annotations and dumping the graph are not supported"
+                            " in the batch mode\n";
+            return 1;
+        }
+    }
+
+    if (options.freezeEdges
+        && (options.forwardSlicing || options.dgOptions.cdOnDemand ||
+            options.dgOptions.ddOnDemand ||
+            annotationOpts.getNumOccurrences() > 0 || dump_dg)) {
+        llvm::errs() << "-freeze-edges can not be used with -forward, -cd-on-demand,"
+                        " -dd-on-demand, -annotate and -dump-dg\n";
+        return 1;
+    }
+
     llvm::LLVMContext context;
     std::unique_ptr<llvm::Module> M = parseModule(context, options);
     if (!M) {
@@ -801,6 +971,9 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (!batch.empty())
+        return sliceBatch(slicer, M.get(), options, batch);
+
     ModuleAnnotator annotator(options, &slicer.getDG(),
                               parseAnnotationOptions(annotationOpts));
 
@@ -22,6 +22,7 @@
 #include "dg/llvm/LLVMDependenceGraph.h"
 #include "dg/llvm/LLVMDependenceGraphBuilder.h"
 #include "dg/llvm/LLVMSlicer.h"
+#include "dg/FrozenEdges.h"
 
 #include "llvm/LLVMDGAssemblyAnnotationWriter.h"
 #include "llvm-slicer-opts.h"
@@ -62,6 +63,7 @@ class Slicer {
     dg::LLVMSlicer slicer;
     uint32_t slice_id = 0;
     bool _computed_deps{false};
+    dg::FrozenEdges<dg::LLVMNode> _frozen;
 
 public:
     Slicer(llvm::Module *mod, const SlicerOptions& opts)
@@ -84,6 +86,10 @@ public:
             return false;
         }
 
+        const auto& stats = _builder.getStatistics();
+        dg::debug::TimeMeasure::report(stats.ptaTime, "INFO: Pointer analysis took");
+        dg::debug::TimeMeasure::report(stats.buildTime, "INFO: Building the dependence graph took");
+
         if (compute_deps)
             computeDependencies();
 
@@ -101,12 +107,42 @@ public:
 
         _dg = _builder.computeDependencies(std::move(_dg));
         _computed_deps = true;
+
+        const auto& stats = _builder.getStatistics();
+        dg::debug::TimeMeasure::report(stats.rdaTime, "INFO: Reaching definitions analysis took");
+        dg::debug::TimeMeasure::report(stats.defUseTime, "INFO: Computing data dependencies took");
+        dg::debug::TimeMeasure::report(stats.cdTime, "INFO: Computing control dependencies took");
+    }
+
+    // Copy the dependence edges into compact arrays and release
+    // the containers in the nodes. After this, the graph
+    // can be only marked (backward) and sliced.
+    void freezeEdges() {
+        assert(_computed_deps && "Must compute dependencies before freezing");
+        assert(!_frozen.isFrozen() && "Already called freezeEdges()");
+
+        dg::debug::TimeMeasure tm;
+
+        tm.start();
+        for (auto& it : _dg->getConstructedFunctions())
+            _frozen.addGraph(it.second);
+        _frozen.freeze();
+        _frozen.releaseNodeEdges();
+        slicer.setFrozenEdges(&_frozen);
+        tm.stop();
+
+        tm.report("INFO: Freezing the dependence edges took");
+        llvm::errs() << "INFO: Frozen " << _frozen.edgesNum() << " edges of "
+                     << _frozen.size() << " nodes\n";
     }
 
-    // Mark the nodes from the slice.
-    // This method calls computeDependencies(),
+    bool hasFrozenEdges() const { return _frozen.isFrozen(); }
+
+    // Mark the nodes from the slice with the given slice ID.
+    // This method calls computeDependencies() (if it was not called yet),
     // but buildDG() must be called before.
-    bool mark(std::set<dg::LLVMNode *>& criteria_nodes)
+    bool mark(std::set<dg::LLVMNode *>& criteria_nodes,
+              uint32_t sl_id = 0xdead)
     {
         assert(_dg && "mark() called without the dependence graph built");
         assert(!criteria_nodes.empty() && "Do not have slicing criteria");
@@ -114,7 +150,11 @@ public:
         dg::debug::TimeMeasure tm;
 
         // compute dependece edges
-        computeDependencies();
+        if (!_computed_deps)
+            computeDependencies();
+
+        if (_options.freezeEdges && !_frozen.isFrozen())
+            freezeEdges();
 
         // unmark this set of nodes after marking the relevant ones.
         // Used to mimic the Weissers algorithm
@@ -130,7 +170,10 @@ public:
         for (auto& funcName : _options.untouchedFunctions)
             slicer.keepFunctionUntouched(funcName.c_str());
 
-        slice_id = 0xdead;
+        slicer.setDataDependenceProvider(_builder.getDataDependenceProvider());
+        slicer.setThreads(_options.dgOptions.threads);
+
+        slice_id = sl_id;
 
         tm.start();
         for (dg::LLVMNode *start : criteria_nodes)